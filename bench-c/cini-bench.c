@@ -0,0 +1,709 @@
+#include <cini.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Benchmark parsing and lookups on synthetic corpora. Every corpus is
+// generated from a fixed seed, so runs of different builds see exactly
+// the same input. Results are printed as one JSON object per line:
+//
+//   {"corpus": "flat", "metric": "parse", "value": 412.5, "unit": "MB/s"}
+
+#define BENCH_SEED 0x2545f4914f6cdd1dull
+#define BENCH_MAX_QUERIES 4096
+#define BENCH_LOOKUP_ROUNDS 64
+
+typedef struct
+{
+    char *text;
+    size_t length;
+    size_t capacity;
+
+    uint64_t random_state;
+
+    // Every field is a candidate for the lookup set; sampling one in
+    // sixteen spreads the set over a large part of the corpus.
+    char *queries[BENCH_MAX_QUERIES];
+    uint_fast32_t num_queries;
+    uint_fast32_t num_fields;
+
+} BenchCorpus;
+
+typedef struct
+{
+    uint64_t num_allocations;
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+
+} BenchAllocator;
+
+typedef void (*BenchGenerateFn)(
+    BenchCorpus *corpus,
+    size_t target_length
+);
+
+
+
+// ==> Measuring
+
+double bench_now()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (time.tv_sec * 1e9) + time.tv_nsec;
+}
+
+/// @brief Allocator which counts calls and keeps track of the bytes in
+///        use. The size of each allocation is stored in front of it.
+void * bench_alloc(
+    uint_fast32_t amount,
+    void *userdata
+) {
+    BenchAllocator *allocator = userdata;
+    uint64_t *block = malloc(amount + 16);
+    if ( ! block)
+    {
+        return NULL;
+    }
+    block[0] = amount;
+    ++allocator->num_allocations;
+    allocator->live_bytes += amount;
+    if (allocator->live_bytes > allocator->peak_bytes)
+    {
+        allocator->peak_bytes = allocator->live_bytes;
+    }
+    return &block[2];
+}
+
+void bench_free(
+    void *pointer,
+    void *userdata
+) {
+    BenchAllocator *allocator = userdata;
+    if ( ! pointer)
+    {
+        return;
+    }
+    uint64_t *block = ((uint64_t *) pointer) - 2;
+    allocator->live_bytes -= block[0];
+    free(block);
+}
+
+void bench_report(
+    const char *corpus,
+    const char *metric,
+    double value,
+    const char *unit
+) {
+    printf(
+        "{\"corpus\": \"%s\", \"metric\": \"%s\", "
+        "\"value\": %.3f, \"unit\": \"%s\"}\n",
+        corpus,
+        metric,
+        value,
+        unit
+    );
+    fflush(stdout);
+}
+
+
+
+// ==> Corpus Building
+
+uint64_t bench_random(
+    BenchCorpus *corpus
+) {
+    // xorshift64*, which is plenty for shaping test data.
+
+    corpus->random_state ^= corpus->random_state >> 12;
+    corpus->random_state ^= corpus->random_state << 25;
+    corpus->random_state ^= corpus->random_state >> 27;
+    return corpus->random_state * 0x2545f4914f6cdd1dull;
+}
+
+uint_fast32_t bench_random_below(
+    BenchCorpus *corpus,
+    uint_fast32_t limit
+) {
+    return bench_random(corpus) % limit;
+}
+
+void bench_append(
+    BenchCorpus *corpus,
+    const char *text,
+    size_t length
+) {
+    if ((corpus->length + length + 1) > corpus->capacity)
+    {
+        while ((corpus->length + length + 1) > corpus->capacity)
+        {
+            corpus->capacity *= 2;
+        }
+        corpus->text = realloc(corpus->text, corpus->capacity);
+        if ( ! corpus->text)
+        {
+            fputs("cini-bench: Out of memory.\n", stderr);
+            exit(1);
+        }
+    }
+    memcpy(&corpus->text[corpus->length], text, length);
+    corpus->length += length;
+    corpus->text[corpus->length] = 0;
+}
+
+void bench_append_string(
+    BenchCorpus *corpus,
+    const char *text
+) {
+    bench_append(corpus, text, strlen(text));
+}
+
+void bench_append_header(
+    BenchCorpus *corpus,
+    const char *section
+) {
+    bench_append_string(corpus, "[");
+    bench_append_string(corpus, section);
+    bench_append_string(corpus, "]\n");
+}
+
+/// @brief Append a value of a randomly chosen shape, so that lookups
+///        of every type have something to decode.
+void bench_append_value(
+    BenchCorpus *corpus
+) {
+    char value[64];
+    switch (bench_random_below(corpus, 4))
+    {
+        case 0:
+            snprintf(
+                value,
+                sizeof(value),
+                "%d",
+                (int) bench_random_below(corpus, 2000000) - 1000000
+            );
+            break;
+        case 1:
+            snprintf(
+                value,
+                sizeof(value),
+                "%s",
+                bench_random_below(corpus, 2) ? "true" : "off"
+            );
+            break;
+        case 2:
+            snprintf(
+                value,
+                sizeof(value),
+                "%u.%02u",
+                (unsigned int) bench_random_below(corpus, 10000),
+                (unsigned int) bench_random_below(corpus, 100)
+            );
+            break;
+        default:
+            snprintf(
+                value,
+                sizeof(value),
+                "value of field %u",
+                (unsigned int) bench_random_below(corpus, 100000)
+            );
+            break;
+    }
+    bench_append_string(corpus, value);
+}
+
+/// @brief Append a `key = ` line start and remember every so many keys
+///        as a lookup query.
+void bench_append_key(
+    BenchCorpus *corpus,
+    const char *section,
+    const char *key
+) {
+    bench_append_string(corpus, key);
+    bench_append_string(corpus, " = ");
+    ++corpus->num_fields;
+    if (
+         (corpus->num_queries < BENCH_MAX_QUERIES)
+      && (bench_random_below(corpus, 16) == 0)
+    ) {
+        size_t len_query = strlen(section) + strlen(key) + 2;
+        char *query = malloc(len_query);
+        snprintf(query, len_query, "%s:%s", section, key);
+        corpus->queries[corpus->num_queries] = query;
+        ++corpus->num_queries;
+    }
+}
+
+void bench_append_field(
+    BenchCorpus *corpus,
+    const char *section,
+    uint_fast32_t key_index
+) {
+    char key[32];
+    snprintf(key, sizeof(key), "key_%u", (unsigned int) key_index);
+    bench_append_key(corpus, section, key);
+    bench_append_value(corpus);
+    bench_append_string(corpus, "\n");
+}
+
+
+
+// ==> Corpora
+
+/// @brief A few sections with very many keys each.
+void bench_generate_flat(
+    BenchCorpus *corpus,
+    size_t target_length
+) {
+    char section[32];
+    unsigned int section_index = 0;
+    while (corpus->length < target_length)
+    {
+        snprintf(section, sizeof(section), "flat%u", section_index);
+        bench_append_header(corpus, section);
+        for (uint_fast32_t key = 0; key < 20000; ++key)
+        {
+            bench_append_field(corpus, section, key);
+        }
+        ++section_index;
+    }
+}
+
+/// @brief Very many top-level sections with a handful of keys each.
+void bench_generate_sections(
+    BenchCorpus *corpus,
+    size_t target_length
+) {
+    char section[32];
+    unsigned int section_index = 0;
+    while (corpus->length < target_length)
+    {
+        snprintf(section, sizeof(section), "section%u", section_index);
+        bench_append_header(corpus, section);
+        uint_fast32_t num_keys = 2 + bench_random_below(corpus, 6);
+        for (uint_fast32_t key = 0; key < num_keys; ++key)
+        {
+            bench_append_field(corpus, section, key);
+        }
+        ++section_index;
+    }
+}
+
+/// @brief Paths like `[a.b.c.d]` of four to eight levels, drawn from a
+///        small vocabulary so that the paths share their prefixes.
+void bench_generate_nested(
+    BenchCorpus *corpus,
+    size_t target_length
+) {
+    char section[256];
+    while (corpus->length < target_length)
+    {
+        size_t len_section = 0;
+        uint_fast32_t num_levels = 4 + bench_random_below(corpus, 5);
+        for (uint_fast32_t level = 0; level < num_levels; ++level)
+        {
+            len_section += snprintf(
+                &section[len_section],
+                sizeof(section) - len_section,
+                "%sn%u",
+                (level > 0) ? "." : "",
+                (unsigned int) bench_random_below(corpus, 12)
+            );
+        }
+        bench_append_header(corpus, section);
+        uint_fast32_t num_keys = 1 + bench_random_below(corpus, 4);
+        for (uint_fast32_t key = 0; key < num_keys; ++key)
+        {
+            bench_append_field(corpus, section, key);
+        }
+    }
+}
+
+/// @brief A few parents with thousands of sub-sections each.
+void bench_generate_fanout(
+    BenchCorpus *corpus,
+    size_t target_length
+) {
+    char section[64];
+    uint_fast32_t child = 0;
+    while (corpus->length < target_length)
+    {
+        snprintf(
+            section,
+            sizeof(section),
+            "fan%u.child%u",
+            (unsigned int) (child / 50000),
+            (unsigned int) child
+        );
+        bench_append_header(corpus, section);
+        bench_append_field(corpus, section, 0);
+        bench_append_field(corpus, section, 1);
+        ++child;
+    }
+}
+
+/// @brief Values of one to eight KiB of text.
+void bench_generate_long_values(
+    BenchCorpus *corpus,
+    size_t target_length
+) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz ,.-";
+    char section[32];
+    char value[8192];
+    unsigned int section_index = 0;
+    while (corpus->length < target_length)
+    {
+        snprintf(section, sizeof(section), "long%u", section_index);
+        bench_append_header(corpus, section);
+        for (uint_fast32_t key = 0; key < 16; ++key)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "text_%u", (unsigned int) key);
+            bench_append_key(corpus, section, name);
+
+            size_t len_value = 1024 + bench_random_below(corpus, 7169);
+            for (size_t offset = 0; offset < len_value; ++offset)
+            {
+                value[offset] = alphabet[
+                    bench_random_below(corpus, sizeof(alphabet) - 1)
+                ];
+            }
+            value[0] = 'x';
+            value[len_value - 1] = 'x';
+            bench_append(corpus, value, len_value);
+            bench_append_string(corpus, "\n");
+        }
+        ++section_index;
+    }
+}
+
+/// @brief Keys and values made of two- to four-byte UTF-8 sequences.
+void bench_generate_utf8(
+    BenchCorpus *corpus,
+    size_t target_length
+) {
+    static const char *const runes[] = {
+        "\xc3\xa4", "\xc3\x9f", "\xd0\xb6", "\xce\xa9",
+        "\xe2\x82\xac", "\xe6\xbc\xa2", "\xe5\xad\x97", "\xe3\x81\x82",
+        "\xf0\x9f\x98\x80", "\xf0\x9f\x8c\x8d"
+    };
+    uint_fast32_t num_runes = sizeof(runes) / sizeof(runes[0]);
+    char section[32];
+    unsigned int section_index = 0;
+    while (corpus->length < target_length)
+    {
+        snprintf(section, sizeof(section), "utf8_%u", section_index);
+        bench_append_header(corpus, section);
+        for (uint_fast32_t key = 0; key < 32; ++key)
+        {
+            char name[64];
+            size_t len_name = snprintf(
+                name,
+                sizeof(name),
+                "k%u",
+                (unsigned int) key
+            );
+            for (uint_fast32_t rune = 0; rune < 3; ++rune)
+            {
+                const char *sequence = runes[
+                    bench_random_below(corpus, num_runes)
+                ];
+                memcpy(&name[len_name], sequence, strlen(sequence) + 1);
+                len_name += strlen(sequence);
+            }
+            bench_append_key(corpus, section, name);
+            uint_fast32_t len_value = 8 + bench_random_below(corpus, 120);
+            for (uint_fast32_t rune = 0; rune < len_value; ++rune)
+            {
+                bench_append_string(
+                    corpus,
+                    runes[bench_random_below(corpus, num_runes)]
+                );
+            }
+            bench_append_string(corpus, "\n");
+        }
+        ++section_index;
+    }
+}
+
+
+
+// ==> Runs
+
+typedef struct
+{
+    const char *name;
+    BenchGenerateFn fn_generate;
+
+} BenchCorpusKind;
+
+const BenchCorpusKind bench_corpora[] = {
+    {"flat", bench_generate_flat},
+    {"sections", bench_generate_sections},
+    {"nested", bench_generate_nested},
+    {"fanout", bench_generate_fanout},
+    {"long_values", bench_generate_long_values},
+    {"utf8", bench_generate_utf8}
+};
+
+void bench_run_parse(
+    const char *name,
+    const BenchCorpus *corpus,
+    uint_fast32_t num_runs
+) {
+    double best = 0.0;
+    uint64_t num_allocations = 0;
+    uint64_t peak_bytes = 0;
+    for (uint_fast32_t run = 0; run < num_runs; ++run)
+    {
+        BenchAllocator allocator = {0, 0, 0};
+        CiniDocument *document = cini_new_document(
+            bench_alloc,
+            bench_free,
+            &allocator
+        );
+        uint64_t allocations_before = allocator.num_allocations;
+        double start = bench_now();
+        int_fast8_t status = cini_parse_source_limited(
+            document,
+            corpus->text,
+            corpus->length
+        );
+        double elapsed = bench_now() - start;
+        if (status != CINI_SUCCESS)
+        {
+            fprintf(
+                stderr,
+                "cini-bench: Failed to parse corpus '%s' (status %d).\n",
+                name,
+                (int) status
+            );
+            exit(1);
+        }
+        if ((run == 0) || (elapsed < best))
+        {
+            best = elapsed;
+        }
+        num_allocations = allocator.num_allocations - allocations_before;
+        peak_bytes = allocator.peak_bytes;
+        cini_free_document(document);
+    }
+    bench_report(name, "bytes", corpus->length, "B");
+    bench_report(name, "fields", corpus->num_fields, "count");
+    bench_report(name, "parse", (corpus->length / 1e6) / (best / 1e9), "MB/s");
+    bench_report(name, "allocations_per_parse", num_allocations, "count");
+    bench_report(name, "peak_arena_bytes", peak_bytes, "B");
+
+    // A document which is reset and parsed again should reuse its arena.
+
+    BenchAllocator allocator = {0, 0, 0};
+    CiniDocument *document = cini_new_document(
+        bench_alloc,
+        bench_free,
+        &allocator
+    );
+    cini_parse_source_limited(document, corpus->text, corpus->length);
+    cini_reset_document(document);
+    uint64_t allocations_before = allocator.num_allocations;
+    double start = bench_now();
+    cini_parse_source_limited(document, corpus->text, corpus->length);
+    double elapsed = bench_now() - start;
+    bench_report(
+        name,
+        "reparse",
+        (corpus->length / 1e6) / (elapsed / 1e9),
+        "MB/s"
+    );
+    bench_report(
+        name,
+        "allocations_per_reparse",
+        allocator.num_allocations - allocations_before,
+        "count"
+    );
+    cini_free_document(document);
+}
+
+void bench_run_lookups(
+    const char *name,
+    const BenchCorpus *corpus
+) {
+    if (corpus->num_queries == 0)
+    {
+        return;
+    }
+    CiniDocument *document = cini_malloc_document();
+    cini_parse_source_limited(document, corpus->text, corpus->length);
+    uint64_t num_lookups = (uint64_t) corpus->num_queries
+        * BENCH_LOOKUP_ROUNDS;
+
+    // The first round decodes and copies values, like a warm cache in a
+    // long-running program; only the later ones are measured.
+
+    uint_fast32_t num_found = 0;
+    for (uint_fast32_t query = 0; query < corpus->num_queries; ++query)
+    {
+        num_found += cini_get_text(document, corpus->queries[query]) != 0;
+    }
+    if (num_found != corpus->num_queries)
+    {
+        fprintf(
+            stderr,
+            "cini-bench: Only %u of %u queries of '%s' were found.\n",
+            (unsigned int) num_found,
+            (unsigned int) corpus->num_queries,
+            name
+        );
+        exit(1);
+    }
+
+    double start = bench_now();
+    for (uint_fast32_t round = 0; round < BENCH_LOOKUP_ROUNDS; ++round)
+    {
+        for (uint_fast32_t query = 0; query < corpus->num_queries; ++query)
+        {
+            num_found += cini_get_text(document, corpus->queries[query]) != 0;
+        }
+    }
+    bench_report(
+        name,
+        "get_text",
+        (bench_now() - start) / num_lookups,
+        "ns/lookup"
+    );
+
+    int64_t integer = 0;
+    start = bench_now();
+    for (uint_fast32_t round = 0; round < BENCH_LOOKUP_ROUNDS; ++round)
+    {
+        for (uint_fast32_t query = 0; query < corpus->num_queries; ++query)
+        {
+            cini_get_int(document, corpus->queries[query], &integer);
+        }
+    }
+    bench_report(
+        name,
+        "get_int",
+        (bench_now() - start) / num_lookups,
+        "ns/lookup"
+    );
+
+    bool boolean = false;
+    start = bench_now();
+    for (uint_fast32_t round = 0; round < BENCH_LOOKUP_ROUNDS; ++round)
+    {
+        for (uint_fast32_t query = 0; query < corpus->num_queries; ++query)
+        {
+            cini_get_bool(document, corpus->queries[query], &boolean);
+        }
+    }
+    bench_report(
+        name,
+        "get_bool",
+        (bench_now() - start) / num_lookups,
+        "ns/lookup"
+    );
+
+    CiniQuery **compiled = malloc(corpus->num_queries * sizeof(CiniQuery *));
+    for (uint_fast32_t query = 0; query < corpus->num_queries; ++query)
+    {
+        compiled[query] = cini_compile_query(
+            document,
+            corpus->queries[query]
+        );
+        cini_get_text_q(compiled[query]);
+    }
+    start = bench_now();
+    for (uint_fast32_t round = 0; round < BENCH_LOOKUP_ROUNDS; ++round)
+    {
+        for (uint_fast32_t query = 0; query < corpus->num_queries; ++query)
+        {
+            num_found += cini_get_text_q(compiled[query]) != 0;
+        }
+    }
+    bench_report(
+        name,
+        "get_text_q",
+        (bench_now() - start) / num_lookups,
+        "ns/lookup"
+    );
+    for (uint_fast32_t query = 0; query < corpus->num_queries; ++query)
+    {
+        cini_free_query(compiled[query]);
+    }
+    free(compiled);
+    cini_free_document(document);
+}
+
+int main(int argc, char **argv)
+{
+    size_t target_length = 16 * 1024 * 1024;
+    uint_fast32_t num_runs = 5;
+    const char *selected[16];
+    uint_fast32_t num_selected = 0;
+    for (int argument = 1; argument < argc; ++argument)
+    {
+        if (( ! strcmp(argv[argument], "-s")) && ((argument + 1) < argc))
+        {
+            ++argument;
+            target_length = strtoul(argv[argument], NULL, 10) * 1024 * 1024;
+        }
+        else if (( ! strcmp(argv[argument], "-r")) && ((argument + 1) < argc))
+        {
+            ++argument;
+            num_runs = strtoul(argv[argument], NULL, 10);
+        }
+        else if (argv[argument][0] == '-')
+        {
+            fprintf(
+                stderr,
+                "Usage: %s [-s <MiB per corpus>] [-r <runs>] [corpus...]\n",
+                argv[0]
+            );
+            return 2;
+        }
+        else if (num_selected < 16)
+        {
+            selected[num_selected] = argv[argument];
+            ++num_selected;
+        }
+    }
+    if (num_runs == 0)
+    {
+        num_runs = 1;
+    }
+
+    uint_fast32_t num_kinds = sizeof(bench_corpora) / sizeof(bench_corpora[0]);
+    for (uint_fast32_t kind = 0; kind < num_kinds; ++kind)
+    {
+        const char *name = bench_corpora[kind].name;
+        bool is_selected = num_selected == 0;
+        for (uint_fast32_t index = 0; index < num_selected; ++index)
+        {
+            is_selected |= ! strcmp(selected[index], name);
+        }
+        if ( ! is_selected)
+        {
+            continue;
+        }
+
+        BenchCorpus corpus;
+        memset(&corpus, 0, sizeof(BenchCorpus));
+        corpus.capacity = 4096;
+        corpus.text = malloc(corpus.capacity);
+        corpus.random_state = BENCH_SEED + kind;
+        bench_corpora[kind].fn_generate(&corpus, target_length);
+
+        bench_run_parse(name, &corpus, num_runs);
+        bench_run_lookups(name, &corpus);
+
+        for (uint_fast32_t query = 0; query < corpus.num_queries; ++query)
+        {
+            free(corpus.queries[query]);
+        }
+        free(corpus.text);
+    }
+    return 0;
+}
+
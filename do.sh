@@ -42,10 +42,89 @@ make_static_library() {
         $PROJECT_PATH/.build/objects/*.o
 }
 
+build_tools() {
+    mkdir -p $PROJECT_PATH/.build/tools
+
+    for TOOL_FILE in $(find $PROJECT_PATH/tools-c -type f | grep .c\$)
+    do
+        TOOL_NAME=$(basename $TOOL_FILE .c)
+        echo "==> tools-c/$TOOL_NAME.c"
+        $CC $BUILD_OPTIONS \
+            -o $PROJECT_PATH/.build/tools/$TOOL_NAME \
+            $TOOL_FILE \
+            -I $INCLUDE_PATHS \
+            $PROJECT_PATH/libcini.a \
+            -lpthread
+    done
+}
+
+build_benchmarks() {
+    mkdir -p $PROJECT_PATH/.build/bench
+
+    for BENCH_FILE in $(find $PROJECT_PATH/bench-c -type f | grep .c\$)
+    do
+        BENCH_NAME=$(basename $BENCH_FILE .c)
+        echo "==> bench-c/$BENCH_NAME.c" >&2
+        $CC $BUILD_OPTIONS \
+            -o $PROJECT_PATH/.build/bench/$BENCH_NAME \
+            $BENCH_FILE \
+            -I $INCLUDE_PATHS \
+            $PROJECT_PATH/libcini.a \
+            -lpthread
+    done
+}
+
+build_tests() {
+    mkdir -p $PROJECT_PATH/.build/tests
+    rm -f $PROJECT_PATH/.build/tests/*
+
+    # The tests are linked against the sources rather than libcini.a,
+    # so that the whole library is built with the thread sanitizer.
+
+    for TEST_FILE in $(find $PROJECT_PATH/test-c -type f | grep .c\$)
+    do
+        TEST_NAME=$(basename $TEST_FILE .c)
+        echo "==> test-c/$TEST_NAME.c"
+        $CC $BUILD_OPTIONS -fsanitize=thread \
+            -o $PROJECT_PATH/.build/tests/$TEST_NAME \
+            $TEST_FILE \
+            $PROJECT_PATH/src-c/*.c \
+            -I $INCLUDE_PATHS \
+            -lpthread || return 1
+    done
+}
+
+run_tests() {
+    NUM_FAILED=0
+    for TEST_PROGRAM in $PROJECT_PATH/.build/tests/*
+    do
+        if ! TSAN_OPTIONS="halt_on_error=1 $TSAN_OPTIONS" $TEST_PROGRAM
+        then
+            echo "==> $(basename $TEST_PROGRAM) failed"
+            ((NUM_FAILED++))
+        fi
+    done
+    return $NUM_FAILED
+}
+
 case $1 in
     "" | "b" | "build")
         build_sources
         make_static_library
+        build_tools
+        ;;
+    "bench")
+        # Only the results go to the standard output, so that they can
+        # be piped into a file and compared between releases.
+
+        build_sources >&2
+        make_static_library >&2
+        build_benchmarks
+        $PROJECT_PATH/.build/bench/cini-bench "${@:2}"
+        ;;
+    "test")
+        build_tests || exit 1
+        run_tests
         ;;
     *)
         echo "Unknown Action!"
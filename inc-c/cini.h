@@ -7,6 +7,11 @@
 #include <stdio.h>
 
 typedef void CiniDocument;
+typedef void CiniQuery;
+typedef void CiniParser;
+typedef void CiniWatcher;
+typedef void CiniReader;
+typedef void CiniOverlay;
 
 typedef enum
 {
@@ -18,6 +23,10 @@ typedef enum
     CINI_SECTION_NONEXISTENT,
     CINI_KEY_NONEXISTENT,
     CINI_SYNTAX_ERROR,
+    CINI_INVALID_ENCODING,
+    CINI_TYPE_MISMATCH,
+    CINI_DOCUMENT_FROZEN,
+    CINI_WRITE_FAILURE,
     
     // ==> Internal Errors
 
@@ -32,10 +41,66 @@ typedef enum
 
 typedef enum
 {
-    CINI_FEATURE_LOG = 1
+    CINI_FEATURE_LOG = 1,
+    CINI_FEATURE_PROFILING = 1 << 1
 
 } CiniFeature;
 
+typedef enum
+{
+    CINI_UNKNOWN_VALUE = 0,
+
+    CINI_VALUE_INTEGER = 1,
+    CINI_VALUE_DECIMAL = 1 << 1,
+    CINI_VALUE_STRING = 1 << 2,
+    CINI_VALUE_BOOLEAN = 1 << 3,
+    CINI_VALUE_ARRAY = 1 << 4,
+
+    CINI_INVALID_VALUE = 0xffff
+
+} CiniValueType;
+
+/// @brief View of a string that isn't necessarily zero-terminated.
+typedef struct
+{
+    const char *string;
+    uint_fast32_t length;
+
+} CiniSlice;
+
+/// @brief Called for every section header.
+/// @param path
+///        Levels of the section's name, which are views into the source.
+///        The array is only valid during the call.
+/// @return
+/// Whether to continue parsing.
+typedef bool (*CiniSectionFn)(
+    const CiniSlice *path,
+    uint_fast32_t num_levels,
+    void *userdata
+);
+
+/// @brief Called for every field, in the section of the latest header.
+/// @param is_escaped
+///        Whether the value contains escape sequences, which can be
+///        resolved with `cini_unescape_text`.
+/// @return
+/// Whether to continue parsing.
+typedef bool (*CiniFieldFn)(
+    const CiniSlice *key,
+    const CiniSlice *value,
+    bool is_escaped,
+    void *userdata
+);
+
+typedef struct
+{
+    CiniSectionFn fn_section;
+    CiniFieldFn fn_field;
+    void *userdata;
+
+} CiniHandler;
+
 typedef void * (*CiniAllocateFn)(
     uint_fast32_t amount,
     void *userdata
@@ -46,6 +111,51 @@ typedef void (*CiniFreeFn)(
     void *userdata
 );
 
+/// @brief Sizing of a document's arena. Fields which are zero get
+///        their default.
+typedef struct
+{
+    /// @brief Capacity of the first block in bytes; 16 KiB by default.
+    uint32_t initial_capacity;
+
+    /// @brief Alignment of allocations; a power of two up to 64, and
+    ///        8 by default.
+    uint32_t alignment;
+
+    /// @brief Factor by which each block is larger than the previous;
+    ///        2 by default.
+    uint32_t growth_factor;
+
+    /// @brief Capacity beyond which blocks don't grow any further,
+    ///        unless a single allocation needs a larger block; 16 MiB
+    ///        by default.
+    uint32_t max_block_capacity;
+
+    /// @brief Whether resetting the document keeps all blocks as they
+    ///        are, instead of merging them into a single block.
+    bool retain_blocks;
+
+} CiniArenaConfig;
+
+/// @brief Settings for parsing many files at once. Fields which are zero
+///        get their default.
+typedef struct
+{
+    /// @brief Number of threads including the calling one, or zero for
+    ///        one per online processor.
+    uint32_t num_threads;
+
+    /// @brief Allocator of all documents, which must be thread-safe,
+    ///        or `NULL` for `malloc()` and `free()`.
+    CiniAllocateFn fn_alloc;
+    CiniFreeFn fn_free;
+    void *allocator;
+
+    /// @brief Sizing of the documents' arenas, or `NULL`.
+    const CiniArenaConfig *arena_config;
+
+} CiniBatchOptions;
+
 
 
 // ==> Document Management
@@ -58,28 +168,228 @@ CiniDocument * cini_new_document(
     void *userdata
 );
 
+/// @brief Create a document whose arena is sized by a configuration,
+///        like one with a large first block for big sources.
+/// @param arena_config
+///        Sizing of the document's arena, or `NULL` for the defaults.
+///        Fields which are zero get their default as well.
+CiniDocument * cini_new_configured_document(
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata,
+    const CiniArenaConfig *arena_config
+);
+
 void cini_free_document(
     CiniDocument *document
 );
 
+/// @brief Empty a document so that it can be parsed into again. The
+///        arena's blocks are kept and rewound, and merged into a single
+///        block sized to the previous usage unless the arena's config
+///        retains them, so that a document which is re-parsed regularly
+///        stops calling its allocator.
 void cini_reset_document(
     CiniDocument *document
 );
 
+/// @brief Finish everything which the getters would otherwise do on
+///        first use, like decoding values, copying them out of the
+///        source and building full section names, and make the document
+///        read-only. Afterwards, all getters and section topology
+///        functions may be called from any number of threads without
+///        synchronization, once the document was handed to them.
+///        Parsing into a frozen document fails with
+///        `CINI_DOCUMENT_FROZEN`; resetting it thaws it again, which
+///        requires that no other thread still reads it.
+/// @return
+/// `CINI_SUCCESS` or `CINI_INVALID_POINTER`.
+int_fast8_t cini_freeze(
+    CiniDocument *document
+);
+
+/// @brief Choose across how many threads large sources are parsed.
+///        The source is split at section headers which start a line,
+///        so that sources with few sections are still parsed by one
+///        thread. The document's allocator must be thread-safe to use
+///        more than one thread.
+/// @param num_threads
+///        Number of threads including the calling one, or zero for one
+///        per online processor. Documents start out with one.
+void cini_set_parse_threads(
+    CiniDocument *document,
+    uint_fast32_t num_threads
+);
+
+/// @brief Enable or disable an optional feature of a document.
+///        Enabling `CINI_FEATURE_LOG` gives the document an empty log;
+///        disabling it drops the log. Enabling `CINI_FEATURE_PROFILING`
+///        starts a new parse profile, if the library was built with
+///        `CINI_PROFILING`.
 void cini_set_feature(
     CiniDocument *document,
     CiniFeature feature,
     bool value
 );
 
+
+
+// ==> Memory Statistics
+
+/// @brief Breakdown of a document's memory, for sizing the memory of a
+///        process which holds documents and for finding the ones which
+///        take up more than their text would suggest.
+typedef struct
+{
+    /// @brief Blocks of the document's arena, the bytes of data which
+    ///        they reserve and the bytes of those which are taken up.
+    uint64_t num_arena_blocks;
+    uint64_t arena_bytes_reserved;
+    uint64_t arena_bytes_used;
+
+    /// @brief Bytes of the used ones which are held by `sub_sections`
+    ///        arrays and hash indexes that were outgrown and replaced.
+    uint64_t abandoned_sub_section_bytes;
+    uint64_t abandoned_index_bytes;
+
+    /// @brief Bytes of sources which the document copied, and of files
+    ///        which it mapped, such as a loaded compiled document.
+    uint64_t source_copy_bytes;
+    uint64_t source_mapping_bytes;
+
+    /// @brief Sections without the root section, and fields.
+    uint64_t num_sections;
+    uint64_t num_fields;
+
+    /// @brief Section names, full names which were built, keys and
+    ///        values, and their length without terminators.
+    uint64_t num_strings;
+    uint64_t string_bytes;
+
+    /// @brief Calls of the document's allocator since it was created,
+    ///        including the one which allocated the document itself.
+    uint64_t num_allocations;
+    uint64_t num_frees;
+
+} CiniMemoryStats;
+
+/// @brief Measure a document's memory. This walks all of its sections
+///        and fields, so it shouldn't be called on a hot path.
+/// @return
+/// `CINI_SUCCESS` or `CINI_INVALID_POINTER`.
+int_fast8_t cini_get_memory_stats(
+    CiniDocument *document,
+    CiniMemoryStats *stats
+);
+
+
+
+// ==> Parse Profiling
+
+/// @brief Time spent in the phases of parsing and the events counted in
+///        them, summed over all threads which parsed. Each phase's time
+///        excludes that of the phases nested in it, like scanning which
+///        happens while a field is parsed.
+typedef struct
+{
+    /// @brief Time spent in every phase together.
+    uint64_t total_ns;
+
+    /// @brief Classifying and validating windows of the source.
+    uint64_t scan_ns;
+    /// @brief Splitting section headers into the links of their path.
+    uint64_t split_ns;
+    /// @brief Finding and creating the sections of headers.
+    uint64_t section_ns;
+    /// @brief Parsing fields and adding them to their section.
+    uint64_t field_ns;
+    /// @brief Continuing the arena in another block.
+    uint64_t arena_ns;
+    /// @brief Everything else, like skipping comments and empty lines.
+    uint64_t other_ns;
+
+    uint64_t num_windows;
+    uint64_t num_runes;
+    uint64_t num_headers;
+    uint64_t num_fields;
+    uint64_t num_sub_section_probes;
+    uint64_t num_arena_continuations;
+
+} CiniParseProfile;
+
+/// @brief Read what a document's profiler measured since profiling was
+///        enabled with `CINI_FEATURE_PROFILING`. Everything is zero if
+///        it wasn't, or if the library wasn't built with
+///        `CINI_PROFILING`.
+/// @return
+/// `CINI_SUCCESS` or `CINI_INVALID_POINTER`.
+int_fast8_t cini_get_parse_profile(
+    CiniDocument *document,
+    CiniParseProfile *profile
+);
+
+
+
+// ==> Logging
+
+// Number of entries a document's log holds; older ones are overwritten.
+#define CINI_LOG_CAPACITY 64
+
+typedef enum
+{
+    CINI_LOG_INVALID_UTF8 = 1,
+    CINI_LOG_QUOTED_SECTION_NAME,
+    CINI_LOG_EMPTY_PATH_LINK,
+    CINI_LOG_EMPTY_SECTION_HEADER,
+    CINI_LOG_SECTION_PATH_TOO_DEEP,
+    CINI_LOG_UNCLOSED_SECTION_HEADER,
+    CINI_LOG_CHARACTERS_AFTER_HEADER,
+    CINI_LOG_MISSING_EQUALS_SIGN,
+    CINI_LOG_QUOTED_KEY,
+    CINI_LOG_MISSING_KEY,
+    CINI_LOG_KEY_TOO_LONG,
+    CINI_LOG_UNCLOSED_QUOTED_VALUE,
+    CINI_LOG_CHARACTERS_AFTER_VALUE
+
+} CiniLogMessage;
+
+/// @brief Problem which was found while parsing. Lines and columns
+///        count from one; columns are counted in bytes.
+typedef struct
+{
+    CiniStatus status;
+    CiniLogMessage message;
+    uint64_t offset;
+    uint32_t line;
+    uint32_t column;
+
+    /// @brief Static, human-readable description of the message.
+    const char *text;
+
+} CiniLogEntry;
+
+/// @return
+/// Description of the latest entry of a document's log, or `NULL` if
+/// the log is empty or logging isn't enabled.
 const char * cini_get_log(
     CiniDocument *document
 );
 
+/// @brief Read an entry of a document's log. The log is filled while
+///        `CINI_FEATURE_LOG` is enabled and emptied when the document is
+///        reset.
+/// @param index
+///        Index of the entry, with zero for the oldest one which the log
+///        still holds.
+/// @param entry
+///        Pointer to where to put the entry, which is only written if
+///        there is an entry at `index`. May be `NULL`.
+/// @return
+/// Number of entries in the log, or `CINI_INVALID_POINTER`.
 int_fast32_t cini_get_log_entry(
     CiniDocument *document,
     uint_fast32_t index,
-    uint_fast32_t 
+    CiniLogEntry *entry
 );
 
 
@@ -107,12 +417,314 @@ int_fast8_t cini_parse_file_pointer(
     FILE *pointer
 );
 
+/// @brief Parse a file descriptor's content into a document.
+///        Regular files are memory-mapped and the document keeps the
+///        mapping until it is freed; the parsed names, keys and values
+///        point into it instead of being copied. Other descriptors,
+///        like pipes, are read to their end first.
+/// @param buffer
+///        Document into which to parse the file.
+/// @param fd
+///        Readable file descriptor, which may be closed afterwards.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_parse_fd(
+    CiniDocument *buffer,
+    int fd
+);
+
+
+
+// ==> Batch Parsing
+
+/// @brief Parse many files, each into a document of its own, on a pool
+///        of threads. Every thread opens its next file and asks the
+///        kernel to read it ahead before parsing its current one, so
+///        reading and parsing overlap.
+/// @param documents
+///        Array of `count` pointers which are set to the documents, or to
+///        `NULL` if a document couldn't be allocated. Documents of files
+///        which failed hold what was parsed before the error; all of
+///        them must be freed with `cini_free_document`.
+/// @param statuses
+///        Array of `count` statuses which are set to the status of each
+///        file, or `NULL`.
+/// @param options
+///        Settings of the batch, or `NULL` for the defaults.
+/// @return
+/// `CINI_SUCCESS` if every file was parsed, otherwise the negative
+/// `CiniStatus` of the first file, in the order of `paths`, which failed.
+int_fast8_t cini_parse_many(
+    const char *const *paths,
+    uint_fast32_t count,
+    CiniDocument **documents,
+    int_fast8_t *statuses,
+    const CiniBatchOptions *options
+);
+
+
+
+// ==> Incremental Parsing
+
+typedef enum
+{
+    CINI_SECTION_ADDED = 1,
+    CINI_SECTION_MODIFIED,
+    CINI_SECTION_REMOVED
+
+} CiniSectionChange;
+
+/// @brief Called for every section whose fields changed in a re-parse.
+/// @param section
+///        Full name of the section, which is empty for the root section.
+typedef void (*CiniChangeFn)(
+    const char *section,
+    CiniSectionChange change,
+    void *userdata
+);
+
+/// @brief Bring a document up to date with a new version of its source,
+///        re-parsing only the sections whose content changed. The source
+///        is split into blocks at every section header, and each block
+///        is hashed. A section is re-parsed if its sequence of block
+///        hashes differs from the previous source's; all other sections
+///        keep their fields. Everything is copied out of the source;
+///        the memory of replaced fields is only reused once the
+///        document is reset.
+///        The first re-parse of a document parses every section, as the
+///        document has no block hashes yet; it reports a section which
+///        still exists as modified only if it has fields before or
+///        after.
+/// @param fn_change
+///        Function which is called for every added, modified or removed
+///        section after the document was updated, or `NULL`.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error. On error, the
+/// document is parsed from the new source as a whole, like a document
+/// which was reset, and no changes are reported.
+int_fast8_t cini_reparse_source(
+    CiniDocument *document,
+    const char *source,
+    uint_fast32_t len_source,
+    CiniChangeFn fn_change,
+    void *userdata
+);
+
+
+
+// ==> Streaming
+
+/// @brief Begin parsing a source which arrives in chunks, like from a
+///        pipe or a socket, into a document. Lines, section headers,
+///        fields and UTF-8 sequences may be cut at any chunk boundary;
+///        only the incomplete last line of a chunk is kept until the
+///        next one arrives.
+/// @return
+/// A parser which must be finished with `cini_parser_end`, or `NULL`
+/// on error.
+CiniParser * cini_parser_begin(
+    CiniDocument *document
+);
+
+/// @brief Parse the next chunk of a streamed source. The chunk is
+///        copied where needed and may be reused afterwards.
+/// @return
+/// `CINI_SUCCESS` or the negative `CiniStatus` of the first error, which
+/// every later call returns as well.
+int_fast8_t cini_parser_feed(
+    CiniParser *parser,
+    const char *chunk,
+    uint_fast32_t len_chunk
+);
+
+/// @brief Parse the last, unterminated line of a streamed source and
+///        free the parser.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_parser_end(
+    CiniParser *parser
+);
+
+
+
+// ==> Handlers
+
+/// @brief Parse a source without building a document, reporting its
+///        sections and fields to a handler instead. Nothing is
+///        allocated; keys and values are views into the source. As the
+///        source is validated in windows, events may be reported before
+///        an encoding error further on is found.
+/// @return
+/// `CINI_SUCCESS`, also if the handler stopped parsing, or a negative
+/// `CiniStatus` on error.
+int_fast8_t cini_parse_with_handler(
+    const CiniHandler *handler,
+    const char *source,
+    uint_fast32_t len_source
+);
+
+/// @brief Resolve the escape sequences of a quoted value's content,
+///        as handed to a handler's `fn_field` with `is_escaped` set.
+/// @param buffer
+///        Buffer of at least `len_text` bytes for the resolved text,
+///        which isn't zero-terminated.
+/// @return
+/// Length of the resolved text.
+uint_fast32_t cini_unescape_text(
+    const char *text,
+    uint_fast32_t len_text,
+    char *buffer
+);
+
+
+
+// ==> Writing
+
+/// @brief Write a document as INI text into a buffer. Sections are
+///        written in the order of the linear section list, each key
+///        once with its winning value. Values are only quoted if they
+///        couldn't be read back otherwise, and only escaped within
+///        quotes, so parsing the text gives the same document and
+///        writing that one gives the same text.
+/// @param buffer
+///        Buffer into which to write the zero-terminated text, or `NULL`
+///        for getting the text's length.
+/// @param len_buffer
+///        Length of `buffer`, which must have room for the terminator.
+/// @return
+/// Length of the text without the terminator, or a negative
+/// `CiniStatus` like `CINI_LIMITATION_EXCEEDED` if it doesn't fit.
+int_fast32_t cini_write_document(
+    CiniDocument *document,
+    char *buffer,
+    uint_fast32_t len_buffer
+);
+
+/// @brief Write a document as INI text to a stream in large batches.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_write_document_file(
+    CiniDocument *document,
+    FILE *file
+);
+
+/// @brief Write a document as INI text to a file descriptor, handing
+///        it the gathered pieces in batches with `writev`.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_write_document_fd(
+    CiniDocument *document,
+    int fd
+);
+
+
+
+// ==> Compiled Documents
+
+/// @brief Save a document as a compiled image, which can be loaded
+///        without parsing. The file is replaced atomically.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_save_compiled(
+    CiniDocument *document,
+    const char *path
+);
+
+/// @brief Load a compiled image by mapping it. The document is
+///        read-only and works with all getters and topology functions;
+///        resetting it turns it into an empty, regular document. Only
+///        the header is checked, so that loading takes the same time
+///        for images of any size; images which may be damaged or come
+///        from elsewhere should be checked with `cini_verify_compiled`
+///        first.
+/// @param fn_alloc
+///        Allocator of the document, which is created like by
+///        `cini_new_document` with `fn_free` and `userdata`.
+/// @return
+/// The document, or `NULL` if the file can't be mapped or isn't a
+/// compiled image of this version and byte order.
+CiniDocument * cini_load_compiled(
+    const char *path,
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata
+);
+
+/// @brief Check every section, field, sub-section link, index slot and
+///        string of a compiled image, so that the getters can't be led
+///        out of the mapping by a damaged one. This reads the whole
+///        image, unlike `cini_load_compiled`.
+/// @return
+/// `CINI_SUCCESS`, `CINI_FILE_NOT_FOUND` if the file can't be opened or
+/// mapped, or `CINI_SYNTAX_ERROR` if it isn't a valid compiled image of
+/// this version and byte order.
+int_fast8_t cini_verify_compiled(
+    const char *path
+);
+
+
+
+// ==> Hot Reloading
+
+/// @brief Parse a file and re-parse it whenever it is written or
+///        replaced, on a thread of the watcher's own. Each version of
+///        the file is parsed into a fresh document, which is frozen
+///        and published with an atomic swap if parsing succeeded.
+/// @return
+/// The watcher, or `NULL` if the file can't be parsed or watched.
+CiniWatcher * cini_watch_path(
+    const char *path
+);
+
+/// @brief Stop watching and free all documents. No reader may be in
+///        the middle of a read.
+void cini_free_watcher(
+    CiniWatcher *watcher
+);
+
+/// @brief Add a reader, which is meant to be kept by one thread.
+/// @return
+/// The reader, or `NULL` on allocation failure.
+CiniReader * cini_add_reader(
+    CiniWatcher *watcher
+);
+
+void cini_remove_reader(
+    CiniReader *reader
+);
+
+/// @brief Begin a read of a watcher's latest document without locking.
+///        The document stays valid until `cini_end_read`. Reads of
+///        the same reader can't be nested.
+CiniDocument * cini_begin_read(
+    CiniReader *reader
+);
+
+void cini_end_read(
+    CiniReader *reader
+);
+
+/// @brief Get the number of documents a watcher has published, which
+///        starts at one for the first parse.
+uint_fast32_t cini_get_watcher_version(
+    CiniWatcher *watcher
+);
+
+/// @brief Get the status of the latest re-parse. If it failed, the
+///        previous document stays published.
+int_fast8_t cini_get_watcher_status(
+    CiniWatcher *watcher
+);
+
 
 
 // ==> Section Topology
 
 /// @brief Get number of sections within a document or number of
-///        sub-sections within another section.
+///        sub-sections within another section. Unless the document
+///        is frozen, this builds its section table on first use, so
+///        concurrent calls need external synchronization; see
+///        `cini_freeze`.
 /// @param document
 ///        Document of which to get the number of sections.
 /// @param super_section
@@ -127,7 +739,10 @@ int_fast32_t cini_get_section_count(
 );
 
 /// @brief Get name of section at an index in the list of documents,
-///        possibly within a `super_section`.
+///        possibly within a `super_section`. Unless the document is
+///        frozen, this builds its section table and the full name on
+///        first use, so concurrent calls need external
+///        synchronization; see `cini_freeze`.
 /// @param document
 ///        Document of which to get an entry of the section list.
 /// @param super_section
@@ -148,29 +763,72 @@ const char * cini_get_section_name(
 
 // ==> Value Gathering
 
+/// @brief Get a boolean value. `true`, `yes`, `on` and `1` are true,
+///        `false`, `no`, `off` and `0` are false, ignoring case.
+/// @param query
+///        `<section>:<key>` value to search in the document. Keys of
+///        the root section may be queried without a section.
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT`, `CINI_KEY_NONEXISTENT`
+/// or `CINI_TYPE_MISMATCH` if the value isn't a boolean.
 int_fast8_t cini_get_bool(
     CiniDocument *document,
     const char *query,
     bool *buffer
 );
 
+/// @brief Get a signed 64-bit integer value. It may have a `+` or `-`
+///        sign and a `0x`, `0o` or `0b` prefix for hexadecimal, octal
+///        or binary digits, in either case. Single underscores may
+///        separate digits, like in `1_000_000` or `0xFF_FF`. Values
+///        which don't fit into an `int64_t` are rejected, not clamped.
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT`, `CINI_KEY_NONEXISTENT`
+/// or `CINI_TYPE_MISMATCH` if the value isn't an integer in range.
 int_fast8_t cini_get_int(
     CiniDocument *document,
     const char *query,
     int64_t *buffer
 );
 
+/// @brief Get a floating point value. It may have a `+` or `-` sign,
+///        a fraction after a `.` and an exponent after `e` or `E`, like
+///        `-1.5e-3`, and single underscores between decimal digits.
+///        `inf`, `infinity` and `nan` are accepted in any case, and
+///        integers with a `0x`, `0o` or `0b` prefix are converted.
+///        Finite values which overflow a `double` are rejected; tiny
+///        ones round towards zero.
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT`, `CINI_KEY_NONEXISTENT`
+/// or `CINI_TYPE_MISMATCH` if the value isn't a number.
 int_fast8_t cini_get_decimal(
     CiniDocument *document,
     const char *query,
     double *buffer
 );
 
+/// @brief Get a text value. If a key is assigned more than once within
+///        a section, the last assignment wins. Unless the document is
+///        frozen, values which aren't zero-terminated in the source
+///        are copied into the document on first use, so concurrent
+///        calls need external synchronization; see `cini_freeze`.
+/// @return
+/// Zero-terminated text owned by the document, or `NULL` if the value
+/// doesn't exist.
 const char * cini_get_text(
     CiniDocument *document,
     const char *query
 );
 
+/// @brief Get the types as which a value can be read, as a bitmask of
+///        `CiniValueType`s. Every value can be read as a string.
+/// @return
+/// The bitmask, `CINI_SECTION_NONEXISTENT` or `CINI_KEY_NONEXISTENT`.
+int_fast32_t cini_get_value_types(
+    CiniDocument *document,
+    const char *query
+);
+
 /// @brief Duplicate a text value from an INI-document into a buffer.
 /// @param document
 ///        Document supposed to contain the value.
@@ -193,9 +851,175 @@ const char * cini_get_text(
 int_fast32_t cini_write_text(
     CiniDocument *document,
     const char *query,
-    const char *buffer,
+    char *buffer,
     int_fast32_t len_buffer
 );
 
+
+
+// ==> Value Mutation
+
+/// @brief Set a value, creating its section and key if they don't exist
+///        yet. An existing key keeps its position; if its value is a
+///        copy of the document's own which is long enough, the text is
+///        written over it, otherwise the text is copied into the arena.
+///        Replaced values are only reclaimed when the document is reset.
+///        Pointers which getters returned for the previous value may
+///        show the new one or stay unchanged.
+/// @param query
+///        `<section>:<key>` value to set. Keys of the root section may be
+///        given without a section.
+/// @return
+/// `CINI_SUCCESS`, `CINI_DOCUMENT_FROZEN` for frozen and loaded compiled
+/// documents, or `CINI_SYNTAX_ERROR` if the section path is malformed or
+/// the key or a new section's name couldn't be written as INI text, like
+/// names which contain `[`, `]`, `=`, `;`, `#`, `"`, `:` or line breaks.
+int_fast8_t cini_set_text(
+    CiniDocument *document,
+    const char *query,
+    const char *text
+);
+
+/// @brief Set an integer value, which is stored in decimal and read back
+///        without being decoded again.
+/// @return
+/// See `cini_set_text`.
+int_fast8_t cini_set_int(
+    CiniDocument *document,
+    const char *query,
+    int64_t value
+);
+
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT`, `CINI_KEY_NONEXISTENT` or
+/// `CINI_DOCUMENT_FROZEN`.
+int_fast8_t cini_remove_key(
+    CiniDocument *document,
+    const char *query
+);
+
+/// @brief Remove a section with all of its keys and sub-sections. The
+///        root section can't be removed; its keys can.
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT` or `CINI_DOCUMENT_FROZEN`.
+int_fast8_t cini_remove_section(
+    CiniDocument *document,
+    const char *section
+);
+
+
+
+// ==> Compiled Queries
+
+/// @brief Compile a `<section>:<key>` query into a handle for repeated
+///        lookups of the same value. The handle stays valid when the
+///        document is reset or more sources are parsed into it; it is
+///        resolved again on its next use then.
+/// @return
+/// The handle, which must be freed with `cini_free_query` before the
+/// document is freed, or `NULL` on error.
+CiniQuery * cini_compile_query(
+    CiniDocument *document,
+    const char *query
+);
+
+void cini_free_query(
+    CiniQuery *query
+);
+
+int_fast8_t cini_get_bool_q(
+    CiniQuery *query,
+    bool *buffer
+);
+
+int_fast8_t cini_get_int_q(
+    CiniQuery *query,
+    int64_t *buffer
+);
+
+int_fast8_t cini_get_decimal_q(
+    CiniQuery *query,
+    double *buffer
+);
+
+const char * cini_get_text_q(
+    CiniQuery *query
+);
+
+
+
+// ==> Overlays
+
+/// @brief Create a view which stacks documents. A value is read from
+///        the last layer which has it; the layers' own indexes are used
+///        to find it, and the winning layer is cached per query.
+///        The view isn't thread-safe, as lookups fill its cache.
+/// @param layers
+///        Array of `num_layers` documents, from the lowest to the
+///        highest precedence. Only the array is copied.
+/// @return
+/// The overlay, or `NULL` on error.
+CiniOverlay * cini_new_overlay(
+    CiniDocument *const *layers,
+    uint_fast32_t num_layers
+);
+
+void cini_free_overlay(
+    CiniOverlay *overlay
+);
+
+/// @brief Find the layer from which a value is read.
+/// @return
+/// Index of the layer, `CINI_SECTION_NONEXISTENT` if no layer has the
+/// section, or `CINI_KEY_NONEXISTENT` if no layer has the key.
+int_fast32_t cini_get_overlay_layer(
+    CiniOverlay *overlay,
+    const char *query
+);
+
+int_fast8_t cini_get_overlay_bool(
+    CiniOverlay *overlay,
+    const char *query,
+    bool *buffer
+);
+
+int_fast8_t cini_get_overlay_int(
+    CiniOverlay *overlay,
+    const char *query,
+    int64_t *buffer
+);
+
+int_fast8_t cini_get_overlay_decimal(
+    CiniOverlay *overlay,
+    const char *query,
+    double *buffer
+);
+
+/// @return
+/// Zero-terminated text owned by the winning layer, or `NULL` if no
+/// layer has the value.
+const char * cini_get_overlay_text(
+    CiniOverlay *overlay,
+    const char *query
+);
+
+/// @brief Merge all layers into a new document in one pass over each
+///        of them, from the lowest layer to the highest. Every key ends
+///        up with the value of the highest layer which has it, while
+///        sections and keys keep the position of their first occurrence.
+///        Everything is copied, so the layers may be freed afterwards.
+/// @param fn_alloc
+///        Allocator of the new document, which is created by
+///        `cini_new_document` with `fn_free` and `userdata`.
+/// @return
+/// The document, which must be freed with `cini_free_document`, or
+/// `NULL` on allocation failure.
+CiniDocument * cini_flatten_overlay(
+    CiniOverlay *overlay,
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata
+);
+
 #endif // CINI_H
 
@@ -0,0 +1,194 @@
+
+#ifndef CINI_COMPILED_H
+#define CINI_COMPILED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+#include <cini/utility.h>
+
+// The compiled format is a flat image of a document which is loaded by
+// mapping it. It contains no pointers; tables refer to each other by
+// indices and to their strings by offsets into the string table. All
+// numbers are stored in the byte order of the machine which wrote them.
+
+#define CINI_COMPILED_MAGIC "CINIBIN"
+#define CINI_COMPILED_VERSION 1
+#define CINI_COMPILED_BYTE_ORDER 0x01020304
+
+// Index value which refers to nothing, like the root section's parent.
+#define CINI_COMPILED_NONE UINT32_MAX
+
+struct CiniCompiledHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t len_file;
+
+    uint32_t num_sections;
+    uint32_t num_fields;
+    uint32_t num_sub_section_links;
+    uint32_t num_section_slots;
+    uint32_t num_field_slots;
+    uint32_t len_strings;
+
+    /// @brief Offsets of the tables from the start of the file.
+    uint32_t sections_offset;
+    uint32_t fields_offset;
+    uint32_t sub_section_links_offset;
+    uint32_t section_slots_offset;
+    uint32_t field_slots_offset;
+    uint32_t strings_offset;
+};
+
+/// @brief Section in the order of the document's linear section list,
+///        with the root section first. Its sub-sections are a range of
+///        the sub-section link table and its fields are a range of the
+///        field table.
+typedef struct
+{
+    uint32_t name;
+    uint32_t len_name;
+    uint32_t name_hash;
+    uint32_t full_name;
+    uint32_t parent;
+
+    uint32_t first_sub_section_link;
+    uint32_t num_sub_sections;
+    uint32_t first_section_slot;
+    uint32_t section_index_capacity;
+
+    uint32_t first_field;
+    uint32_t num_fields;
+    uint32_t first_field_slot;
+    uint32_t field_index_capacity;
+
+} CiniCompiledSection;
+
+/// @brief Field with its value decoded as every type it can be read as.
+typedef struct
+{
+    int64_t integer;
+    double decimal;
+
+    uint32_t key;
+    uint32_t len_key;
+    uint32_t key_hash;
+    uint32_t value;
+    uint32_t len_value;
+
+    uint16_t applicable_types;
+    uint8_t boolean;
+    uint8_t reserved;
+
+} CiniCompiledField;
+
+/// @brief Slot of an open-addressing index. `index` is the index of the
+///        section or field plus one, so that zero marks an empty slot.
+typedef struct
+{
+    uint32_t hash;
+    uint32_t index;
+
+} CiniCompiledSlot;
+
+/// @brief Save a document as a compiled image, which can be loaded
+///        without parsing. The file is replaced atomically.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_save_compiled(
+    CiniDocument *document,
+    const char *path
+);
+
+/// @brief Load a compiled image by mapping it. The document is
+///        read-only and works with all getters and topology functions;
+///        resetting it turns it into an empty, regular document. Only
+///        the header is checked, so that loading takes the same time
+///        for images of any size; images which may be damaged or come
+///        from elsewhere should be checked with `cini_verify_compiled`
+///        first.
+/// @param fn_alloc
+///        Allocator of the document, which is created like by
+///        `cini_new_document` with `fn_free` and `userdata`.
+/// @return
+/// The document, or `NULL` if the file can't be mapped or isn't a
+/// compiled image of this version and byte order.
+CiniDocument * cini_load_compiled(
+    const char *path,
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata
+);
+
+/// @brief Check every section, field, sub-section link, index slot and
+///        string of a compiled image, so that the getters can't be led
+///        out of the mapping by a damaged one. This reads the whole
+///        image, unlike `cini_load_compiled`.
+/// @return
+/// `CINI_SUCCESS`, `CINI_FILE_NOT_FOUND` if the file can't be opened or
+/// mapped, or `CINI_SYNTAX_ERROR` if it isn't a valid compiled image of
+/// this version and byte order.
+int_fast8_t cini_verify_compiled(
+    const char *path
+);
+
+const CiniCompiledSection * cini_internal_get_compiled_section(
+    const CiniCompiledHeader *header,
+    uint_fast32_t index
+);
+
+const CiniCompiledField * cini_internal_get_compiled_field(
+    const CiniCompiledHeader *header,
+    uint_fast32_t index
+);
+
+/// @brief Get a section's or field's slots from the slot table at a
+///        table offset.
+const CiniCompiledSlot * cini_internal_get_compiled_slots(
+    const CiniCompiledHeader *header,
+    uint32_t table_offset,
+    uint_fast32_t first_slot
+);
+
+/// @brief Find a compiled section by a path string like `a.b.c`.
+/// @return
+/// The section or `NULL` if it doesn't exist or the path is malformed.
+const CiniCompiledSection * cini_internal_resolve_compiled_section(
+    const CiniCompiledHeader *header,
+    const char *path,
+    uint_fast32_t len_path
+);
+
+const CiniCompiledField * cini_internal_find_compiled_field(
+    const CiniCompiledHeader *header,
+    const CiniCompiledSection *section,
+    const char *key,
+    uint_fast32_t len_key
+);
+
+/// @brief Present a compiled field as a regular, fully decoded field,
+///        so that it can be read like one.
+void cini_internal_expose_compiled_field(
+    const CiniCompiledHeader *header,
+    const CiniCompiledField *compiled_field,
+    CiniField *field
+);
+
+const char * cini_internal_get_compiled_string(
+    const CiniCompiledHeader *header,
+    uint32_t offset
+);
+
+/// @brief Get the full name of a compiled section by its index in the
+///        list of all sections or of a super-section's sub-sections.
+const char * cini_internal_get_compiled_section_name(
+    const CiniCompiledHeader *header,
+    const char *super_section,
+    uint_fast32_t index
+);
+
+#endif // CINI_COMPILED_H
+
@@ -2,6 +2,7 @@
 #ifndef CINI_DOCUMENT_H
 #define CINI_DOCUMENT_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <cini/enumerations.h>
@@ -10,6 +11,12 @@
 typedef struct CiniDocument CiniDocument;
 typedef struct CiniSection CiniSection;
 typedef struct CiniField CiniField;
+typedef struct CiniSourceBuffer CiniSourceBuffer;
+typedef struct CiniSourceBlock CiniSourceBlock;
+typedef struct CiniSectionSlot CiniSectionSlot;
+typedef struct CiniFieldSlot CiniFieldSlot;
+typedef struct CiniCompiledHeader CiniCompiledHeader;
+typedef struct CiniLogEntry CiniLogEntry;
 
 typedef enum
 {
@@ -25,44 +32,216 @@ typedef enum
 
 } CiniValueType;
 
+typedef enum
+{
+    /// @brief The value is followed by a zero, so it can be handed out
+    ///        as a C string without copying it first.
+    CINI_FIELD_VALUE_TERMINATED = 1,
+
+    /// @brief The value is a copy in the arena which no other field
+    ///        shares, so a value of up to `value_capacity` bytes can be
+    ///        written over it.
+    CINI_FIELD_VALUE_OWNED = 1 << 1
+
+} CiniFieldFlag;
+
+typedef enum
+{
+    CINI_DECODE_PENDING = 0,
+    CINI_DECODE_RUNNING,
+    CINI_DECODE_DONE
+
+} CiniDecodeState;
+
 struct CiniField
 {
     CiniField *next_in_section;
 
     uint_fast16_t applicable_types;
+    uint_fast16_t flags;
     uint_fast16_t len_key;
     uint_fast32_t len_value;
+    uint32_t key_hash;
+    uint32_t value_capacity;
+
+    /// @brief Key and value. These may be views into a source buffer
+    ///        which the document owns and aren't zero-terminated then.
+    const char *key;
+    const char *value;
+
+    /// @brief Cached decodes of the value. `decode_state` is accessed
+    ///        atomically; `applicable_types` and the decoded values are
+    ///        only valid once it is `CINI_DECODE_DONE`.
+    uint8_t decode_state;
+    bool boolean;
+    int64_t integer;
+    double decimal;
+};
 
-    char *key;
-    char *value;
+/// @brief Slot of a section's open-addressing sub-section index. The
+///        hash is stored next to the pointer so that probing doesn't
+///        need to touch the sections themselves.
+struct CiniSectionSlot
+{
+    uint32_t hash;
+    CiniSection *section;
+};
+
+/// @brief Slot of a section's open-addressing field index.
+struct CiniFieldSlot
+{
+    uint32_t hash;
+    CiniField *field;
 };
 
 struct CiniSection
 {
     CiniSection *linear_next;
+    CiniSection *parent;
+
+    /// @brief Position in the linear section list, which is only set
+    ///        while the document is being compiled or merged.
+    uint_least32_t linear_index;
+
+    /// @brief Name of this level of the section's path. This may be a
+    ///        view into a source buffer and isn't zero-terminated then.
+    const char *name;
+    uint_least32_t len_name;
+    uint32_t name_hash;
+
+    /// @brief Zero-terminated name with all superordinate parts, which
+    ///        is only built when it is asked for.
+    const char *full_name;
 
-    char *name;
     uint_least32_t sub_sections_capacity;
     uint_least32_t num_sub_sections;
     CiniSection **sub_sections;
 
+    /// @brief Hash index over `sub_sections`, which is `NULL` until
+    ///        there are more than `CINI_SUB_SECTION_INDEX_THRESHOLD`
+    ///        sub-sections. Its capacity is a power of two.
+    uint_least32_t sub_section_index_capacity;
+    CiniSectionSlot *sub_section_index;
+
     CiniField *first_field;
+    CiniField *last_field;
+
+    /// @brief Hash index over the fields, which is `NULL` until there
+    ///        are more than `CINI_FIELD_INDEX_THRESHOLD` fields. Its
+    ///        capacity is a power of two.
+    uint_least32_t num_fields;
+    uint_least32_t field_index_capacity;
+    CiniFieldSlot *field_index;
+};
+
+/// @brief Source which lives as long as the document does, either a
+///        memory-mapped file or an allocation of the document's
+///        allocator. Parsed names, keys and values point into it.
+struct CiniSourceBuffer
+{
+    CiniSourceBuffer *next;
+
+    bool is_mapping;
+    uint_fast32_t length;
+    void *address;
+};
+
+/// @brief Range of the latest source of an incremental parse which
+///        begins with a section header, or the range in front of the
+///        first header, which belongs to the root section.
+struct CiniSourceBlock
+{
+    uint64_t hash;
+    uint_fast32_t offset;
+    uint_fast32_t length;
+    CiniSection *section;
 };
 
 struct CiniDocument
 {
+    /// @brief Counter which is bumped whenever fields may have been
+    ///        added or removed, to invalidate compiled queries.
+    uint_fast32_t generation;
+
     uint_fast32_t num_sections;
     uint_fast32_t num_values;
     CiniSection *first_section;
+    CiniSection *last_section;
     CiniSection *root_section;
 
+    /// @brief Allocator of everything the document owns, which counts
+    ///        the calls and hands them on to the allocator the document
+    ///        was created with. Its userdata is the document itself.
     CiniAllocateFn fn_alloc;
     CiniFreeFn fn_free;
     void *allocator;
 
+    CiniAllocateFn fn_user_alloc;
+    CiniFreeFn fn_user_free;
+    void *user_allocator;
+
+    /// @brief Calls of the user's allocator over the document's whole
+    ///        lifetime, including those of the documents into which it
+    ///        is parsed in parallel. Accessed atomically.
+    uint64_t num_allocations;
+    uint64_t num_frees;
+
+    /// @brief Bytes of the arena which are taken by `sub_sections`
+    ///        arrays and hash indexes that were outgrown and replaced.
+    ///        They are only reclaimed when the document is reset.
+    uint64_t len_abandoned_sub_sections;
+    uint64_t len_abandoned_indexes;
+
     CiniArena *arena;
+    CiniSourceBuffer *source_buffers;
+
+    /// @brief Image of a compiled document which was loaded, or `NULL`.
+    ///        Loaded documents have no section tree; they are read from
+    ///        the image instead.
+    const CiniCompiledHeader *compiled;
+
+    /// @brief All sections but the root in the order of the linear
+    ///        section list, built when a section is accessed by index.
+    CiniSection **section_table;
+    uint_fast32_t len_section_table;
+
+    /// @brief Number of threads across which large sources are parsed.
+    uint_fast32_t num_parse_threads;
+
+    /// @brief Blocks of the source of the latest incremental parse, or
+    ///        `NULL` if the document wasn't parsed incrementally since
+    ///        it was last changed otherwise.
+    CiniSourceBlock *source_blocks;
+    uint_fast32_t num_source_blocks;
+    /// @brief Whether the document was frozen, after which it isn't
+    ///        changed anymore, not even by its getters.
+    bool is_frozen;
+
+    /// @brief `CiniFeature` flags which were enabled.
+    uint_fast32_t features;
+
+    /// @brief Ring of `CINI_LOG_CAPACITY` entries in the arena, which
+    ///        is `NULL` unless logging is enabled, and the number of
+    ///        entries which were logged into it since it was created.
+    CiniLogEntry *log_entries;
+    uint_fast32_t num_logged;
+
+    /// @brief `profiler_state` while `CINI_FEATURE_PROFILING` is enabled,
+    ///        otherwise `NULL`.
+    CiniProfiler *profiler;
+    CiniProfiler profiler_state;
 };
 
+void * cini_call_wrapped_malloc(
+    uint_fast32_t amount,
+    void *userdata
+);
+
+void cini_call_wrapped_free(
+    void *pointer,
+    void *userdata
+);
+
 CiniDocument * cini_malloc_document();
 
 CiniDocument * cini_new_document(
@@ -71,32 +250,74 @@ CiniDocument * cini_new_document(
     void *userdata
 );
 
+/// @brief Create a document whose arena is sized by a configuration,
+///        like one with a large first block for big sources.
+/// @param arena_config
+///        Sizing of the document's arena, or `NULL` for the defaults.
+///        Fields which are zero get their default as well.
+CiniDocument * cini_new_configured_document(
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata,
+    const CiniArenaConfig *arena_config
+);
+
 void cini_free_document(
     CiniDocument *document
 );
 
-/// @todo This isn't implemented (yet)
-void cini_reset_document(
+/// @brief Drop the block table of an incremental parse, because the
+///        document is changed in another way.
+void cini_internal_forget_source_blocks(
     CiniDocument *document
 );
 
-/// @todo This isn't implemented (yet)
-void cini_set_feature(
-    CiniDocument *document,
-    CiniFeature feature,
-    bool value
+/// @brief Empty a document so that it can be parsed into again. The
+///        arena's blocks are kept and rewound, and merged into a single
+///        block sized to the previous usage unless the arena's config
+///        retains them, so that a document which is re-parsed regularly
+///        stops calling its allocator.
+void cini_reset_document(
+    CiniDocument *document
 );
 
-/// @todo This isn't implemented (yet)
-const char * cini_get_log(
+/// @brief Finish everything which the getters would otherwise do on
+///        first use, like decoding values, copying them out of the
+///        source and building full section names, and make the document
+///        read-only. Afterwards, all getters and section topology
+///        functions may be called from any number of threads without
+///        synchronization, once the document was handed to them.
+///        Parsing into a frozen document fails with
+///        `CINI_DOCUMENT_FROZEN`; resetting it thaws it again, which
+///        requires that no other thread still reads it.
+/// @return
+/// `CINI_SUCCESS` or `CINI_INVALID_POINTER`.
+int_fast8_t cini_freeze(
     CiniDocument *document
 );
 
-/// @todo This isn't implemented (yet)
-int_fast32_t cini_get_log_entry(
+/// @brief Choose across how many threads large sources are parsed.
+///        The source is split at section headers which start a line,
+///        so that sources with few sections are still parsed by one
+///        thread. The document's allocator must be thread-safe to use
+///        more than one thread.
+/// @param num_threads
+///        Number of threads including the calling one, or zero for one
+///        per online processor. Documents start out with one.
+void cini_set_parse_threads(
     CiniDocument *document,
-    uint_fast32_t index,
-    uint_fast32_t 
+    uint_fast32_t num_threads
+);
+
+/// @brief Enable or disable an optional feature of a document.
+///        Enabling `CINI_FEATURE_LOG` gives the document an empty log;
+///        disabling it drops the log. Enabling `CINI_FEATURE_PROFILING`
+///        starts a new parse profile, if the library was built with
+///        `CINI_PROFILING`.
+void cini_set_feature(
+    CiniDocument *document,
+    CiniFeature feature,
+    bool value
 );
 
 #endif // CINI_DOCUMENT_H
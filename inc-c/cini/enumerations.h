@@ -12,6 +12,10 @@ typedef enum
     CINI_SECTION_NONEXISTENT,
     CINI_KEY_NONEXISTENT,
     CINI_SYNTAX_ERROR,
+    CINI_INVALID_ENCODING,
+    CINI_TYPE_MISMATCH,
+    CINI_DOCUMENT_FROZEN,
+    CINI_WRITE_FAILURE,
     
     // ==> Internal Errors
 
@@ -26,8 +30,8 @@ typedef enum
 
 typedef enum
 {
-    CINI_FEATURE_CUSTOM_ALLOCATOR = 1,
-    CINI_FEATURE_LOG = 1 << 1
+    CINI_FEATURE_LOG = 1,
+    CINI_FEATURE_PROFILING = 1 << 1
 
 } CiniFeature;
 
@@ -0,0 +1,74 @@
+
+#ifndef CINI_FIELD_H
+#define CINI_FIELD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+
+// Number of fields up to which a section's fields are searched
+// linearly. Beyond it, a hash index is built for the section.
+#define CINI_FIELD_INDEX_THRESHOLD 8
+
+CiniField * cini_internal_find_field(
+    CiniSection *section,
+    const char *key,
+    uint_fast32_t len_key,
+    uint32_t key_hash
+);
+
+/// @brief Add a field to a section or, if the section already has a
+///        field with the same key, replace that field's value. The
+///        last assignment of a key wins, but the field keeps the
+///        position of the key's first occurrence.
+/// @param copy_key
+///        Whether the key must be copied into the arena because it
+///        points into a source the document doesn't own.
+/// @param value
+///        Value, which must already live as long as the document.
+/// @return
+/// The new or the updated field.
+CiniField * cini_internal_add_field(
+    CiniDocument *document,
+    CiniSection *section,
+    const char *key,
+    uint_fast32_t len_key,
+    bool copy_key,
+    const char *value,
+    uint_fast32_t len_value,
+    bool value_terminated
+);
+
+/// @brief Take a field out of its section's field list and index. The
+///        field's memory is only reclaimed when the arena is.
+void cini_internal_remove_field(
+    CiniDocument *document,
+    CiniSection *section,
+    CiniField *field
+);
+
+/// @brief Classify a value and decode it as every type it can be read
+///        as, storing the results in a field's cached decodes.
+void cini_internal_decode_value(
+    const char *value,
+    uint_fast32_t len_value,
+    CiniField *target
+);
+
+/// @brief Get a field's decoded value, decoding it on first access.
+///        The field's cache is filled by exactly one thread; readers
+///        of other fields never contend. A thread which finds the field
+///        being decoded by another one decodes into `scratch` instead.
+/// @param scratch
+///        Field which the caller provides as storage for a local decode.
+/// @return
+/// Either `field` or `scratch`, with `applicable_types`, `boolean`,
+/// `integer` and `decimal` set.
+const CiniField * cini_internal_get_decoded(
+    CiniField *field,
+    CiniField *scratch
+);
+
+#endif // CINI_FIELD_H
+
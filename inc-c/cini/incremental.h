@@ -0,0 +1,55 @@
+
+#ifndef CINI_INCREMENTAL_H
+#define CINI_INCREMENTAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+
+typedef enum
+{
+    CINI_SECTION_ADDED = 1,
+    CINI_SECTION_MODIFIED,
+    CINI_SECTION_REMOVED
+
+} CiniSectionChange;
+
+/// @brief Called for every section whose fields changed in a re-parse.
+/// @param section
+///        Full name of the section, which is empty for the root section.
+typedef void (*CiniChangeFn)(
+    const char *section,
+    CiniSectionChange change,
+    void *userdata
+);
+
+/// @brief Bring a document up to date with a new version of its source,
+///        re-parsing only the sections whose content changed. The source
+///        is split into blocks at every section header, and each block
+///        is hashed. A section is re-parsed if its sequence of block
+///        hashes differs from the previous source's; all other sections
+///        keep their fields. Everything is copied out of the source;
+///        the memory of replaced fields is only reused once the
+///        document is reset.
+///        The first re-parse of a document parses every section, as the
+///        document has no block hashes yet; it reports a section which
+///        still exists as modified only if it has fields before or
+///        after.
+/// @param fn_change
+///        Function which is called for every added, modified or removed
+///        section after the document was updated, or `NULL`.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error. On error, the
+/// document is parsed from the new source as a whole, like a document
+/// which was reset, and no changes are reported.
+int_fast8_t cini_reparse_source(
+    CiniDocument *document,
+    const char *source,
+    uint_fast32_t len_source,
+    CiniChangeFn fn_change,
+    void *userdata
+);
+
+#endif // CINI_INCREMENTAL_H
+
@@ -0,0 +1,82 @@
+
+#ifndef CINI_LOG_H
+#define CINI_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+
+// Number of entries a document's log holds; older ones are overwritten.
+#define CINI_LOG_CAPACITY 64
+
+typedef enum
+{
+    CINI_LOG_INVALID_UTF8 = 1,
+    CINI_LOG_QUOTED_SECTION_NAME,
+    CINI_LOG_EMPTY_PATH_LINK,
+    CINI_LOG_EMPTY_SECTION_HEADER,
+    CINI_LOG_SECTION_PATH_TOO_DEEP,
+    CINI_LOG_UNCLOSED_SECTION_HEADER,
+    CINI_LOG_CHARACTERS_AFTER_HEADER,
+    CINI_LOG_MISSING_EQUALS_SIGN,
+    CINI_LOG_QUOTED_KEY,
+    CINI_LOG_MISSING_KEY,
+    CINI_LOG_KEY_TOO_LONG,
+    CINI_LOG_UNCLOSED_QUOTED_VALUE,
+    CINI_LOG_CHARACTERS_AFTER_VALUE
+
+} CiniLogMessage;
+
+/// @brief Problem which was found while parsing. Lines and columns
+///        count from one; columns are counted in bytes.
+struct CiniLogEntry
+{
+    CiniStatus status;
+    CiniLogMessage message;
+    uint64_t offset;
+    uint32_t line;
+    uint32_t column;
+
+    /// @brief Static, human-readable description of the message.
+    const char *text;
+};
+
+/// @brief Give a document an empty log in its arena.
+void cini_internal_create_log(
+    CiniDocument *document
+);
+
+/// @brief Add an entry to a document's log, overwriting the oldest one
+///        if the log is full. The entry's text is filled in.
+void cini_internal_append_log(
+    CiniDocument *document,
+    CiniLogEntry *entry
+);
+
+/// @return
+/// Description of the latest entry of a document's log, or `NULL` if
+/// the log is empty or logging isn't enabled.
+const char * cini_get_log(
+    CiniDocument *document
+);
+
+/// @brief Read an entry of a document's log. The log is filled while
+///        `CINI_FEATURE_LOG` is enabled and emptied when the document is
+///        reset.
+/// @param index
+///        Index of the entry, with zero for the oldest one which the log
+///        still holds.
+/// @param entry
+///        Pointer to where to put the entry, which is only written if
+///        there is an entry at `index`. May be `NULL`.
+/// @return
+/// Number of entries in the log, or `CINI_INVALID_POINTER`.
+int_fast32_t cini_get_log_entry(
+    CiniDocument *document,
+    uint_fast32_t index,
+    CiniLogEntry *entry
+);
+
+#endif // CINI_LOG_H
+
@@ -0,0 +1,62 @@
+
+#ifndef CINI_MUTATION_H
+#define CINI_MUTATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+
+// Room for the decimal digits of any `int64_t`, its sign and a zero.
+#define CINI_MAX_INTEGER_TEXT 21
+
+/// @brief Set a value, creating its section and key if they don't exist
+///        yet. An existing key keeps its position; if its value is a
+///        copy of the document's own which is long enough, the text is
+///        written over it, otherwise the text is copied into the arena.
+///        Replaced values are only reclaimed when the document is reset.
+///        Pointers which getters returned for the previous value may
+///        show the new one or stay unchanged.
+/// @param query
+///        `<section>:<key>` value to set. Keys of the root section may be
+///        given without a section.
+/// @return
+/// `CINI_SUCCESS`, `CINI_DOCUMENT_FROZEN` for frozen and loaded compiled
+/// documents, or `CINI_SYNTAX_ERROR` if the section path is malformed or
+/// the key or a new section's name couldn't be written as INI text, like
+/// names which contain `[`, `]`, `=`, `;`, `#`, `"`, `:` or line breaks.
+int_fast8_t cini_set_text(
+    CiniDocument *document,
+    const char *query,
+    const char *text
+);
+
+/// @brief Set an integer value, which is stored in decimal and read back
+///        without being decoded again.
+/// @return
+/// See `cini_set_text`.
+int_fast8_t cini_set_int(
+    CiniDocument *document,
+    const char *query,
+    int64_t value
+);
+
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT`, `CINI_KEY_NONEXISTENT` or
+/// `CINI_DOCUMENT_FROZEN`.
+int_fast8_t cini_remove_key(
+    CiniDocument *document,
+    const char *query
+);
+
+/// @brief Remove a section with all of its keys and sub-sections. The
+///        root section can't be removed; its keys can.
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT` or `CINI_DOCUMENT_FROZEN`.
+int_fast8_t cini_remove_section(
+    CiniDocument *document,
+    const char *section
+);
+
+#endif // CINI_MUTATION_H
+
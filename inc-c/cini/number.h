@@ -0,0 +1,34 @@
+
+#ifndef CINI_NUMBER_H
+#define CINI_NUMBER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// @brief Decode an integer without needing a terminating zero.
+///        Accepts an optional sign followed by decimal digits or by
+///        `0x`, `0o` or `0b` and hexadecimal, octal or binary digits.
+///        A single `_` may separate two digits.
+/// @return
+/// Whether the whole value is an integer which fits into 64 bits.
+bool cini_decode_integer(
+    const char *value,
+    uint_fast32_t len_value,
+    int64_t *buffer
+);
+
+/// @brief Decode a floating point number without needing a terminating
+///        zero, independently of the locale. Accepts everything which
+///        `cini_decode_integer` accepts, decimal fractions with an
+///        optional exponent, `inf` and `nan`. The result is correctly
+///        rounded.
+/// @return
+/// Whether the whole value is a number in the range of a double.
+bool cini_decode_decimal(
+    const char *value,
+    uint_fast32_t len_value,
+    double *buffer
+);
+
+#endif // CINI_NUMBER_H
+
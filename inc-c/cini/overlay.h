@@ -0,0 +1,127 @@
+
+#ifndef CINI_OVERLAY_H
+#define CINI_OVERLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+
+// Number of slots with which an overlay's query cache starts. It is
+// kept at most half full and doubled when it would get fuller.
+#define CINI_OVERLAY_CACHE_CAPACITY 16
+
+typedef struct CiniOverlay CiniOverlay;
+typedef struct CiniOverlayEntry CiniOverlayEntry;
+
+/// @brief Cached resolution of a `<section>:<key>` query through all of
+///        an overlay's layers.
+struct CiniOverlayEntry
+{
+    uint32_t hash;
+
+    /// @brief Index of the layer whose field won, or -1 if no layer has
+    ///        the field; `status` holds the reason then.
+    int_fast32_t layer;
+    CiniField *field;
+    CiniStatus status;
+
+    /// @brief Field of a loaded compiled document, exposed as a regular
+    ///        one; `field` points to it then.
+    CiniField exposed_field;
+
+    uint_fast32_t len_query;
+    char query[];
+};
+
+/// @brief Stack of documents which are read as one, like defaults which
+///        are overridden by more specific files. The layers aren't
+///        copied; they must outlive the overlay.
+struct CiniOverlay
+{
+    /// @brief Layers from the lowest to the highest precedence.
+    uint_fast32_t num_layers;
+    CiniDocument **layers;
+
+    /// @brief Generations of the layers when the cache was last valid.
+    ///        If any layer's generation differs, the cache is emptied.
+    uint_fast32_t *generations;
+
+    uint_fast32_t cache_capacity;
+    uint_fast32_t num_cached;
+    CiniOverlayEntry **cache;
+};
+
+/// @brief Create a view which stacks documents. A value is read from
+///        the last layer which has it; the layers' own indexes are used
+///        to find it, and the winning layer is cached per query.
+///        The view isn't thread-safe, as lookups fill its cache.
+/// @param layers
+///        Array of `num_layers` documents, from the lowest to the
+///        highest precedence. Only the array is copied.
+/// @return
+/// The overlay, or `NULL` on error.
+CiniOverlay * cini_new_overlay(
+    CiniDocument *const *layers,
+    uint_fast32_t num_layers
+);
+
+void cini_free_overlay(
+    CiniOverlay *overlay
+);
+
+/// @brief Find the layer from which a value is read.
+/// @return
+/// Index of the layer, `CINI_SECTION_NONEXISTENT` if no layer has the
+/// section, or `CINI_KEY_NONEXISTENT` if no layer has the key.
+int_fast32_t cini_get_overlay_layer(
+    CiniOverlay *overlay,
+    const char *query
+);
+
+int_fast8_t cini_get_overlay_bool(
+    CiniOverlay *overlay,
+    const char *query,
+    bool *buffer
+);
+
+int_fast8_t cini_get_overlay_int(
+    CiniOverlay *overlay,
+    const char *query,
+    int64_t *buffer
+);
+
+int_fast8_t cini_get_overlay_decimal(
+    CiniOverlay *overlay,
+    const char *query,
+    double *buffer
+);
+
+/// @return
+/// Zero-terminated text owned by the winning layer, or `NULL` if no
+/// layer has the value.
+const char * cini_get_overlay_text(
+    CiniOverlay *overlay,
+    const char *query
+);
+
+/// @brief Merge all layers into a new document in one pass over each
+///        of them, from the lowest layer to the highest. Every key ends
+///        up with the value of the highest layer which has it, while
+///        sections and keys keep the position of their first occurrence.
+///        Everything is copied, so the layers may be freed afterwards.
+/// @param fn_alloc
+///        Allocator of the new document, which is created by
+///        `cini_new_document` with `fn_free` and `userdata`.
+/// @return
+/// The document, which must be freed with `cini_free_document`, or
+/// `NULL` on allocation failure.
+CiniDocument * cini_flatten_overlay(
+    CiniOverlay *overlay,
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata
+);
+
+#endif // CINI_OVERLAY_H
+
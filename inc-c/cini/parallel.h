@@ -0,0 +1,79 @@
+
+#ifndef CINI_PARALLEL_H
+#define CINI_PARALLEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+#include <cini/utility.h>
+
+// Smallest part of a source which is worth a thread of its own. Sources
+// which can't be split into at least two such chunks are parsed serially.
+#define CINI_PARALLEL_MIN_CHUNK (256 * 1024)
+
+/// @brief Settings for parsing many files at once. Fields which are zero
+///        get their default.
+typedef struct
+{
+    /// @brief Number of threads including the calling one, or zero for
+    ///        one per online processor.
+    uint32_t num_threads;
+
+    /// @brief Allocator of all documents, which must be thread-safe,
+    ///        or `NULL` for `malloc()` and `free()`.
+    CiniAllocateFn fn_alloc;
+    CiniFreeFn fn_free;
+    void *allocator;
+
+    /// @brief Sizing of the documents' arenas, or `NULL`.
+    const CiniArenaConfig *arena_config;
+
+} CiniBatchOptions;
+
+/// @brief Split a source at section headers which start a line and parse
+///        the chunks on the document's number of threads, each into a
+///        document of its own. The chunks' sections and fields are then
+///        merged into the document in source order, which gives the
+///        same document as parsing the source serially. If any chunk
+///        fails, the source is parsed serially instead, so that the
+///        document holds exactly what was parsed before the error.
+/// @param borrow_source
+///        Whether the source outlives the document, so that names, keys
+///        and values may point into it instead of being copied.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_internal_parse_in_parallel(
+    CiniDocument *document,
+    const char *source,
+    uint_fast32_t len_source,
+    bool borrow_source
+);
+
+/// @brief Parse many files, each into a document of its own, on a pool
+///        of threads. Every thread opens its next file and asks the
+///        kernel to read it ahead before parsing its current one, so
+///        reading and parsing overlap.
+/// @param documents
+///        Array of `count` pointers which are set to the documents, or to
+///        `NULL` if a document couldn't be allocated. Documents of files
+///        which failed hold what was parsed before the error; all of
+///        them must be freed with `cini_free_document`.
+/// @param statuses
+///        Array of `count` statuses which are set to the status of each
+///        file, or `NULL`.
+/// @param options
+///        Settings of the batch, or `NULL` for the defaults.
+/// @return
+/// `CINI_SUCCESS` if every file was parsed, otherwise the negative
+/// `CiniStatus` of the first file, in the order of `paths`, which failed.
+int_fast8_t cini_parse_many(
+    const char *const *paths,
+    uint_fast32_t count,
+    CiniDocument **documents,
+    int_fast8_t *statuses,
+    const CiniBatchOptions *options
+);
+
+#endif // CINI_PARALLEL_H
+
@@ -2,11 +2,55 @@
 #ifndef CINI_PARSER_H
 #define CINI_PARSER_H
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 
 #include <cini/enumerations.h>
 #include <cini/document.h>
+#include <cini/utility.h>
+
+// Size of the chunks in which descriptors and file pointers which
+// can't be mapped are read and streamed into the parser.
+#define CINI_STREAM_CHUNK_SIZE 65536
+
+// Deepest section path which is reported to a handler.
+#define CINI_MAX_HANDLER_LEVELS 64
+
+typedef struct CiniParser CiniParser;
+
+/// @brief Called for every section header.
+/// @param path
+///        Levels of the section's name, which are views into the source.
+///        The array is only valid during the call.
+/// @return
+/// Whether to continue parsing.
+typedef bool (*CiniSectionFn)(
+    const CiniSlice *path,
+    uint_fast32_t num_levels,
+    void *userdata
+);
+
+/// @brief Called for every field, in the section of the latest header.
+/// @param is_escaped
+///        Whether the value contains escape sequences, which can be
+///        resolved with `cini_unescape_text`.
+/// @return
+/// Whether to continue parsing.
+typedef bool (*CiniFieldFn)(
+    const CiniSlice *key,
+    const CiniSlice *value,
+    bool is_escaped,
+    void *userdata
+);
+
+typedef struct
+{
+    CiniSectionFn fn_section;
+    CiniFieldFn fn_field;
+    void *userdata;
+
+} CiniHandler;
 
 int_fast8_t cini_parse_source(
     CiniDocument *buffer,
@@ -29,5 +73,101 @@ int_fast8_t cini_parse_file_pointer(
     FILE *pointer
 );
 
+/// @brief Parse a file descriptor's content into a document.
+///        Regular files are memory-mapped and the document keeps the
+///        mapping until it is freed; the parsed names, keys and values
+///        point into it instead of being copied. Other descriptors,
+///        like pipes, are read to their end first.
+/// @param buffer
+///        Document into which to parse the file.
+/// @param fd
+///        Readable file descriptor, which may be closed afterwards.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_parse_fd(
+    CiniDocument *buffer,
+    int fd
+);
+
+/// @brief Begin parsing a source which arrives in chunks, like from a
+///        pipe or a socket, into a document. Lines, section headers,
+///        fields and UTF-8 sequences may be cut at any chunk boundary;
+///        only the incomplete last line of a chunk is kept until the
+///        next one arrives.
+/// @return
+/// A parser which must be finished with `cini_parser_end`, or `NULL`
+/// on error.
+CiniParser * cini_parser_begin(
+    CiniDocument *document
+);
+
+/// @brief Parse the next chunk of a streamed source. The chunk is
+///        copied where needed and may be reused afterwards.
+/// @return
+/// `CINI_SUCCESS` or the negative `CiniStatus` of the first error, which
+/// every later call returns as well.
+int_fast8_t cini_parser_feed(
+    CiniParser *parser,
+    const char *chunk,
+    uint_fast32_t len_chunk
+);
+
+/// @brief Parse the last, unterminated line of a streamed source and
+///        free the parser.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_parser_end(
+    CiniParser *parser
+);
+
+/// @brief Parse a source without building a document, reporting its
+///        sections and fields to a handler instead. Nothing is
+///        allocated; keys and values are views into the source. As the
+///        source is validated in windows, events may be reported before
+///        an encoding error further on is found.
+/// @return
+/// `CINI_SUCCESS`, also if the handler stopped parsing, or a negative
+/// `CiniStatus` on error.
+int_fast8_t cini_parse_with_handler(
+    const CiniHandler *handler,
+    const char *source,
+    uint_fast32_t len_source
+);
+
+/// @brief Hand a buffer or mapping, which is released together with
+///        the document, over to a document.
+void cini_internal_register_source_buffer(
+    CiniDocument *document,
+    void *address,
+    uint_fast32_t length,
+    bool is_mapping
+);
+
+/// @brief Parse a source into a document on the calling thread.
+/// @param borrow_source
+///        Whether the source outlives the document, so that names, keys
+///        and values may point into it instead of being copied.
+int_fast8_t cini_internal_parse_serially(
+    CiniDocument *document,
+    const char *source,
+    uint_fast32_t len_source,
+    bool borrow_source
+);
+
+/// @brief Parse a single section header line, creating the section if
+///        it doesn't exist yet.
+/// @return
+/// The section, or the root section if the line is no header.
+CiniSection * cini_internal_parse_header_line(
+    CiniDocument *document,
+    const char *line,
+    uint_fast32_t len_line,
+    int_fast8_t *status
+);
+
+void cini_internal_free_parser(
+    CiniParser *parser
+);
+
 #endif // CINI_PARSER_H
 
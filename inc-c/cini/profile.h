@@ -0,0 +1,133 @@
+
+#ifndef CINI_PROFILE_H
+#define CINI_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The instrumentation is only compiled in if `CINI_PROFILING` is defined,
+// like with `BUILD_OPTIONS=-DCINI_PROFILING ./do.sh`. Otherwise, the macros
+// below do nothing and `CINI_FEATURE_PROFILING` has no effect.
+
+typedef struct CiniProfiler CiniProfiler;
+
+/// @brief Time spent in the phases of parsing and the events counted in
+///        them, summed over all threads which parsed. Each phase's time
+///        excludes that of the phases nested in it, like scanning which
+///        happens while a field is parsed.
+typedef struct
+{
+    /// @brief Time spent in every phase together.
+    uint64_t total_ns;
+
+    /// @brief Classifying and validating windows of the source.
+    uint64_t scan_ns;
+    /// @brief Splitting section headers into the links of their path.
+    uint64_t split_ns;
+    /// @brief Finding and creating the sections of headers.
+    uint64_t section_ns;
+    /// @brief Parsing fields and adding them to their section.
+    uint64_t field_ns;
+    /// @brief Continuing the arena in another block.
+    uint64_t arena_ns;
+    /// @brief Everything else, like skipping comments and empty lines.
+    uint64_t other_ns;
+
+    uint64_t num_windows;
+    uint64_t num_runes;
+    uint64_t num_headers;
+    uint64_t num_fields;
+    uint64_t num_sub_section_probes;
+    uint64_t num_arena_continuations;
+
+} CiniParseProfile;
+
+/// @brief Totals of a document's profile, and the time of all phases
+///        which ended so far, from which nested phases are subtracted.
+struct CiniProfiler
+{
+    CiniParseProfile totals;
+    uint64_t timed_ns;
+};
+
+typedef struct
+{
+    uint64_t start_ns;
+    uint64_t timed_ns;
+
+} CiniPhaseTimer;
+
+uint64_t cini_internal_read_profile_clock();
+
+void cini_internal_begin_phase(
+    CiniProfiler *profiler,
+    CiniPhaseTimer *timer
+);
+
+/// @brief Add the time since a phase began to its total, without the
+///        time of the phases which ended in between.
+void cini_internal_end_phase(
+    CiniProfiler *profiler,
+    CiniPhaseTimer *timer,
+    uint64_t *phase_ns
+);
+
+/// @brief Count the runes of a UTF-8 text, which may begin or end
+///        within one, by their leading bytes.
+uint64_t cini_internal_count_runes(
+    const char *text,
+    uint_fast32_t len_text
+);
+
+#ifdef CINI_PROFILING
+
+#define CINI_PROFILE_COUNT(profiler, counter, amount) \
+    do \
+    { \
+        if (profiler) \
+        { \
+            (profiler)->totals.counter += (amount); \
+        } \
+    } while (0)
+
+#define CINI_PROFILE_BEGIN(profiler, timer) \
+    CiniPhaseTimer timer = {0, 0}; \
+    if (profiler) \
+    { \
+        cini_internal_begin_phase((profiler), &timer); \
+    }
+
+#define CINI_PROFILE_END(profiler, timer, phase) \
+    do \
+    { \
+        if (profiler) \
+        { \
+            cini_internal_end_phase( \
+                (profiler), \
+                &timer, \
+                &(profiler)->totals.phase \
+            ); \
+        } \
+    } while (0)
+
+#else
+
+// Counting and ending still take the place of a statement, and the
+// profiler is still referenced, so that it isn't an unused parameter.
+
+#define CINI_PROFILE_COUNT(profiler, counter, amount) \
+    do \
+    { \
+        (void) (profiler); \
+    } while (0)
+#define CINI_PROFILE_BEGIN(profiler, timer)
+#define CINI_PROFILE_END(profiler, timer, phase) \
+    do \
+    { \
+        (void) (profiler); \
+    } while (0)
+
+#endif // CINI_PROFILING
+
+#endif // CINI_PROFILE_H
+
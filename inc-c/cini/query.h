@@ -0,0 +1,255 @@
+
+#ifndef CINI_QUERY_H
+#define CINI_QUERY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+
+typedef struct CiniQuery CiniQuery;
+
+/// @brief Make sure that the document's section table lists all of its
+///        sections, so that they can be accessed by index.
+void cini_internal_update_section_table(
+    CiniDocument *document
+);
+
+/// @brief Find the field which a `<section>:<key>` query refers to.
+/// @param section
+///        Pointer to where to put the resolved section, or `NULL`.
+/// @param status
+///        Pointer to where to put `CINI_SECTION_NONEXISTENT` or
+///        `CINI_KEY_NONEXISTENT` if the field wasn't found.
+/// @param scratch
+///        Field into which a field of a loaded compiled document is
+///        exposed.
+/// @return
+/// The field or `NULL` if it doesn't exist.
+CiniField * cini_internal_resolve_query(
+    CiniDocument *document,
+    const char *query,
+    uint_fast32_t len_query,
+    CiniSection **section,
+    CiniStatus *status,
+    CiniField *scratch
+);
+
+int_fast8_t cini_internal_read_bool(
+    CiniField *field,
+    bool *buffer
+);
+
+int_fast8_t cini_internal_read_int(
+    CiniField *field,
+    int64_t *buffer
+);
+
+int_fast8_t cini_internal_read_decimal(
+    CiniField *field,
+    double *buffer
+);
+
+/// @brief Get a field's value as a zero-terminated string, copying it
+///        out of the source the first time.
+const char * cini_internal_read_text(
+    CiniDocument *document,
+    CiniField *field
+);
+
+/// @brief Get number of sections within a document or number of
+///        sub-sections within another section. Unless the document
+///        is frozen, this builds its section table on first use, so
+///        concurrent calls need external synchronization; see
+///        `cini_freeze`.
+/// @param document
+///        Document of which to get the number of sections.
+/// @param super_section
+///        Superordinate section of which to get the number of
+///        sub-sections or `NULL` to get the total number of sections.
+/// @return
+/// Section count or `CINI_SECTION_NONEXISTENT` if the `super_section`
+/// could not be found.
+int_fast32_t cini_get_section_count(
+    CiniDocument *document,
+    const char *super_section
+);
+
+/// @brief Get name of section at an index in the list of documents,
+///        possibly within a `super_section`. Unless the document is
+///        frozen, this builds its section table and the full name on
+///        first use, so concurrent calls need external
+///        synchronization; see `cini_freeze`.
+/// @param document
+///        Document of which to get an entry of the section list.
+/// @param super_section
+///        Superordinate section of which to get the section at an
+///        index or `NULL` to access the document's sections linearly.
+/// @param index
+///        Index of the section.
+/// @return 
+/// A string that contains the full name of the section (with all
+/// superordinate parts). Changing this isn't recommended.
+const char * cini_get_section_name(
+    CiniDocument *document,
+    const char *super_section,
+    uint_fast32_t index
+);
+
+
+// ==> Value Gathering
+
+/// @brief Get a boolean value. `true`, `yes`, `on` and `1` are true,
+///        `false`, `no`, `off` and `0` are false, ignoring case.
+/// @param query
+///        `<section>:<key>` value to search in the document. Keys of
+///        the root section may be queried without a section.
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT`, `CINI_KEY_NONEXISTENT`
+/// or `CINI_TYPE_MISMATCH` if the value isn't a boolean.
+int_fast8_t cini_get_bool(
+    CiniDocument *document,
+    const char *query,
+    bool *buffer
+);
+
+/// @brief Get a signed 64-bit integer value. It may have a `+` or `-`
+///        sign and a `0x`, `0o` or `0b` prefix for hexadecimal, octal
+///        or binary digits, in either case. Single underscores may
+///        separate digits, like in `1_000_000` or `0xFF_FF`. Values
+///        which don't fit into an `int64_t` are rejected, not clamped.
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT`, `CINI_KEY_NONEXISTENT`
+/// or `CINI_TYPE_MISMATCH` if the value isn't an integer in range.
+int_fast8_t cini_get_int(
+    CiniDocument *document,
+    const char *query,
+    int64_t *buffer
+);
+
+/// @brief Get a floating point value. It may have a `+` or `-` sign,
+///        a fraction after a `.` and an exponent after `e` or `E`, like
+///        `-1.5e-3`, and single underscores between decimal digits.
+///        `inf`, `infinity` and `nan` are accepted in any case, and
+///        integers with a `0x`, `0o` or `0b` prefix are converted.
+///        Finite values which overflow a `double` are rejected; tiny
+///        ones round towards zero.
+/// @return
+/// `CINI_SUCCESS`, `CINI_SECTION_NONEXISTENT`, `CINI_KEY_NONEXISTENT`
+/// or `CINI_TYPE_MISMATCH` if the value isn't a number.
+int_fast8_t cini_get_decimal(
+    CiniDocument *document,
+    const char *query,
+    double *buffer
+);
+
+/// @brief Get a text value. If a key is assigned more than once within
+///        a section, the last assignment wins. Unless the document is
+///        frozen, values which aren't zero-terminated in the source
+///        are copied into the document on first use, so concurrent
+///        calls need external synchronization; see `cini_freeze`.
+/// @return
+/// Zero-terminated text owned by the document, or `NULL` if the value
+/// doesn't exist.
+const char * cini_get_text(
+    CiniDocument *document,
+    const char *query
+);
+
+/// @brief Get the types as which a value can be read, as a bitmask of
+///        `CiniValueType`s. Every value can be read as a string.
+/// @return
+/// The bitmask, `CINI_SECTION_NONEXISTENT` or `CINI_KEY_NONEXISTENT`.
+int_fast32_t cini_get_value_types(
+    CiniDocument *document,
+    const char *query
+);
+
+/// @brief Duplicate a text value from an INI-document into a buffer.
+/// @param document
+///        Document supposed to contain the value.
+/// @param query
+///        `<section>:<key>` value to search in the document.
+/// @param buffer
+///        Buffer into which to write the text, or NULL for getting
+///        the stored text's length.
+/// @param len_buffer
+///        Length of `buffer`, or -1 to ignore
+/// @return
+/// One of three possible states:  
+/// 
+/// - Negative on error  
+/// 
+/// - Zero on success  
+/// 
+/// - Stored text's length on success if `buffer` is NULL  
+///
+int_fast32_t cini_write_text(
+    CiniDocument *document,
+    const char *query,
+    char *buffer,
+    int_fast32_t len_buffer
+);
+
+
+// ==> Compiled Queries
+
+/// @brief Resolved `<section>:<key>` query which can be used repeatedly
+///        without splitting and searching the query string again.
+///        The document's generation is bumped by every parse and reset;
+///        a handle whose generation differs resolves itself again on
+///        its next use, so it never refers to a stale field.
+struct CiniQuery
+{
+    CiniDocument *document;
+    uint_fast32_t generation;
+
+    CiniSection *section;
+    CiniField *field;
+    CiniStatus status;
+
+    /// @brief Field of a loaded compiled document, exposed as a regular
+    ///        one; `field` points to it then.
+    CiniField exposed_field;
+
+    uint_fast32_t len_query;
+    char query[];
+};
+
+/// @brief Compile a `<section>:<key>` query into a handle for repeated
+///        lookups of the same value. The handle stays valid when the
+///        document is reset or more sources are parsed into it; it is
+///        resolved again on its next use then.
+/// @return
+/// The handle, which must be freed with `cini_free_query` before the
+/// document is freed, or `NULL` on error.
+CiniQuery * cini_compile_query(
+    CiniDocument *document,
+    const char *query
+);
+
+void cini_free_query(
+    CiniQuery *query
+);
+
+int_fast8_t cini_get_bool_q(
+    CiniQuery *query,
+    bool *buffer
+);
+
+int_fast8_t cini_get_int_q(
+    CiniQuery *query,
+    int64_t *buffer
+);
+
+int_fast8_t cini_get_decimal_q(
+    CiniQuery *query,
+    double *buffer
+);
+
+const char * cini_get_text_q(
+    CiniQuery *query
+);
+
+#endif // CINI_QUERY_H
+
@@ -0,0 +1,106 @@
+
+#ifndef CINI_SCANNER_H
+#define CINI_SCANNER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/enumerations.h>
+#include <cini/profile.h>
+
+// Number of source bytes which are classified at once. The bitmap of
+// one window is small enough to stay in the L1 cache while the parser
+// walks it and doesn't need any heap memory.
+#define CINI_STRUCTURAL_WINDOW 4096
+
+typedef struct CiniStructuralIndex CiniStructuralIndex;
+
+/// @brief Classify the structural bytes of one window into a bitmap.
+/// @return
+/// Whether the window contains any byte outside of the ASCII range.
+typedef bool (*CiniClassifyFn)(
+    const char *bytes,
+    uint_fast32_t len_bytes,
+    uint64_t *bits
+);
+
+/// @brief Validate the UTF-8 encoding of a range of a source.
+/// @param offset
+///        Offset of the first byte to validate, which must be the start
+///        of a rune. It is moved behind the last validated rune, which
+///        may end after `end`, or to the first invalid byte.
+/// @return
+/// Whether the range is valid UTF-8.
+typedef bool (*CiniValidateFn)(
+    const char *source,
+    uint_fast32_t len_source,
+    uint_fast32_t *offset,
+    uint_fast32_t end
+);
+
+/// @brief Bitmap of the structural bytes of a source, that is every
+///        `[`, `]`, `=`, `\n`, `\r`, `;`, `#`, `"` and `\`.
+///        The bitmap is built one window at a time, while the parser
+///        walks forward through the source. Every window is validated
+///        as UTF-8 before it is handed out, so the parser itself can
+///        work on plain bytes. Windows without any non-ASCII byte skip
+///        the validation, which is known from the classification.
+struct CiniStructuralIndex
+{
+    const char *source;
+    uint_fast32_t len_source;
+
+    CiniClassifyFn fn_classify;
+    CiniValidateFn fn_validate;
+
+    /// @brief Offset up to which the source is known to be valid UTF-8.
+    uint_fast32_t validated_until;
+
+    /// @brief `CINI_INVALID_ENCODING` once an invalid byte was found.
+    ///        The index then pretends that the source ends right
+    ///        before that byte.
+    CiniStatus status;
+    uint_fast32_t invalid_offset;
+
+    uint_fast32_t window_start;
+    uint_fast32_t window_end;
+    uint64_t bits[CINI_STRUCTURAL_WINDOW / 64];
+
+    /// @brief Profiler of the parse, or `NULL`.
+    CiniProfiler *profiler;
+};
+
+void cini_init_structural_index(
+    CiniStructuralIndex *index,
+    const char *source,
+    uint_fast32_t len_source
+);
+
+/// @brief Find the next structural byte at or after an offset.
+/// @param index
+///        Index of the source in which to search.
+/// @param offset
+///        Offset into the source at which to start searching.
+/// @return
+/// Offset of the next structural byte or the source's length if there
+/// is no structural byte left.
+uint_fast32_t cini_next_structural(
+    CiniStructuralIndex *index,
+    uint_fast32_t offset
+);
+
+/// @brief Validate a complete buffer as UTF-8 using the fastest
+///        validator supported by the CPU.
+/// @param invalid_offset
+///        Pointer to where to put the offset of the first invalid byte,
+///        or `NULL`.
+/// @return
+/// `CINI_SUCCESS` or `CINI_INVALID_ENCODING`.
+CiniStatus cini_validate_utf8(
+    const char *source,
+    uint_fast32_t len_source,
+    uint_fast32_t *invalid_offset
+);
+
+#endif // CINI_SCANNER_H
+
@@ -0,0 +1,88 @@
+
+#ifndef CINI_SECTION_H
+#define CINI_SECTION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+#include <cini/utility.h>
+
+// Number of sub-sections up to which a section's sub-sections are
+// searched linearly. Beyond it, a hash index is built for the section.
+#define CINI_SUB_SECTION_INDEX_THRESHOLD 8
+
+CiniSection * cini_internal_find_sub_section(
+    CiniDocument *document,
+    CiniSection *section,
+    const char *sub_section_name,
+    uint_fast32_t len_sub_section_name,
+    uint32_t sub_section_hash
+);
+
+CiniSection * cini_internal_find_section(
+    CiniDocument *document,
+    const CiniSlice *path,
+    uint_fast32_t num_levels
+);
+
+CiniSection * cini_internal_add_sub_section(
+    CiniDocument *document,
+    CiniSection *section,
+    const char *name,
+    uint_fast32_t len_name,
+    uint32_t name_hash
+);
+
+CiniSection * cini_internal_force_create_section(
+    CiniDocument *document,
+    const CiniSlice *path,
+    uint_fast32_t num_levels,
+    bool copy_names
+);
+
+CiniSection * cini_internal_find_or_create_section(
+    CiniDocument *document,
+    const CiniSlice *path,
+    uint_fast32_t num_levels,
+    bool copy_names
+);
+
+/// @brief Rebuild a section's sub-section index within its current
+///        slots, after sub-sections were taken out of it.
+void cini_internal_refill_sub_section_index(
+    CiniSection *section
+);
+
+/// @brief Take a section and all of its sub-sections out of the section
+///        tree and the linear section list. Their memory is only
+///        reclaimed when the arena is.
+void cini_internal_remove_section(
+    CiniDocument *document,
+    CiniSection *section
+);
+
+/// @brief Find a section by a path string like `a.b.c`.
+/// @param document
+///        Document in which to search.
+/// @param path
+///        Path of the section. An empty path names the root section.
+/// @param len_path
+///        Length of `path` in bytes.
+/// @return
+/// The section or `NULL` if it doesn't exist or the path is malformed.
+CiniSection * cini_internal_resolve_section(
+    CiniDocument *document,
+    const char *path,
+    uint_fast32_t len_path
+);
+
+/// @brief Get the zero-terminated name of a section with all of its
+///        superordinate parts, building it on first use.
+const char * cini_internal_get_full_name(
+    CiniDocument *document,
+    CiniSection *section
+);
+
+#endif // CINI_SECTION_H
+
@@ -0,0 +1,74 @@
+
+#ifndef CINI_STATS_H
+#define CINI_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+
+/// @brief Breakdown of a document's memory, for sizing the memory of a
+///        process which holds documents and for finding the ones which
+///        take up more than their text would suggest.
+typedef struct
+{
+    /// @brief Blocks of the document's arena, the bytes of data which
+    ///        they reserve and the bytes of those which are taken up.
+    uint64_t num_arena_blocks;
+    uint64_t arena_bytes_reserved;
+    uint64_t arena_bytes_used;
+
+    /// @brief Bytes of the used ones which are held by `sub_sections`
+    ///        arrays and hash indexes that were outgrown and replaced.
+    uint64_t abandoned_sub_section_bytes;
+    uint64_t abandoned_index_bytes;
+
+    /// @brief Bytes of sources which the document copied, and of files
+    ///        which it mapped, such as a loaded compiled document.
+    uint64_t source_copy_bytes;
+    uint64_t source_mapping_bytes;
+
+    /// @brief Sections without the root section, and fields.
+    uint64_t num_sections;
+    uint64_t num_fields;
+
+    /// @brief Section names, full names which were built, keys and
+    ///        values, and their length without terminators.
+    uint64_t num_strings;
+    uint64_t string_bytes;
+
+    /// @brief Calls of the document's allocator since it was created,
+    ///        including the one which allocated the document itself.
+    uint64_t num_allocations;
+    uint64_t num_frees;
+
+} CiniMemoryStats;
+
+/// @brief Measure a document's memory. This walks all of its sections
+///        and fields, so it shouldn't be called on a hot path.
+/// @return
+/// `CINI_SUCCESS` or `CINI_INVALID_POINTER`.
+int_fast8_t cini_get_memory_stats(
+    CiniDocument *document,
+    CiniMemoryStats *stats
+);
+
+/// @brief Add the totals of one profile to those of another.
+void cini_internal_add_parse_profile(
+    CiniParseProfile *profile,
+    const CiniParseProfile *addend
+);
+
+/// @brief Read what a document's profiler measured since profiling was
+///        enabled with `CINI_FEATURE_PROFILING`. Everything is zero if
+///        it wasn't, or if the library wasn't built with
+///        `CINI_PROFILING`.
+/// @return
+/// `CINI_SUCCESS` or `CINI_INVALID_POINTER`.
+int_fast8_t cini_get_parse_profile(
+    CiniDocument *document,
+    CiniParseProfile *profile
+);
+
+#endif // CINI_STATS_H
+
@@ -5,9 +5,25 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include <cini/enumerations.h>
+#include <cini/profile.h>
+
+// ==> Slices
+
+/// @brief View of a string that isn't necessarily zero-terminated.
+typedef struct
+{
+    const char *string;
+    uint_fast32_t length;
+
+} CiniSlice;
+
+
+
 // ==> Allocators
 
 typedef struct CiniArena CiniArena;
+typedef struct CiniArenaBlock CiniArenaBlock;
 
 typedef void * (*CiniAllocateFn)(
     uint_fast32_t amount,
@@ -19,21 +35,73 @@ typedef void (*CiniFreeFn)(
     void *userdata
 );
 
-struct CiniArena
+#define CINI_DEFAULT_ARENA_CAPACITY 16384
+#define CINI_DEFAULT_ARENA_ALIGNMENT 8
+#define CINI_DEFAULT_ARENA_GROWTH_FACTOR 2
+#define CINI_DEFAULT_ARENA_MAX_BLOCK (16 * 1024 * 1024)
+
+/// @brief Sizing of an arena. Fields which are zero get their default.
+typedef struct
+{
+    /// @brief Capacity of the first block in bytes.
+    uint32_t initial_capacity;
+
+    /// @brief Alignment of allocations; a power of two up to 64.
+    uint32_t alignment;
+
+    /// @brief Factor by which each block is larger than the previous.
+    uint32_t growth_factor;
+
+    /// @brief Capacity beyond which blocks don't grow any further,
+    ///        unless a single allocation needs a larger block.
+    uint32_t max_block_capacity;
+
+    /// @brief Whether rewinding keeps all blocks as they are, instead
+    ///        of merging them into a single block.
+    bool retain_blocks;
+
+} CiniArenaConfig;
+
+struct CiniArenaBlock
 {
+    CiniArenaBlock *next;
     uint32_t capacity;
+
+    /// @brief Bytes in use, which is only updated when the arena moves
+    ///        on to the next block; the tail's usage is the cursor's.
     uint32_t usage;
-    void *allocation;
+    uint8_t *data;
+};
+
+/// @brief Bump allocator over a list of blocks. Allocations are made
+///        from the tail block between `cursor` and `limit`, so that
+///        the common case is one comparison.
+struct CiniArena
+{
+    uint8_t *cursor;
+    uint8_t *limit;
+    uintptr_t alignment_mask;
+
+    CiniArenaBlock *first_block;
+    CiniArenaBlock *tail_block;
+
+    uint32_t growth_factor;
+    uint32_t max_block_capacity;
+    bool retain_blocks;
 
     CiniAllocateFn fn_allocate;
     CiniFreeFn fn_free;
     void *allocator;
 
-    CiniArena *continuation;
+    /// @brief Profiler of the owning document while it profiles, or
+    ///        `NULL`.
+    CiniProfiler *profiler;
 };
 
+/// @param config
+///        Sizing of the arena, or `NULL` for the defaults.
 CiniArena * cini_new_arena(
-    uint32_t capacity,
+    const CiniArenaConfig *config,
     CiniAllocateFn fn_alloc,
     CiniFreeFn fn_free,
     void *allocator
@@ -43,16 +111,73 @@ void cini_free_arena(
     CiniArena *arena
 );
 
+/// @brief Make all of an arena's memory available again, invalidating
+///        every allocation. The blocks are reused; unless the arena
+///        retains its blocks, several of them are replaced by a single
+///        one which can hold everything that was allocated before.
+void cini_rewind_arena(
+    CiniArena *arena
+);
+
+/// @brief Take over all memory of another arena, which must use the same
+///        allocator, and free that arena. Its allocations stay valid
+///        and are released together with the adopting arena.
+void cini_adopt_arena(
+    CiniArena *arena,
+    CiniArena *adopted
+);
+
+/// @brief Count an arena's blocks and the bytes of data which they
+///        reserve and of which allocations take up, including padding.
+void cini_measure_arena(
+    const CiniArena *arena,
+    uint64_t *num_blocks,
+    uint64_t *len_reserved,
+    uint64_t *len_used
+);
+
+/// @brief Allocate memory which is aligned to the arena's alignment.
 void * cini_arena_alloc(
     CiniArena *arena,
     uint32_t length
 );
 
+/// @brief Allocate memory without any alignment, for strings.
+void * cini_arena_alloc_bytes(
+    CiniArena *arena,
+    uint32_t length
+);
+
 char * cini_arena_copy_string(
     CiniArena *arena,
     const char *string
 );
 
+/// @brief Copy a string of known length into an arena and terminate
+///        the copy with a zero.
+char * cini_arena_copy_slice(
+    CiniArena *arena,
+    const char *string,
+    uint_fast32_t length
+);
+
+
+
+// ==> Hashing
+
+/// @brief Hash a string for the lookup indexes of sections and fields.
+uint32_t cini_hash_string(
+    const char *string,
+    uint_fast32_t length
+);
+
+/// @brief Hash a buffer of any length to 64 bits, to recognize content
+///        which didn't change.
+uint64_t cini_hash_bytes(
+    const char *bytes,
+    uint_fast32_t length
+);
+
 
 
 // ==> String/Character Utilities
@@ -119,9 +244,47 @@ uint_fast32_t cini_count_repetitions(
     uint_least32_t base_character
 );
 
+/// @brief Get the next link of a section path like `a.b c`, in which
+///        links are separated by a point, by whitespace or by both.
+/// @param string
+///        String which contains the path.
+/// @param offset
+///        Offset at which to start searching. Gets moved behind the
+///        link and the separator which follows it.
+/// @param end
+///        Offset of the path's end.
+/// @param link
+///        Pointer to where to put the link.
+/// @return
+/// 1 if a link was found, 0 at the end of the path or a negative
+/// `CiniStatus` if the path is malformed.
+int_fast8_t cini_next_path_link(
+    const char *string,
+    uint_fast32_t *offset,
+    uint_fast32_t end,
+    CiniSlice *link
+);
+
 bool cini_rune_is_ascii_special(uint32_t rune);
 CiniAsciiSign cini_rune_to_sign_enum(uint32_t rune);
 
 
+
+
+// ==> Escapes
+
+/// @brief Resolve the escape sequences of a quoted value's content,
+///        as handed to a handler's `fn_field` with `is_escaped` set.
+/// @param buffer
+///        Buffer of at least `len_text` bytes for the resolved text,
+///        which isn't zero-terminated.
+/// @return
+/// Length of the resolved text.
+uint_fast32_t cini_unescape_text(
+    const char *text,
+    uint_fast32_t len_text,
+    char *buffer
+);
+
 #endif // CINI_UTILITY_H
 
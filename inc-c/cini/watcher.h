@@ -0,0 +1,124 @@
+
+#ifndef CINI_WATCHER_H
+#define CINI_WATCHER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cini/document.h>
+
+// Milliseconds after which the watcher checks again whether replaced
+// documents can be freed, while readers still hold on to them.
+#define CINI_WATCHER_RECLAIM_INTERVAL 50
+
+typedef struct CiniWatcher CiniWatcher;
+typedef struct CiniReader CiniReader;
+typedef struct CiniRetiredDocument CiniRetiredDocument;
+
+/// @brief Thread which reads a watcher's documents. Readers announce
+///        the epoch in which they started reading, so that documents
+///        are only freed once no reader can still see them.
+struct CiniReader
+{
+    CiniReader *next;
+    CiniWatcher *watcher;
+
+    /// @brief Epoch in which the current read began, or zero between
+    ///        reads.
+    uint64_t epoch;
+    bool in_use;
+
+    // Readers are written on every read, so each gets a cache line of
+    // its own.
+    uint8_t padding[64 - (2 * sizeof(void *)) - sizeof(uint64_t) - 1];
+};
+
+/// @brief Document which was replaced, but may still be read by readers
+///        which began before `epoch`.
+struct CiniRetiredDocument
+{
+    CiniRetiredDocument *next;
+    CiniDocument *document;
+    uint64_t epoch;
+};
+
+struct CiniWatcher
+{
+    /// @brief Latest document, which is swapped atomically.
+    CiniDocument *document;
+
+    /// @brief Counter which is bumped after each swap.
+    uint64_t epoch;
+
+    /// @brief List of readers, which only grows while the watcher
+    ///        exists and can be walked without holding the lock.
+    CiniReader *readers;
+    pthread_mutex_t reader_lock;
+
+    char *path;
+    char *directory;
+    char *file_name;
+    int inotify_fd;
+    int stop_fd;
+    pthread_t thread;
+
+    /// @brief Replaced documents, which only the watcher's thread uses.
+    CiniRetiredDocument *retired;
+
+    uint_fast32_t version;
+    int_fast8_t status;
+};
+
+/// @brief Parse a file and re-parse it whenever it is written or
+///        replaced, on a thread of the watcher's own. Each version of
+///        the file is parsed into a fresh document, which is frozen
+///        and published with an atomic swap if parsing succeeded.
+/// @return
+/// The watcher, or `NULL` if the file can't be parsed or watched.
+CiniWatcher * cini_watch_path(
+    const char *path
+);
+
+/// @brief Stop watching and free all documents. No reader may be in
+///        the middle of a read.
+void cini_free_watcher(
+    CiniWatcher *watcher
+);
+
+/// @brief Add a reader, which is meant to be kept by one thread.
+/// @return
+/// The reader, or `NULL` on allocation failure.
+CiniReader * cini_add_reader(
+    CiniWatcher *watcher
+);
+
+void cini_remove_reader(
+    CiniReader *reader
+);
+
+/// @brief Begin a read of a watcher's latest document without locking.
+///        The document stays valid until `cini_end_read`. Reads of
+///        the same reader can't be nested.
+CiniDocument * cini_begin_read(
+    CiniReader *reader
+);
+
+void cini_end_read(
+    CiniReader *reader
+);
+
+/// @brief Get the number of documents a watcher has published, which
+///        starts at one for the first parse.
+uint_fast32_t cini_get_watcher_version(
+    CiniWatcher *watcher
+);
+
+/// @brief Get the status of the latest re-parse. If it failed, the
+///        previous document stays published.
+int_fast8_t cini_get_watcher_status(
+    CiniWatcher *watcher
+);
+
+#endif // CINI_WATCHER_H
+
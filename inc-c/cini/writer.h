@@ -0,0 +1,84 @@
+
+#ifndef CINI_WRITER_H
+#define CINI_WRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/uio.h>
+
+#include <cini/document.h>
+
+// Number of vectors which are gathered before they're handed to
+// `writev` or `fwrite` at once.
+#define CINI_WRITER_MAX_VECTORS 1024
+
+// Size of the buffer into which short pieces, like keys and the
+// separators around them, are copied so that adjacent ones are written
+// as one vector. Longer pieces are written from where they are.
+#define CINI_WRITER_STAGING_SIZE (64 * 1024)
+#define CINI_WRITER_MAX_COPY 128
+
+typedef struct CiniWriter CiniWriter;
+
+/// @brief Destination of a serialized document. Text for a caller's
+///        buffer is copied into it directly; text for files and file
+///        descriptors is gathered in vectors and written in batches.
+struct CiniWriter
+{
+    char *buffer;
+    uint_fast32_t len_buffer;
+
+    FILE *file;
+    int fd;
+
+    /// @brief Number of bytes of the whole text, including the ones
+    ///        which didn't fit into the caller's buffer.
+    uint_fast32_t len_text;
+    CiniStatus status;
+
+    uint_fast32_t num_vectors;
+    struct iovec *vectors;
+    uint_fast32_t len_staged;
+    char *staging;
+};
+
+/// @brief Write a document as INI text into a buffer. Sections are
+///        written in the order of the linear section list, each key
+///        once with its winning value. Values are only quoted if they
+///        couldn't be read back otherwise, and only escaped within
+///        quotes, so parsing the text gives the same document and
+///        writing that one gives the same text.
+/// @param buffer
+///        Buffer into which to write the zero-terminated text, or `NULL`
+///        for getting the text's length.
+/// @param len_buffer
+///        Length of `buffer`, which must have room for the terminator.
+/// @return
+/// Length of the text without the terminator, or a negative
+/// `CiniStatus` like `CINI_LIMITATION_EXCEEDED` if it doesn't fit.
+int_fast32_t cini_write_document(
+    CiniDocument *document,
+    char *buffer,
+    uint_fast32_t len_buffer
+);
+
+/// @brief Write a document as INI text to a stream in large batches.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_write_document_file(
+    CiniDocument *document,
+    FILE *file
+);
+
+/// @brief Write a document as INI text to a file descriptor, handing
+///        it the gathered pieces in batches with `writev`.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_write_document_fd(
+    CiniDocument *document,
+    int fd
+);
+
+#endif // CINI_WRITER_H
+
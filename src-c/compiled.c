@@ -0,0 +1,1041 @@
+#include <cini/compiled.h>
+#include <cini/field.h>
+#include <cini/parser.h>
+#include <cini/section.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ==> Layout
+
+/// @brief Sizes of the tables of a document's compiled image.
+typedef struct
+{
+    uint_fast32_t num_sections;
+    uint_fast32_t num_fields;
+    uint_fast32_t num_section_slots;
+    uint_fast32_t num_field_slots;
+    uint64_t len_strings;
+
+} CiniCompiledSizes;
+
+/// @brief Get the capacity of the index which a compiled section gets
+///        for a number of entries, or zero if they're searched linearly.
+uint_fast32_t cini_internal_compiled_index_capacity(
+    uint_fast32_t num_entries,
+    uint_fast32_t threshold
+) {
+    if (num_entries <= threshold)
+    {
+        return 0;
+    }
+    uint_fast32_t capacity = 16;
+    while (capacity < (num_entries * 2))
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+uint64_t cini_internal_align_offset(
+    uint64_t offset
+) {
+    return (offset + 7) & ~((uint64_t) 7);
+}
+
+/// @brief Number the document's sections in the order of the linear
+///        section list and measure the tables of its compiled image.
+void cini_internal_measure_document(
+    CiniDocument *document,
+    CiniCompiledSizes *sizes
+) {
+    memset(sizes, 0, sizeof(CiniCompiledSizes));
+    CiniSection *section = document->first_section;
+    while (section)
+    {
+        section->linear_index = sizes->num_sections;
+        ++sizes->num_sections;
+        sizes->num_fields += section->num_fields;
+        sizes->num_section_slots += cini_internal_compiled_index_capacity(
+            section->num_sub_sections,
+            CINI_SUB_SECTION_INDEX_THRESHOLD
+        );
+        sizes->num_field_slots += cini_internal_compiled_index_capacity(
+            section->num_fields,
+            CINI_FIELD_INDEX_THRESHOLD
+        );
+        const char *full_name = cini_internal_get_full_name(
+            document,
+            section
+        );
+        sizes->len_strings += section->len_name + 1;
+        sizes->len_strings += strlen(full_name) + 1;
+
+        CiniField *field = section->first_field;
+        while (field)
+        {
+            sizes->len_strings += field->len_key + 1;
+            sizes->len_strings += field->len_value + 1;
+            field = field->next_in_section;
+        }
+        section = section->linear_next;
+    }
+}
+
+void cini_internal_insert_compiled_slot(
+    CiniCompiledSlot *slots,
+    uint_fast32_t capacity,
+    uint32_t hash,
+    uint32_t index
+) {
+    uint_fast32_t mask = capacity - 1;
+    uint_fast32_t slot_index = hash & mask;
+    while (slots[slot_index].index)
+    {
+        slot_index = (slot_index + 1) & mask;
+    }
+    slots[slot_index].hash = hash;
+    slots[slot_index].index = index + 1;
+}
+
+/// @brief Append a string and a terminating zero to the string table.
+/// @return
+/// Offset of the string in the string table.
+uint32_t cini_internal_append_compiled_string(
+    char *strings,
+    uint32_t *len_strings,
+    const char *string,
+    uint_fast32_t len_string
+) {
+    uint32_t offset = *len_strings;
+    memcpy(&strings[offset], string, len_string);
+    strings[offset + len_string] = 0;
+    *len_strings += len_string + 1;
+    return offset;
+}
+
+/// @brief Write a document's compiled image into a buffer which has
+///        the size that `cini_internal_measure_document` found.
+void cini_internal_fill_compiled_image(
+    CiniDocument *document,
+    const CiniCompiledSizes *sizes,
+    uint8_t *image,
+    uint_fast32_t len_image
+) {
+    CiniCompiledHeader *header = (CiniCompiledHeader *) image;
+    memcpy(header->magic, CINI_COMPILED_MAGIC, 8);
+    header->version = CINI_COMPILED_VERSION;
+    header->byte_order = CINI_COMPILED_BYTE_ORDER;
+    header->len_file = len_image;
+    header->num_sections = sizes->num_sections;
+    header->num_fields = sizes->num_fields;
+    header->num_sub_section_links = sizes->num_sections - 1;
+    header->num_section_slots = sizes->num_section_slots;
+    header->num_field_slots = sizes->num_field_slots;
+
+    uint64_t offset = cini_internal_align_offset(sizeof(CiniCompiledHeader));
+    header->sections_offset = offset;
+    offset += sizes->num_sections * sizeof(CiniCompiledSection);
+    offset = cini_internal_align_offset(offset);
+    header->fields_offset = offset;
+    offset += sizes->num_fields * sizeof(CiniCompiledField);
+    header->sub_section_links_offset = offset;
+    offset += header->num_sub_section_links * sizeof(uint32_t);
+    offset = cini_internal_align_offset(offset);
+    header->section_slots_offset = offset;
+    offset += sizes->num_section_slots * sizeof(CiniCompiledSlot);
+    header->field_slots_offset = offset;
+    offset += sizes->num_field_slots * sizeof(CiniCompiledSlot);
+    header->strings_offset = offset;
+
+    CiniCompiledSection *sections =
+        (CiniCompiledSection *) &image[header->sections_offset];
+    CiniCompiledField *fields =
+        (CiniCompiledField *) &image[header->fields_offset];
+    uint32_t *sub_section_links =
+        (uint32_t *) &image[header->sub_section_links_offset];
+    CiniCompiledSlot *section_slots =
+        (CiniCompiledSlot *) &image[header->section_slots_offset];
+    CiniCompiledSlot *field_slots =
+        (CiniCompiledSlot *) &image[header->field_slots_offset];
+    char *strings = (char *) &image[header->strings_offset];
+
+    uint32_t num_fields = 0;
+    uint32_t num_sub_section_links = 0;
+    uint32_t num_section_slots = 0;
+    uint32_t num_field_slots = 0;
+    uint32_t len_strings = 0;
+    CiniSection *section = document->first_section;
+    while (section)
+    {
+        CiniCompiledSection *compiled_section =
+            &sections[section->linear_index];
+        compiled_section->name = cini_internal_append_compiled_string(
+            strings,
+            &len_strings,
+            section->name,
+            section->len_name
+        );
+        compiled_section->len_name = section->len_name;
+        compiled_section->name_hash = section->name_hash;
+        compiled_section->full_name = cini_internal_append_compiled_string(
+            strings,
+            &len_strings,
+            section->full_name,
+            strlen(section->full_name)
+        );
+        compiled_section->parent = CINI_COMPILED_NONE;
+        if (section->parent)
+        {
+            compiled_section->parent = section->parent->linear_index;
+        }
+
+        // Sub-sections and their index
+
+        compiled_section->first_sub_section_link = num_sub_section_links;
+        compiled_section->num_sub_sections = section->num_sub_sections;
+        compiled_section->first_section_slot = num_section_slots;
+        compiled_section->section_index_capacity =
+            cini_internal_compiled_index_capacity(
+                section->num_sub_sections,
+                CINI_SUB_SECTION_INDEX_THRESHOLD
+            );
+        for (
+            uint_fast32_t sub_section_index = 0;
+            sub_section_index < section->num_sub_sections;
+            ++sub_section_index
+        ) {
+            CiniSection *sub_section =
+                section->sub_sections[sub_section_index];
+            sub_section_links[num_sub_section_links + sub_section_index] =
+                sub_section->linear_index;
+            if (compiled_section->section_index_capacity)
+            {
+                cini_internal_insert_compiled_slot(
+                    &section_slots[num_section_slots],
+                    compiled_section->section_index_capacity,
+                    sub_section->name_hash,
+                    sub_section->linear_index
+                );
+            }
+        }
+        num_sub_section_links += section->num_sub_sections;
+        num_section_slots += compiled_section->section_index_capacity;
+
+        // Fields, with their values decoded, and their index
+
+        compiled_section->first_field = num_fields;
+        compiled_section->num_fields = section->num_fields;
+        compiled_section->first_field_slot = num_field_slots;
+        compiled_section->field_index_capacity =
+            cini_internal_compiled_index_capacity(
+                section->num_fields,
+                CINI_FIELD_INDEX_THRESHOLD
+            );
+        CiniField *field = section->first_field;
+        while (field)
+        {
+            CiniField scratch;
+            const CiniField *decoded = cini_internal_get_decoded(
+                field,
+                &scratch
+            );
+            CiniCompiledField *compiled_field = &fields[num_fields];
+            compiled_field->integer = decoded->integer;
+            compiled_field->decimal = decoded->decimal;
+            compiled_field->key = cini_internal_append_compiled_string(
+                strings,
+                &len_strings,
+                field->key,
+                field->len_key
+            );
+            compiled_field->len_key = field->len_key;
+            compiled_field->key_hash = field->key_hash;
+            compiled_field->value = cini_internal_append_compiled_string(
+                strings,
+                &len_strings,
+                field->value,
+                field->len_value
+            );
+            compiled_field->len_value = field->len_value;
+            compiled_field->applicable_types = decoded->applicable_types;
+            compiled_field->boolean = decoded->boolean;
+            compiled_field->reserved = 0;
+            if (compiled_section->field_index_capacity)
+            {
+                cini_internal_insert_compiled_slot(
+                    &field_slots[num_field_slots],
+                    compiled_section->field_index_capacity,
+                    field->key_hash,
+                    num_fields - compiled_section->first_field
+                );
+            }
+            ++num_fields;
+            field = field->next_in_section;
+        }
+        num_field_slots += compiled_section->field_index_capacity;
+        section = section->linear_next;
+    }
+    header->len_strings = len_strings;
+}
+
+
+
+// ==> Saving and loading
+
+/// @brief Write a whole buffer to a file descriptor.
+bool cini_internal_write_all(
+    int fd,
+    const uint8_t *buffer,
+    uint_fast32_t len_buffer
+) {
+    uint_fast32_t offset = 0;
+    while (offset < len_buffer)
+    {
+        ssize_t len_written = write(fd, &buffer[offset], len_buffer - offset);
+        if (len_written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        offset += len_written;
+    }
+    return true;
+}
+
+/// @brief Write an image to a temporary file next to the path and move
+///        it into place, so that readers never map a partial file. The
+///        temporary file has a unique name, so that concurrent saves to
+///        the same path don't write into each other's file.
+int_fast8_t cini_internal_write_compiled_file(
+    const char *path,
+    const uint8_t *image,
+    uint_fast32_t len_image
+) {
+    uint_fast32_t len_path = strlen(path);
+    char *temporary_path = malloc(len_path + 8);
+    if ( ! temporary_path)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    memcpy(temporary_path, path, len_path);
+    memcpy(&temporary_path[len_path], ".XXXXXX", 8);
+
+    int fd = mkstemp(temporary_path);
+    if (fd < 0)
+    {
+        int_fast8_t status = CINI_WRITE_FAILURE;
+        if (errno == ENOENT)
+        {
+            status = CINI_FILE_NOT_FOUND;
+        }
+        free(temporary_path);
+        return status;
+    }
+    bool written = (fchmod(fd, 0644) == 0)
+        && cini_internal_write_all(fd, image, len_image);
+    if (close(fd) != 0)
+    {
+        written = false;
+    }
+    if (( ! written) || (rename(temporary_path, path) != 0))
+    {
+        unlink(temporary_path);
+        free(temporary_path);
+        return CINI_WRITE_FAILURE;
+    }
+    free(temporary_path);
+    return CINI_SUCCESS;
+}
+
+int_fast8_t cini_save_compiled(
+    CiniDocument *document,
+    const char *path
+) {
+    if (( ! document) || ( ! path))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if (document->compiled)
+    {
+        // A loaded image is saved as it is.
+
+        return cini_internal_write_compiled_file(
+            path,
+            (const uint8_t *) document->compiled,
+            document->compiled->len_file
+        );
+    }
+
+    CiniCompiledSizes sizes;
+    cini_internal_measure_document(document, &sizes);
+    uint64_t len_image = cini_internal_align_offset(
+        sizeof(CiniCompiledHeader)
+    );
+    len_image += sizes.num_sections * sizeof(CiniCompiledSection);
+    len_image = cini_internal_align_offset(len_image);
+    len_image += sizes.num_fields * sizeof(CiniCompiledField);
+    len_image += (sizes.num_sections - 1) * sizeof(uint32_t);
+    len_image = cini_internal_align_offset(len_image);
+    len_image += sizes.num_section_slots * sizeof(CiniCompiledSlot);
+    len_image += sizes.num_field_slots * sizeof(CiniCompiledSlot);
+    len_image += sizes.len_strings;
+    if (len_image > UINT32_MAX)
+    {
+        return CINI_LIMITATION_EXCEEDED;
+    }
+
+    // The slots' empty marker is zero, so the image starts zeroed.
+
+    uint8_t *image = document->fn_alloc(len_image, document->allocator);
+    if ( ! image)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    memset(image, 0, len_image);
+    cini_internal_fill_compiled_image(document, &sizes, image, len_image);
+    int_fast8_t status = cini_internal_write_compiled_file(
+        path,
+        image,
+        len_image
+    );
+    document->fn_free(image, document->allocator);
+    return status;
+}
+
+/// @brief Check that a table lies within the file.
+bool cini_internal_check_compiled_table(
+    const CiniCompiledHeader *header,
+    uint32_t offset,
+    uint64_t length
+) {
+    return ((uint64_t) offset + length) <= header->len_file;
+}
+
+/// @brief Check a header before its image is used.
+bool cini_internal_check_compiled_header(
+    const CiniCompiledHeader *header,
+    uint_fast32_t len_file
+) {
+    if (len_file < sizeof(CiniCompiledHeader))
+    {
+        return false;
+    }
+    if (
+         memcmp(header->magic, CINI_COMPILED_MAGIC, 8)
+      || (header->version != CINI_COMPILED_VERSION)
+      || (header->byte_order != CINI_COMPILED_BYTE_ORDER)
+      || (header->len_file != len_file)
+      || (header->num_sections == 0)
+      || (header->num_sub_section_links != (header->num_sections - 1))
+      || (header->sections_offset % 8)
+      || (header->fields_offset % 8)
+      || (header->sub_section_links_offset % 4)
+      || (header->section_slots_offset % 4)
+      || (header->field_slots_offset % 4)
+    ) {
+        return false;
+    }
+    return cini_internal_check_compiled_table(
+            header,
+            header->sections_offset,
+            (uint64_t) header->num_sections * sizeof(CiniCompiledSection)
+        )
+        && cini_internal_check_compiled_table(
+            header,
+            header->fields_offset,
+            (uint64_t) header->num_fields * sizeof(CiniCompiledField)
+        )
+        && cini_internal_check_compiled_table(
+            header,
+            header->sub_section_links_offset,
+            (uint64_t) header->num_sub_section_links * sizeof(uint32_t)
+        )
+        && cini_internal_check_compiled_table(
+            header,
+            header->section_slots_offset,
+            (uint64_t) header->num_section_slots * sizeof(CiniCompiledSlot)
+        )
+        && cini_internal_check_compiled_table(
+            header,
+            header->field_slots_offset,
+            (uint64_t) header->num_field_slots * sizeof(CiniCompiledSlot)
+        )
+        && cini_internal_check_compiled_table(
+            header,
+            header->strings_offset,
+            header->len_strings
+        );
+}
+
+/// @brief Check that a string of a known length lies within the string
+///        table and is terminated right after its end.
+bool cini_internal_check_compiled_string(
+    const CiniCompiledHeader *header,
+    uint32_t offset,
+    uint32_t length
+) {
+    if (((uint64_t) offset + length) >= header->len_strings)
+    {
+        return false;
+    }
+    return cini_internal_get_compiled_string(header, offset)[length] == 0;
+}
+
+/// @brief Check that an index's capacity is zero or a power of two, that
+///        its slots lie within their table and refer to entries below a
+///        limit, and that at least one slot is empty, so that probing
+///        ends.
+bool cini_internal_check_compiled_index(
+    const CiniCompiledHeader *header,
+    uint32_t table_offset,
+    uint_fast32_t num_table_slots,
+    uint32_t first_slot,
+    uint32_t capacity,
+    uint_fast32_t num_entries
+) {
+    if (capacity == 0)
+    {
+        return true;
+    }
+    if (
+         (capacity & (capacity - 1))
+      || (((uint64_t) first_slot + capacity) > num_table_slots)
+    ) {
+        return false;
+    }
+    const CiniCompiledSlot *slots = cini_internal_get_compiled_slots(
+        header,
+        table_offset,
+        first_slot
+    );
+    uint_fast32_t num_used = 0;
+    for (uint_fast32_t slot_index = 0; slot_index < capacity; ++slot_index)
+    {
+        if (slots[slot_index].index > num_entries)
+        {
+            return false;
+        }
+        if (slots[slot_index].index)
+        {
+            ++num_used;
+        }
+    }
+    return num_used < capacity;
+}
+
+/// @brief Check every record of an image whose tables were checked
+///        already, so that a damaged image can't lead the getters out
+///        of the mapping. Parents precede their sub-sections, which
+///        keeps the section tree free of cycles.
+bool cini_internal_check_compiled_records(
+    const CiniCompiledHeader *header
+) {
+    if (
+         (header->len_strings == 0)
+      || (cini_internal_get_compiled_string(
+            header,
+            header->len_strings - 1
+        )[0] != 0)
+    ) {
+        return false;
+    }
+    const uint32_t *links = (const uint32_t *)
+        (((const uint8_t *) header) + header->sub_section_links_offset);
+    for (uint_fast32_t index = 0; index < header->num_sections; ++index)
+    {
+        const CiniCompiledSection *section =
+            cini_internal_get_compiled_section(header, index);
+        bool has_valid_parent = (index == 0)
+            ? (section->parent == CINI_COMPILED_NONE)
+            : (section->parent < index);
+        if (
+             ( ! has_valid_parent)
+          || ( ! cini_internal_check_compiled_string(
+                header,
+                section->name,
+                section->len_name
+            ))
+          || (section->full_name >= header->len_strings)
+          || (
+                ((uint64_t) section->first_sub_section_link
+                    + section->num_sub_sections)
+              > header->num_sub_section_links
+            )
+          || (
+                ((uint64_t) section->first_field + section->num_fields)
+              > header->num_fields
+            )
+          || ( ! cini_internal_check_compiled_index(
+                header,
+                header->section_slots_offset,
+                header->num_section_slots,
+                section->first_section_slot,
+                section->section_index_capacity,
+                header->num_sections
+            ))
+          || ( ! cini_internal_check_compiled_index(
+                header,
+                header->field_slots_offset,
+                header->num_field_slots,
+                section->first_field_slot,
+                section->field_index_capacity,
+                section->num_fields
+            ))
+        ) {
+            return false;
+        }
+        for (
+            uint_fast32_t link_index = 0;
+            link_index < section->num_sub_sections;
+            ++link_index
+        ) {
+            uint32_t sub_section_index =
+                links[section->first_sub_section_link + link_index];
+            if (
+                 (sub_section_index <= index)
+              || (sub_section_index >= header->num_sections)
+              || (cini_internal_get_compiled_section(
+                    header,
+                    sub_section_index
+                )->parent != index)
+            ) {
+                return false;
+            }
+        }
+    }
+    for (uint_fast32_t index = 0; index < header->num_fields; ++index)
+    {
+        const CiniCompiledField *field =
+            cini_internal_get_compiled_field(header, index);
+        if (
+             ( ! cini_internal_check_compiled_string(
+                header,
+                field->key,
+                field->len_key
+            ))
+          || ( ! cini_internal_check_compiled_string(
+                header,
+                field->value,
+                field->len_value
+            ))
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Map a compiled image and check its header.
+/// @param mapping
+///        Pointer to where to put the mapping, which is only set on
+///        success and must be unmapped by the caller.
+/// @return
+/// `CINI_SUCCESS`, `CINI_FILE_NOT_FOUND` if the file can't be opened or
+/// mapped, or `CINI_SYNTAX_ERROR` if it isn't a compiled image of this
+/// version and byte order.
+int_fast8_t cini_internal_map_compiled_file(
+    const char *path,
+    void **mapping,
+    uint_fast32_t *len_mapping
+) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return CINI_FILE_NOT_FOUND;
+    }
+    struct stat file_status;
+    if (
+         (fstat(fd, &file_status) != 0)
+      || ( ! S_ISREG(file_status.st_mode))
+    ) {
+        close(fd);
+        return CINI_FILE_NOT_FOUND;
+    }
+    if (
+         (((uint64_t) file_status.st_size) > UINT32_MAX)
+      || (((uint64_t) file_status.st_size) < sizeof(CiniCompiledHeader))
+    ) {
+        close(fd);
+        return CINI_SYNTAX_ERROR;
+    }
+    uint_fast32_t len_file = file_status.st_size;
+    void *mapped = mmap(NULL, len_file, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        return CINI_FILE_NOT_FOUND;
+    }
+    if ( ! cini_internal_check_compiled_header(mapped, len_file))
+    {
+        munmap(mapped, len_file);
+        return CINI_SYNTAX_ERROR;
+    }
+    *mapping = mapped;
+    *len_mapping = len_file;
+    return CINI_SUCCESS;
+}
+
+int_fast8_t cini_verify_compiled(
+    const char *path
+) {
+    if ( ! path)
+    {
+        return CINI_INVALID_POINTER;
+    }
+    void *mapping;
+    uint_fast32_t len_mapping;
+    int_fast8_t status = cini_internal_map_compiled_file(
+        path,
+        &mapping,
+        &len_mapping
+    );
+    if (status != CINI_SUCCESS)
+    {
+        return status;
+    }
+    if ( ! cini_internal_check_compiled_records(mapping))
+    {
+        status = CINI_SYNTAX_ERROR;
+    }
+    munmap(mapping, len_mapping);
+    return status;
+}
+
+CiniDocument * cini_load_compiled(
+    const char *path,
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata
+) {
+    if (( ! path) || ( ! fn_alloc) || ( ! fn_free))
+    {
+        return NULL;
+    }
+
+    // Only the header is checked, so that loading stays independent of
+    // the image's size; cini_verify_compiled checks every record.
+
+    void *mapping;
+    uint_fast32_t len_file;
+    if (
+        cini_internal_map_compiled_file(path, &mapping, &len_file)
+            != CINI_SUCCESS
+    ) {
+        return NULL;
+    }
+    const CiniCompiledHeader *header = mapping;
+
+    // The document only needs a small arena for the bookkeeping of its
+    // source buffers; everything else is read from the mapping.
+
+    CiniArenaConfig arena_config = {256, 0, 0, 0, false};
+    CiniDocument *document = cini_new_configured_document(
+        fn_alloc,
+        fn_free,
+        userdata,
+        &arena_config
+    );
+    if ( ! document)
+    {
+        munmap(mapping, len_file);
+        return NULL;
+    }
+    cini_internal_register_source_buffer(document, mapping, len_file, true);
+    document->compiled = header;
+
+    // Compiled documents can't be parsed into; they have no tree.
+
+    document->root_section = NULL;
+    document->first_section = NULL;
+    document->last_section = NULL;
+    document->num_sections = header->num_sections;
+    document->num_values = header->num_fields;
+    return document;
+}
+
+
+
+// ==> Access
+
+const char * cini_internal_get_compiled_string(
+    const CiniCompiledHeader *header,
+    uint32_t offset
+) {
+    return ((const char *) header) + header->strings_offset + offset;
+}
+
+const CiniCompiledSection * cini_internal_get_compiled_section(
+    const CiniCompiledHeader *header,
+    uint_fast32_t index
+) {
+    const CiniCompiledSection *sections = (const CiniCompiledSection *)
+        (((const uint8_t *) header) + header->sections_offset);
+    return &sections[index];
+}
+
+const CiniCompiledField * cini_internal_get_compiled_field(
+    const CiniCompiledHeader *header,
+    uint_fast32_t index
+) {
+    const CiniCompiledField *fields = (const CiniCompiledField *)
+        (((const uint8_t *) header) + header->fields_offset);
+    return &fields[index];
+}
+
+const CiniCompiledSlot * cini_internal_get_compiled_slots(
+    const CiniCompiledHeader *header,
+    uint32_t table_offset,
+    uint_fast32_t first_slot
+) {
+    const CiniCompiledSlot *slots = (const CiniCompiledSlot *)
+        (((const uint8_t *) header) + table_offset);
+    return &slots[first_slot];
+}
+
+const CiniCompiledSection * cini_internal_find_compiled_sub_section(
+    const CiniCompiledHeader *header,
+    const CiniCompiledSection *section,
+    const char *name,
+    uint_fast32_t len_name,
+    uint32_t name_hash
+) {
+    if (section->section_index_capacity)
+    {
+        const CiniCompiledSlot *slots = cini_internal_get_compiled_slots(
+            header,
+            header->section_slots_offset,
+            section->first_section_slot
+        );
+        uint_fast32_t mask = section->section_index_capacity - 1;
+        uint_fast32_t slot_index = name_hash & mask;
+        while (slots[slot_index].index)
+        {
+            if (slots[slot_index].hash == name_hash)
+            {
+                const CiniCompiledSection *sub_section =
+                    cini_internal_get_compiled_section(
+                        header,
+                        slots[slot_index].index - 1
+                    );
+                if (
+                     (sub_section->len_name == len_name)
+                  && ( ! memcmp(
+                        cini_internal_get_compiled_string(
+                            header,
+                            sub_section->name
+                        ),
+                        name,
+                        len_name))
+                ) {
+                    return sub_section;
+                }
+            }
+            slot_index = (slot_index + 1) & mask;
+        }
+        return NULL;
+    }
+
+    const uint32_t *links = (const uint32_t *)
+        (((const uint8_t *) header) + header->sub_section_links_offset);
+    for (
+        uint_fast32_t link_index = 0;
+        link_index < section->num_sub_sections;
+        ++link_index
+    ) {
+        const CiniCompiledSection *sub_section =
+            cini_internal_get_compiled_section(
+                header,
+                links[section->first_sub_section_link + link_index]
+            );
+        if (
+             (sub_section->name_hash == name_hash)
+          && (sub_section->len_name == len_name)
+          && ( ! memcmp(
+                cini_internal_get_compiled_string(header, sub_section->name),
+                name,
+                len_name))
+        ) {
+            return sub_section;
+        }
+    }
+    return NULL;
+}
+
+const CiniCompiledSection * cini_internal_resolve_compiled_section(
+    const CiniCompiledHeader *header,
+    const char *path,
+    uint_fast32_t len_path
+) {
+    const CiniCompiledSection *section = cini_internal_get_compiled_section(
+        header,
+        0
+    );
+    uint_fast32_t offset = 0;
+    CiniSlice link;
+    while (true)
+    {
+        int_fast8_t status = cini_next_path_link(
+            path,
+            &offset,
+            len_path,
+            &link
+        );
+        if (status < 0)
+        {
+            return NULL;
+        }
+        if (status == 0)
+        {
+            break;
+        }
+        section = cini_internal_find_compiled_sub_section(
+            header,
+            section,
+            link.string,
+            link.length,
+            cini_hash_string(link.string, link.length)
+        );
+        if ( ! section)
+        {
+            return NULL;
+        }
+    }
+    return section;
+}
+
+const CiniCompiledField * cini_internal_find_compiled_field(
+    const CiniCompiledHeader *header,
+    const CiniCompiledSection *section,
+    const char *key,
+    uint_fast32_t len_key
+) {
+    uint32_t key_hash = cini_hash_string(key, len_key);
+    if (section->field_index_capacity)
+    {
+        const CiniCompiledSlot *slots = cini_internal_get_compiled_slots(
+            header,
+            header->field_slots_offset,
+            section->first_field_slot
+        );
+        uint_fast32_t mask = section->field_index_capacity - 1;
+        uint_fast32_t slot_index = key_hash & mask;
+        while (slots[slot_index].index)
+        {
+            if (slots[slot_index].hash == key_hash)
+            {
+                const CiniCompiledField *field =
+                    cini_internal_get_compiled_field(
+                        header,
+                        section->first_field + slots[slot_index].index - 1
+                    );
+                if (
+                     (field->len_key == len_key)
+                  && ( ! memcmp(
+                        cini_internal_get_compiled_string(header, field->key),
+                        key,
+                        len_key))
+                ) {
+                    return field;
+                }
+            }
+            slot_index = (slot_index + 1) & mask;
+        }
+        return NULL;
+    }
+
+    for (
+        uint_fast32_t field_index = 0;
+        field_index < section->num_fields;
+        ++field_index
+    ) {
+        const CiniCompiledField *field = cini_internal_get_compiled_field(
+            header,
+            section->first_field + field_index
+        );
+        if (
+             (field->key_hash == key_hash)
+          && (field->len_key == len_key)
+          && ( ! memcmp(
+                cini_internal_get_compiled_string(header, field->key),
+                key,
+                len_key))
+        ) {
+            return field;
+        }
+    }
+    return NULL;
+}
+
+void cini_internal_expose_compiled_field(
+    const CiniCompiledHeader *header,
+    const CiniCompiledField *compiled_field,
+    CiniField *field
+) {
+    field->next_in_section = NULL;
+    field->applicable_types = compiled_field->applicable_types;
+    field->flags = CINI_FIELD_VALUE_TERMINATED;
+    field->len_key = compiled_field->len_key;
+    field->len_value = compiled_field->len_value;
+    field->key_hash = compiled_field->key_hash;
+    field->key = cini_internal_get_compiled_string(
+        header,
+        compiled_field->key
+    );
+    field->value = cini_internal_get_compiled_string(
+        header,
+        compiled_field->value
+    );
+    field->decode_state = CINI_DECODE_DONE;
+    field->boolean = compiled_field->boolean;
+    field->integer = compiled_field->integer;
+    field->decimal = compiled_field->decimal;
+}
+
+const char * cini_internal_get_compiled_section_name(
+    const CiniCompiledHeader *header,
+    const char *super_section,
+    uint_fast32_t index
+) {
+    if ( ! super_section)
+    {
+        // The root section is the first one, but isn't listed.
+
+        if (index >= (header->num_sections - 1))
+        {
+            return NULL;
+        }
+        return cini_internal_get_compiled_string(
+            header,
+            cini_internal_get_compiled_section(header, index + 1)->full_name
+        );
+    }
+    const CiniCompiledSection *section =
+        cini_internal_resolve_compiled_section(
+            header,
+            super_section,
+            strlen(super_section)
+        );
+    if (( ! section) || (index >= section->num_sub_sections))
+    {
+        return NULL;
+    }
+    const uint32_t *links = (const uint32_t *)
+        (((const uint8_t *) header) + header->sub_section_links_offset);
+    const CiniCompiledSection *sub_section =
+        cini_internal_get_compiled_section(
+            header,
+            links[section->first_sub_section_link + index]
+        );
+    return cini_internal_get_compiled_string(header, sub_section->full_name);
+}
+
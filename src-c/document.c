@@ -1,7 +1,14 @@
 #include <cini/document.h>
+#include <cini/field.h>
+#include <cini/log.h>
+#include <cini/query.h>
+#include <cini/section.h>
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 void * cini_call_wrapped_malloc(
     uint_fast32_t amount,
@@ -21,6 +28,74 @@ void cini_call_wrapped_free(
 
 
 
+/// @brief Allocator which the document hands to its arena and uses
+///        itself, to count the calls to the user's allocator.
+void * cini_internal_counted_alloc(
+    uint_fast32_t amount,
+    void *userdata
+) {
+    CiniDocument *document = userdata;
+    __atomic_fetch_add(&document->num_allocations, 1, __ATOMIC_RELAXED);
+    return document->fn_user_alloc(amount, document->user_allocator);
+}
+
+void cini_internal_counted_free(
+    void *pointer,
+    void *userdata
+) {
+    // The pointer may be the document itself.
+
+    CiniDocument *document = userdata;
+    CiniFreeFn fn_free = document->fn_user_free;
+    void *allocator = document->user_allocator;
+    __atomic_fetch_add(&document->num_frees, 1, __ATOMIC_RELAXED);
+    fn_free(pointer, allocator);
+}
+
+
+
+/// @brief Create the root section of an empty document in its arena.
+void cini_internal_init_document_tree(
+    CiniDocument *document
+) {
+    document->num_sections = 1;
+    document->num_values = 0;
+    document->first_section = cini_arena_alloc(
+        document->arena,
+        sizeof(CiniSection)
+    );
+    document->last_section = document->first_section;
+    document->root_section = document->first_section;
+    document->root_section->name = "$";
+    document->root_section->len_name = 1;
+    document->root_section->name_hash = cini_hash_string("$", 1);
+    document->root_section->full_name = "";
+    document->root_section->sub_section_index_capacity = 0;
+    document->root_section->sub_section_index = NULL;
+    document->root_section->parent = NULL;
+    document->root_section->first_field = NULL;
+    document->root_section->last_field = NULL;
+    document->root_section->num_fields = 0;
+    document->root_section->field_index_capacity = 0;
+    document->root_section->field_index = NULL;
+    document->root_section->linear_next = NULL;
+    document->root_section->sub_sections_capacity = 0;
+    document->root_section->num_sub_sections = 0;
+    document->root_section->sub_sections = NULL;
+    document->section_table = NULL;
+    document->len_section_table = 0;
+    document->len_abandoned_sub_sections = 0;
+    document->len_abandoned_indexes = 0;
+    document->log_entries = NULL;
+    document->num_logged = 0;
+    if (document->features & CINI_FEATURE_LOG)
+    {
+        cini_internal_create_log(document);
+    }
+}
+
+
+
 CiniDocument * cini_malloc_document()
 {
     return cini_new_document(
@@ -34,39 +109,216 @@ CiniDocument * cini_new_document(
     CiniAllocateFn fn_alloc,
     CiniFreeFn fn_free,
     void *userdata
+) {
+    return cini_new_configured_document(fn_alloc, fn_free, userdata, NULL);
+}
+
+CiniDocument * cini_new_configured_document(
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata,
+    const CiniArenaConfig *arena_config
 ) {
     CiniDocument *document = fn_alloc(
         sizeof(CiniDocument),
         userdata
     );
+    if ( ! document)
+    {
+        return NULL;
+    }
+    document->fn_user_alloc = fn_alloc;
+    document->fn_user_free = fn_free;
+    document->user_allocator = userdata;
+    document->fn_alloc = cini_internal_counted_alloc;
+    document->fn_free = cini_internal_counted_free;
+    document->allocator = document;
+    document->num_allocations = 1;
+    document->num_frees = 0;
     document->arena = cini_new_arena(
-        16384,
-        fn_alloc,
-        fn_free,
-        userdata
+        arena_config,
+        document->fn_alloc,
+        document->fn_free,
+        document
     );
-    document->fn_alloc = fn_alloc;
-    document->fn_free = fn_free;
-    document->num_sections = 1;
-    document->first_section = cini_arena_alloc(
-        document->arena,
-        sizeof(CiniSection)
-    );
-    document->root_section = document->first_section;
-    document->root_section->name = "$";
-    document->root_section->first_field = NULL;
-    document->root_section->linear_next = NULL;
-    document->root_section->sub_sections_capacity = 0;
-    document->root_section->num_sub_sections = 0;
-    document->root_section->sub_sections = NULL;
+    if ( ! document->arena)
+    {
+        fn_free(document, userdata);
+        return NULL;
+    }
+    document->generation = 0;
+    document->source_buffers = NULL;
+    document->compiled = NULL;
+    document->num_parse_threads = 1;
+    document->source_blocks = NULL;
+    document->num_source_blocks = 0;
+    document->is_frozen = false;
+    document->features = 0;
+    document->profiler = NULL;
+    cini_internal_init_document_tree(document);
 
     return document;
 }
 
+void cini_free_source_buffers(
+    CiniDocument *document
+) {
+    // The list itself lives in the arena and goes away with it.
+    CiniSourceBuffer *source_buffer = document->source_buffers;
+    while (source_buffer)
+    {
+        if (source_buffer->is_mapping)
+        {
+            munmap(source_buffer->address, source_buffer->length);
+        }
+        else
+        {
+            document->fn_free(source_buffer->address, document->allocator);
+        }
+        source_buffer = source_buffer->next;
+    }
+    document->source_buffers = NULL;
+    document->section_table = NULL;
+    document->len_section_table = 0;
+}
+
+void cini_internal_forget_source_blocks(
+    CiniDocument *document
+) {
+    if (document->source_blocks)
+    {
+        document->fn_free(document->source_blocks, document->allocator);
+    }
+    document->source_blocks = NULL;
+    document->num_source_blocks = 0;
+}
+
 void cini_free_document(
     CiniDocument *document
 ) {
+    cini_internal_forget_source_blocks(document);
+    cini_free_source_buffers(document);
     cini_free_arena(document->arena);
     document->fn_free(document, document->allocator);
 }
 
+void cini_reset_document(
+    CiniDocument *document
+) {
+    if ( ! document)
+    {
+        return;
+    }
+    cini_internal_forget_source_blocks(document);
+    cini_free_source_buffers(document);
+    document->compiled = NULL;
+    document->is_frozen = false;
+    cini_rewind_arena(document->arena);
+    cini_internal_init_document_tree(document);
+
+    // Compiled queries resolve themselves again on their next use.
+
+    ++document->generation;
+}
+
+int_fast8_t cini_freeze(
+    CiniDocument *document
+) {
+    if ( ! document)
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if (document->is_frozen)
+    {
+        return CINI_SUCCESS;
+    }
+
+    // Loaded compiled documents are read from their image, which is
+    // read-only already.
+
+    if ( ! document->compiled)
+    {
+        cini_internal_update_section_table(document);
+        CiniSection *section = document->first_section;
+        while (section)
+        {
+            cini_internal_get_full_name(document, section);
+            CiniField *field = section->first_field;
+            while (field)
+            {
+                CiniField scratch;
+                cini_internal_get_decoded(field, &scratch);
+                cini_internal_read_text(document, field);
+                field = field->next_in_section;
+            }
+            section = section->linear_next;
+        }
+    }
+    document->is_frozen = true;
+    return CINI_SUCCESS;
+}
+
+void cini_set_parse_threads(
+    CiniDocument *document,
+    uint_fast32_t num_threads
+) {
+    if ( ! document)
+    {
+        return;
+    }
+    if (num_threads == 0)
+    {
+        long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = 1;
+        if (num_processors > 1)
+        {
+            num_threads = num_processors;
+        }
+    }
+    document->num_parse_threads = num_threads;
+}
+
+void cini_set_feature(
+    CiniDocument *document,
+    CiniFeature feature,
+    bool value
+) {
+    if (( ! document) || ( ! document->arena))
+    {
+        return;
+    }
+    bool was_enabled = (document->features & feature) != 0;
+    if (value)
+    {
+        document->features |= feature;
+    }
+    else
+    {
+        document->features &= ~((uint_fast32_t) feature);
+    }
+    if ((feature == CINI_FEATURE_LOG) && (value != was_enabled))
+    {
+        // The dropped log's memory is reclaimed when the document is
+        // reset, like everything else in the arena.
+
+        document->log_entries = NULL;
+        document->num_logged = 0;
+        if (value)
+        {
+            cini_internal_create_log(document);
+        }
+    }
+    if ((feature == CINI_FEATURE_PROFILING) && (value != was_enabled))
+    {
+        // Profiles start from zero whenever profiling is enabled.
+
+        document->profiler = NULL;
+        if (value)
+        {
+            memset(&document->profiler_state, 0, sizeof(CiniProfiler));
+            document->profiler = &document->profiler_state;
+        }
+        document->arena->profiler = document->profiler;
+    }
+}
+
@@ -0,0 +1,375 @@
+#include <cini/field.h>
+#include <cini/number.h>
+
+#include <stddef.h>
+#include <string.h>
+
+// ==> Field index
+
+void cini_internal_insert_field_slot(
+    CiniFieldSlot *slots,
+    uint_fast32_t capacity,
+    CiniField *field
+) {
+    uint_fast32_t mask = capacity - 1;
+    uint_fast32_t slot_index = field->key_hash & mask;
+    while (slots[slot_index].field)
+    {
+        slot_index = (slot_index + 1) & mask;
+    }
+    slots[slot_index].hash = field->key_hash;
+    slots[slot_index].field = field;
+}
+
+/// @brief Take a field out of an index without leaving a gap in the
+///        probe sequence of any other field. The fields behind it are
+///        moved back into the freed slot where their probing allows.
+void cini_internal_remove_field_slot(
+    CiniFieldSlot *slots,
+    uint_fast32_t capacity,
+    CiniField *field
+) {
+    uint_fast32_t mask = capacity - 1;
+    uint_fast32_t hole = field->key_hash & mask;
+    while (slots[hole].field != field)
+    {
+        hole = (hole + 1) & mask;
+    }
+    uint_fast32_t slot_index = (hole + 1) & mask;
+    while (slots[slot_index].field)
+    {
+        // A field may only move back to the hole if the hole lies
+        // between its home slot and the slot it is in.
+
+        uint_fast32_t home = slots[slot_index].hash & mask;
+        if (((slot_index - home) & mask) >= ((slot_index - hole) & mask))
+        {
+            slots[hole] = slots[slot_index];
+            hole = slot_index;
+        }
+        slot_index = (slot_index + 1) & mask;
+    }
+    slots[hole].hash = 0;
+    slots[hole].field = NULL;
+}
+
+/// @brief (Re-)Build a section's field index with enough slots to stay
+///        at most half full after the next insertion.
+void cini_internal_build_field_index(
+    CiniDocument *document,
+    CiniSection *section
+) {
+    uint_fast32_t capacity = 16;
+    while (capacity < ((section->num_fields + 1) * 2))
+    {
+        capacity *= 2;
+    }
+    document->len_abandoned_indexes +=
+        section->field_index_capacity * sizeof(CiniFieldSlot);
+    CiniFieldSlot *slots = cini_arena_alloc(
+        document->arena,
+        capacity * sizeof(CiniFieldSlot)
+    );
+    memset(slots, 0, capacity * sizeof(CiniFieldSlot));
+
+    CiniField *field = section->first_field;
+    while (field)
+    {
+        cini_internal_insert_field_slot(slots, capacity, field);
+        field = field->next_in_section;
+    }
+    section->field_index = slots;
+    section->field_index_capacity = capacity;
+}
+
+
+
+// ==> Field access
+
+CiniField * cini_internal_find_field(
+    CiniSection *section,
+    const char *key,
+    uint_fast32_t len_key,
+    uint32_t key_hash
+) {
+    if (section->field_index)
+    {
+        uint_fast32_t mask = section->field_index_capacity - 1;
+        uint_fast32_t slot_index = key_hash & mask;
+        while (true)
+        {
+            CiniFieldSlot *slot = &section->field_index[slot_index];
+            if ( ! slot->field)
+            {
+                return NULL;
+            }
+            if (
+                 (slot->hash == key_hash)
+              && (slot->field->len_key == len_key)
+              && ( ! memcmp(slot->field->key, key, len_key))
+            ) {
+                return slot->field;
+            }
+            slot_index = (slot_index + 1) & mask;
+        }
+    }
+
+    // Sections without an index have few fields, so this is bounded.
+
+    CiniField *field = section->first_field;
+    while (field)
+    {
+        if (
+             (field->key_hash == key_hash)
+          && (field->len_key == len_key)
+          && ( ! memcmp(field->key, key, len_key))
+        ) {
+            return field;
+        }
+        field = field->next_in_section;
+    }
+    return NULL;
+}
+
+CiniField * cini_internal_add_field(
+    CiniDocument *document,
+    CiniSection *section,
+    const char *key,
+    uint_fast32_t len_key,
+    bool copy_key,
+    const char *value,
+    uint_fast32_t len_value,
+    bool value_terminated
+) {
+    uint32_t key_hash = cini_hash_string(key, len_key);
+    CiniField *field = cini_internal_find_field(
+        section,
+        key,
+        len_key,
+        key_hash
+    );
+    if (field)
+    {
+        // Duplicate key; the last assignment wins.
+
+        field->value = value;
+        field->len_value = len_value;
+        field->applicable_types = CINI_UNKNOWN_VALUE;
+        field->decode_state = CINI_DECODE_PENDING;
+        field->flags = value_terminated ? CINI_FIELD_VALUE_TERMINATED : 0;
+        return field;
+    }
+
+    field = cini_arena_alloc(
+        document->arena,
+        sizeof(CiniField)
+    );
+    field->next_in_section = NULL;
+    field->applicable_types = CINI_UNKNOWN_VALUE;
+    field->decode_state = CINI_DECODE_PENDING;
+    field->flags = value_terminated ? CINI_FIELD_VALUE_TERMINATED : 0;
+    field->value_capacity = 0;
+    field->len_key = len_key;
+    field->len_value = len_value;
+    field->key_hash = key_hash;
+    field->key = key;
+    if (copy_key)
+    {
+        field->key = cini_arena_copy_slice(document->arena, key, len_key);
+    }
+    field->value = value;
+
+    if (section->last_field)
+    {
+        section->last_field->next_in_section = field;
+    }
+    else
+    {
+        section->first_field = field;
+    }
+    section->last_field = field;
+    ++section->num_fields;
+    ++document->num_values;
+
+    // Keep the index at most half full, or build it once the section
+    // has too many fields to search them linearly.
+
+    if (section->field_index)
+    {
+        if ((section->num_fields * 2) > section->field_index_capacity)
+        {
+            cini_internal_build_field_index(document, section);
+        }
+        else
+        {
+            cini_internal_insert_field_slot(
+                section->field_index,
+                section->field_index_capacity,
+                field
+            );
+        }
+    }
+    else if (section->num_fields > CINI_FIELD_INDEX_THRESHOLD)
+    {
+        cini_internal_build_field_index(document, section);
+    }
+    return field;
+}
+
+void cini_internal_remove_field(
+    CiniDocument *document,
+    CiniSection *section,
+    CiniField *field
+) {
+    if (section->field_index)
+    {
+        cini_internal_remove_field_slot(
+            section->field_index,
+            section->field_index_capacity,
+            field
+        );
+    }
+    CiniField *previous = NULL;
+    CiniField *current = section->first_field;
+    while (current != field)
+    {
+        previous = current;
+        current = current->next_in_section;
+    }
+    if (previous)
+    {
+        previous->next_in_section = field->next_in_section;
+    }
+    else
+    {
+        section->first_field = field->next_in_section;
+    }
+    if (section->last_field == field)
+    {
+        section->last_field = previous;
+    }
+    --section->num_fields;
+    --document->num_values;
+}
+
+
+
+
+// ==> Value decoding
+
+/// @brief Compare a value case-insensitively against a lowercase word.
+bool cini_internal_value_is(
+    const char *value,
+    uint_fast32_t len_value,
+    const char *word
+) {
+    uint_fast32_t len_word = strlen(word);
+    if (len_value != len_word)
+    {
+        return false;
+    }
+    for (uint_fast32_t index = 0; index < len_word; ++index)
+    {
+        char character = value[index];
+        if ((character >= 'A') && (character <= 'Z'))
+        {
+            character += 'a' - 'A';
+        }
+        if (character != word[index])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool cini_internal_decode_bool(
+    const char *value,
+    uint_fast32_t len_value,
+    bool *buffer
+) {
+    if (
+         cini_internal_value_is(value, len_value, "true")
+      || cini_internal_value_is(value, len_value, "yes")
+      || cini_internal_value_is(value, len_value, "on")
+      || cini_internal_value_is(value, len_value, "1")
+    ) {
+        *buffer = true;
+        return true;
+    }
+    if (
+         cini_internal_value_is(value, len_value, "false")
+      || cini_internal_value_is(value, len_value, "no")
+      || cini_internal_value_is(value, len_value, "off")
+      || cini_internal_value_is(value, len_value, "0")
+    ) {
+        *buffer = false;
+        return true;
+    }
+    return false;
+}
+
+void cini_internal_decode_value(
+    const char *value,
+    uint_fast32_t len_value,
+    CiniField *target
+) {
+    uint_fast16_t types = CINI_VALUE_STRING;
+    target->boolean = false;
+    target->integer = 0;
+    target->decimal = 0.0;
+    if (cini_internal_decode_bool(value, len_value, &target->boolean))
+    {
+        types |= CINI_VALUE_BOOLEAN;
+    }
+    if (cini_decode_integer(value, len_value, &target->integer))
+    {
+        types |= CINI_VALUE_INTEGER;
+    }
+    if (cini_decode_decimal(value, len_value, &target->decimal))
+    {
+        types |= CINI_VALUE_DECIMAL;
+    }
+    target->applicable_types = types;
+}
+
+const CiniField * cini_internal_get_decoded(
+    CiniField *field,
+    CiniField *scratch
+) {
+    uint8_t state = __atomic_load_n(&field->decode_state, __ATOMIC_ACQUIRE);
+    if (state == CINI_DECODE_DONE)
+    {
+        return field;
+    }
+    uint8_t expected = CINI_DECODE_PENDING;
+    if (
+        __atomic_compare_exchange_n(
+            &field->decode_state,
+            &expected,
+            CINI_DECODE_RUNNING,
+            false,
+            __ATOMIC_ACQUIRE,
+            __ATOMIC_ACQUIRE
+        )
+    ) {
+        cini_internal_decode_value(field->value, field->len_value, field);
+        __atomic_store_n(
+            &field->decode_state,
+            CINI_DECODE_DONE,
+            __ATOMIC_RELEASE
+        );
+        return field;
+    }
+    if (expected == CINI_DECODE_DONE)
+    {
+        return field;
+    }
+
+    // Another thread is decoding this field right now. Rather than
+    // waiting for it, decode into the caller's scratch field.
+
+    cini_internal_decode_value(field->value, field->len_value, scratch);
+    return scratch;
+}
+
@@ -0,0 +1,628 @@
+#include <cini/incremental.h>
+#include <cini/parser.h>
+#include <cini/section.h>
+#include <cini/utility.h>
+
+#include <string.h>
+
+/// @brief What a re-parse found out about a section, indexed by the
+///        section's position in the linear section list.
+typedef struct
+{
+    uint64_t old_digest;
+    uint64_t new_digest;
+    uint_fast32_t num_old_blocks;
+    uint_fast32_t num_new_blocks;
+    uint_fast32_t num_old_fields;
+
+    bool existed;
+    bool is_dirty;
+    bool is_modified;
+    bool is_visited;
+    bool needs_index_refill;
+
+} CiniSectionDiff;
+
+/// @brief Slot of the hash index over the previous source's blocks.
+typedef struct
+{
+    uint64_t hash;
+    CiniSection *section;
+
+} CiniBlockSlot;
+
+
+
+// ==> Blocks
+
+/// @brief Split a source into blocks which begin with a section header
+///        line, with the range in front of the first header as the
+///        first block. Headers may be indented, like the parser allows.
+/// @return
+/// Whether the block table could be allocated.
+bool cini_internal_split_blocks(
+    CiniDocument *document,
+    const char *source,
+    uint_fast32_t len_source,
+    CiniSourceBlock **blocks,
+    uint_fast32_t *num_blocks
+) {
+    uint_fast32_t capacity = 64;
+    CiniSourceBlock *table = document->fn_alloc(
+        capacity * sizeof(CiniSourceBlock),
+        document->allocator
+    );
+    if ( ! table)
+    {
+        return false;
+    }
+    // A header at the very start leaves the first block empty.
+
+    uint_fast32_t count = 1;
+    table[0].offset = 0;
+
+    // Brackets are rare outside of headers, so searching for them and
+    // looking back to the line's start is cheaper than visiting every
+    // line.
+
+    uint_fast32_t offset = 0;
+    while (offset < len_source)
+    {
+        const char *bracket = memchr(
+            &source[offset],
+            '[',
+            len_source - offset
+        );
+        if ( ! bracket)
+        {
+            break;
+        }
+        offset = bracket - source;
+        uint_fast32_t line_start = offset;
+        while (
+             (line_start > 0)
+          && (
+                 (source[line_start - 1] == ' ')
+              || (source[line_start - 1] == '\t')
+             )
+        ) {
+            --line_start;
+        }
+        ++offset;
+        if ((line_start > 0) && (source[line_start - 1] != '\n'))
+        {
+            continue;
+        }
+        if (count == capacity)
+        {
+            CiniSourceBlock *grown = document->fn_alloc(
+                capacity * 2 * sizeof(CiniSourceBlock),
+                document->allocator
+            );
+            if ( ! grown)
+            {
+                document->fn_free(table, document->allocator);
+                return false;
+            }
+            memcpy(grown, table, capacity * sizeof(CiniSourceBlock));
+            document->fn_free(table, document->allocator);
+            table = grown;
+            capacity *= 2;
+        }
+        table[count].offset = line_start;
+        ++count;
+    }
+
+    uint_fast32_t block_index = 0;
+    while (block_index < count)
+    {
+        uint_fast32_t end = len_source;
+        if ((block_index + 1) < count)
+        {
+            end = table[block_index + 1].offset;
+        }
+        CiniSourceBlock *block = &table[block_index];
+        block->length = end - block->offset;
+        block->hash = cini_hash_bytes(&source[block->offset], block->length);
+        block->section = NULL;
+        ++block_index;
+    }
+    *blocks = table;
+    *num_blocks = count;
+    return true;
+}
+
+/// @brief Find the section of a block of the previous source by the
+///        block's hash. Equal blocks begin with the same header.
+CiniSection * cini_internal_find_block_section(
+    const CiniBlockSlot *slots,
+    uint_fast32_t capacity,
+    uint64_t hash
+) {
+    uint_fast32_t mask = capacity - 1;
+    uint_fast32_t slot_index = hash & mask;
+    while (slots[slot_index].section)
+    {
+        if (slots[slot_index].hash == hash)
+        {
+            return slots[slot_index].section;
+        }
+        slot_index = (slot_index + 1) & mask;
+    }
+    return NULL;
+}
+
+/// @brief Find the section which each new block belongs to. Blocks which
+///        also were in the previous source keep their section; the
+///        header lines of the others are parsed, which creates the
+///        sections that didn't exist before.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_internal_resolve_block_sections(
+    CiniDocument *document,
+    const char *source,
+    CiniSourceBlock *blocks,
+    uint_fast32_t num_blocks
+) {
+    uint_fast32_t capacity = 16;
+    while (capacity < (document->num_source_blocks * 2))
+    {
+        capacity *= 2;
+    }
+    CiniBlockSlot *slots = document->fn_alloc(
+        capacity * sizeof(CiniBlockSlot),
+        document->allocator
+    );
+    if ( ! slots)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    memset(slots, 0, capacity * sizeof(CiniBlockSlot));
+    uint_fast32_t block_index = 0;
+    while (block_index < document->num_source_blocks)
+    {
+        const CiniSourceBlock *block = &document->source_blocks[block_index];
+        uint_fast32_t slot_index = block->hash & (capacity - 1);
+        while (
+             slots[slot_index].section
+          && (slots[slot_index].hash != block->hash)
+        ) {
+            slot_index = (slot_index + 1) & (capacity - 1);
+        }
+        slots[slot_index].hash = block->hash;
+        slots[slot_index].section = block->section;
+        ++block_index;
+    }
+
+    int_fast8_t status = CINI_SUCCESS;
+    blocks[0].section = document->root_section;
+    block_index = 1;
+    while ((status == CINI_SUCCESS) && (block_index < num_blocks))
+    {
+        CiniSourceBlock *block = &blocks[block_index];
+        block->section = cini_internal_find_block_section(
+            slots,
+            capacity,
+            block->hash
+        );
+        if ( ! block->section)
+        {
+            const char *header = &source[block->offset];
+            const char *line_end = memchr(header, '\n', block->length);
+            uint_fast32_t len_header = block->length;
+            if (line_end)
+            {
+                len_header = line_end - header;
+            }
+            block->section = cini_internal_parse_header_line(
+                document,
+                header,
+                len_header,
+                &status
+            );
+        }
+        ++block_index;
+    }
+    document->fn_free(slots, document->allocator);
+    return status;
+}
+
+
+
+// ==> Restructuring
+
+/// @brief Append a section and, before it, every superordinate section
+///        which isn't in place yet, to the rebuilt section tree.
+void cini_internal_visit_section(
+    CiniDocument *document,
+    CiniSectionDiff *diffs,
+    CiniSection *section
+) {
+    CiniSectionDiff *diff = &diffs[section->linear_index];
+    if (diff->is_visited)
+    {
+        return;
+    }
+    cini_internal_visit_section(document, diffs, section->parent);
+    diff->is_visited = true;
+
+    CiniSection *parent = section->parent;
+    parent->sub_sections[parent->num_sub_sections] = section;
+    ++parent->num_sub_sections;
+    section->linear_next = NULL;
+    document->last_section->linear_next = section;
+    document->last_section = section;
+    ++document->num_sections;
+}
+
+/// @brief Rebuild the linear section list and the sub-section lists in
+///        the order in which a serial parse of the new source would
+///        create the sections. Sections without any block left, which
+///        also aren't superordinate to one, are dropped.
+void cini_internal_rebuild_section_tree(
+    CiniDocument *document,
+    CiniSection **sections,
+    CiniSectionDiff *diffs,
+    uint_fast32_t num_sections,
+    const CiniSourceBlock *blocks,
+    uint_fast32_t num_blocks
+) {
+    uint_fast32_t section_index = 0;
+    while (section_index < num_sections)
+    {
+        sections[section_index]->num_sub_sections = 0;
+        diffs[section_index].is_visited = false;
+        ++section_index;
+    }
+    CiniSection *root = document->root_section;
+    diffs[root->linear_index].is_visited = true;
+    root->linear_next = NULL;
+    document->last_section = root;
+    document->num_sections = 1;
+
+    uint_fast32_t block_index = 0;
+    while (block_index < num_blocks)
+    {
+        cini_internal_visit_section(
+            document,
+            diffs,
+            blocks[block_index].section
+        );
+        ++block_index;
+    }
+
+    // Sections which were dropped must leave their parents' indexes.
+
+    section_index = 0;
+    while (section_index < num_sections)
+    {
+        CiniSection *section = sections[section_index];
+        if ( ! diffs[section_index].is_visited)
+        {
+            diffs[section->parent->linear_index].needs_index_refill = true;
+        }
+        ++section_index;
+    }
+    section_index = 0;
+    while (section_index < num_sections)
+    {
+        if (
+             diffs[section_index].is_visited
+          && diffs[section_index].needs_index_refill
+        ) {
+            cini_internal_refill_sub_section_index(sections[section_index]);
+        }
+        ++section_index;
+    }
+    document->section_table = NULL;
+    document->len_section_table = 0;
+}
+
+void cini_internal_report_changes(
+    CiniDocument *document,
+    CiniSection **sections,
+    CiniSectionDiff *diffs,
+    uint_fast32_t num_sections,
+    CiniChangeFn fn_change,
+    void *userdata
+) {
+    CiniSection *section = document->first_section;
+    while (section)
+    {
+        CiniSectionDiff *diff = &diffs[section->linear_index];
+        if (( ! diff->existed) || diff->is_modified)
+        {
+            fn_change(
+                cini_internal_get_full_name(document, section),
+                diff->existed ? CINI_SECTION_MODIFIED : CINI_SECTION_ADDED,
+                userdata
+            );
+        }
+        section = section->linear_next;
+    }
+    uint_fast32_t section_index = 0;
+    while (section_index < num_sections)
+    {
+        if ( ! diffs[section_index].is_visited)
+        {
+            fn_change(
+                cini_internal_get_full_name(document, sections[section_index]),
+                CINI_SECTION_REMOVED,
+                userdata
+            );
+        }
+        ++section_index;
+    }
+}
+
+
+
+// ==> Re-parsing
+
+/// @brief Fold a block's hash into the digest of a section's blocks.
+uint64_t cini_internal_fold_block_hash(
+    uint64_t digest,
+    uint64_t hash
+) {
+    const uint64_t multiplier = 0x9e3779b97f4a7c15;
+    digest = (digest ^ hash) * multiplier;
+    return digest ^ (digest >> 29);
+}
+
+/// @brief Update the document from the blocks of a new source, whose
+///        sections are already resolved.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_internal_apply_blocks(
+    CiniDocument *document,
+    const char *source,
+    const CiniSourceBlock *blocks,
+    uint_fast32_t num_blocks,
+    uint_fast32_t num_old_sections,
+    CiniChangeFn fn_change,
+    void *userdata
+) {
+    uint_fast32_t num_sections = document->num_sections;
+    CiniSection **sections = document->fn_alloc(
+        num_sections * sizeof(CiniSection *),
+        document->allocator
+    );
+    CiniSectionDiff *diffs = document->fn_alloc(
+        num_sections * sizeof(CiniSectionDiff),
+        document->allocator
+    );
+    if (( ! sections) || ( ! diffs))
+    {
+        if (sections)
+        {
+            document->fn_free(sections, document->allocator);
+        }
+        if (diffs)
+        {
+            document->fn_free(diffs, document->allocator);
+        }
+        return CINI_ALLOCATION_FAILURE;
+    }
+    memset(diffs, 0, num_sections * sizeof(CiniSectionDiff));
+
+    bool is_tracked = document->source_blocks != NULL;
+    uint_fast32_t section_index = 0;
+    CiniSection *section = document->first_section;
+    while (section)
+    {
+        section->linear_index = section_index;
+        sections[section_index] = section;
+        diffs[section_index].existed = section_index < num_old_sections;
+        ++section_index;
+        section = section->linear_next;
+    }
+
+    // Compare the sequences of block hashes of every section. Without
+    // the previous source's blocks, every section has to be rebuilt.
+
+    bool is_restructured = ( ! is_tracked)
+        || (num_sections != num_old_sections)
+        || (num_blocks != document->num_source_blocks);
+    uint_fast32_t block_index = 0;
+    while (block_index < document->num_source_blocks)
+    {
+        const CiniSourceBlock *block = &document->source_blocks[block_index];
+        CiniSectionDiff *diff = &diffs[block->section->linear_index];
+        diff->old_digest = cini_internal_fold_block_hash(
+            diff->old_digest,
+            block->hash
+        );
+        ++diff->num_old_blocks;
+        if (
+             (block_index < num_blocks)
+          && (blocks[block_index].section != block->section)
+        ) {
+            is_restructured = true;
+        }
+        ++block_index;
+    }
+    block_index = 0;
+    while (block_index < num_blocks)
+    {
+        const CiniSourceBlock *block = &blocks[block_index];
+        CiniSectionDiff *diff = &diffs[block->section->linear_index];
+        diff->new_digest = cini_internal_fold_block_hash(
+            diff->new_digest,
+            block->hash
+        );
+        ++diff->num_new_blocks;
+        ++block_index;
+    }
+
+    section_index = 0;
+    while (section_index < num_sections)
+    {
+        CiniSectionDiff *diff = &diffs[section_index];
+        diff->is_dirty = (diff->existed && ( ! is_tracked))
+            || (diff->old_digest != diff->new_digest)
+            || (diff->num_old_blocks != diff->num_new_blocks);
+        if (diff->is_dirty)
+        {
+            section = sections[section_index];
+            diff->num_old_fields = section->num_fields;
+            document->num_values -= section->num_fields;
+            section->first_field = NULL;
+            section->last_field = NULL;
+            section->num_fields = 0;
+            document->len_abandoned_indexes +=
+                section->field_index_capacity * sizeof(CiniFieldSlot);
+            section->field_index_capacity = 0;
+            section->field_index = NULL;
+        }
+        ++section_index;
+    }
+
+    // Re-parse every block of the changed sections, in source order, so
+    // that duplicate keys resolve like in a serial parse.
+
+    int_fast8_t status = CINI_SUCCESS;
+    block_index = 0;
+    while ((status == CINI_SUCCESS) && (block_index < num_blocks))
+    {
+        const CiniSourceBlock *block = &blocks[block_index];
+        if (diffs[block->section->linear_index].is_dirty)
+        {
+            status = cini_internal_parse_serially(
+                document,
+                &source[block->offset],
+                block->length,
+                false
+            );
+        }
+        ++block_index;
+    }
+
+    if (status == CINI_SUCCESS)
+    {
+        if (is_restructured)
+        {
+            cini_internal_rebuild_section_tree(
+                document,
+                sections,
+                diffs,
+                num_sections,
+                blocks,
+                num_blocks
+            );
+        }
+        else
+        {
+            section_index = 0;
+            while (section_index < num_sections)
+            {
+                diffs[section_index].is_visited = true;
+                ++section_index;
+            }
+        }
+
+        // Without the previous source's blocks, a re-parsed section is
+        // only known to have changed if it has fields before or after.
+
+        section_index = 0;
+        while (section_index < num_sections)
+        {
+            CiniSectionDiff *diff = &diffs[section_index];
+            diff->is_modified = diff->is_dirty
+                && (
+                       is_tracked
+                    || (diff->num_old_fields > 0)
+                    || (sections[section_index]->num_fields > 0)
+                   );
+            ++section_index;
+        }
+        if (fn_change)
+        {
+            cini_internal_report_changes(
+                document,
+                sections,
+                diffs,
+                num_sections,
+                fn_change,
+                userdata
+            );
+        }
+    }
+    document->fn_free(sections, document->allocator);
+    document->fn_free(diffs, document->allocator);
+    return status;
+}
+
+int_fast8_t cini_reparse_source(
+    CiniDocument *document,
+    const char *source,
+    uint_fast32_t len_source,
+    CiniChangeFn fn_change,
+    void *userdata
+) {
+    // Validate arguments
+
+    if (( ! document) || ( ! source))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if ( ! document->root_section)
+    {
+        return CINI_NOT_INITIALIZED;
+    }
+    if (document->is_frozen)
+    {
+        return CINI_DOCUMENT_FROZEN;
+    }
+
+    CiniSourceBlock *blocks = NULL;
+    uint_fast32_t num_blocks = 0;
+    if ( ! cini_internal_split_blocks(
+        document,
+        source,
+        len_source,
+        &blocks,
+        &num_blocks
+    )) {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    ++document->generation;
+
+    uint_fast32_t num_old_sections = document->num_sections;
+    int_fast8_t status = cini_internal_resolve_block_sections(
+        document,
+        source,
+        blocks,
+        num_blocks
+    );
+    if (status == CINI_SUCCESS)
+    {
+        status = cini_internal_apply_blocks(
+            document,
+            source,
+            blocks,
+            num_blocks,
+            num_old_sections,
+            fn_change,
+            userdata
+        );
+    }
+    if (status != CINI_SUCCESS)
+    {
+        // The document may be half updated; parse the source as a whole
+        // so that it holds what a serial parse would.
+
+        document->fn_free(blocks, document->allocator);
+        cini_reset_document(document);
+        return cini_internal_parse_serially(
+            document,
+            source,
+            len_source,
+            false
+        );
+    }
+    cini_internal_forget_source_blocks(document);
+    document->source_blocks = blocks;
+    document->num_source_blocks = num_blocks;
+    return CINI_SUCCESS;
+}
+
@@ -0,0 +1,109 @@
+#include <cini/log.h>
+
+#include <stddef.h>
+
+// ==> Messages
+
+const char * cini_internal_describe_log_message(
+    CiniLogMessage message
+) {
+    switch (message)
+    {
+        case CINI_LOG_INVALID_UTF8:
+            return "Invalid Encoding: The source isn't valid UTF-8.";
+        case CINI_LOG_QUOTED_SECTION_NAME:
+            return "Limitation Exceeded: "
+                "String encapsulations aren't supported yet";
+        case CINI_LOG_EMPTY_PATH_LINK:
+            return "Syntax Error: Empty part in section name.";
+        case CINI_LOG_EMPTY_SECTION_HEADER:
+            return "Syntax Error: Empty section header.";
+        case CINI_LOG_SECTION_PATH_TOO_DEEP:
+            return "Limitation Exceeded: Section path is too deep.";
+        case CINI_LOG_UNCLOSED_SECTION_HEADER:
+            return "Syntax Error: Section header not closed.";
+        case CINI_LOG_CHARACTERS_AFTER_HEADER:
+            return "Syntax Error: "
+                "Unexpected characters after section header.";
+        case CINI_LOG_MISSING_EQUALS_SIGN:
+            return "Syntax Error: Expected an equals sign after the key.";
+        case CINI_LOG_QUOTED_KEY:
+            return "Limitation Exceeded: "
+                "String encapsulations aren't supported yet";
+        case CINI_LOG_MISSING_KEY:
+            return "Syntax Error: Field without a key.";
+        case CINI_LOG_KEY_TOO_LONG:
+            return "Limitation Exceeded: Key is too long.";
+        case CINI_LOG_UNCLOSED_QUOTED_VALUE:
+            return "Syntax Error: Quoted value not closed.";
+        case CINI_LOG_CHARACTERS_AFTER_VALUE:
+            return "Syntax Error: Unexpected characters after quoted value.";
+    }
+    return "Unknown message.";
+}
+
+
+
+// ==> Ring
+
+void cini_internal_create_log(
+    CiniDocument *document
+) {
+    document->log_entries = cini_arena_alloc(
+        document->arena,
+        CINI_LOG_CAPACITY * sizeof(CiniLogEntry)
+    );
+    document->num_logged = 0;
+}
+
+void cini_internal_append_log(
+    CiniDocument *document,
+    CiniLogEntry *entry
+) {
+    entry->text = cini_internal_describe_log_message(entry->message);
+    uint_fast32_t slot_index = document->num_logged % CINI_LOG_CAPACITY;
+    document->log_entries[slot_index] = *entry;
+    ++document->num_logged;
+}
+
+const char * cini_get_log(
+    CiniDocument *document
+) {
+    if (
+         ( ! document)
+      || ( ! document->log_entries)
+      || (document->num_logged == 0)
+    ) {
+        return NULL;
+    }
+    uint_fast32_t slot_index = (document->num_logged - 1) % CINI_LOG_CAPACITY;
+    return document->log_entries[slot_index].text;
+}
+
+int_fast32_t cini_get_log_entry(
+    CiniDocument *document,
+    uint_fast32_t index,
+    CiniLogEntry *entry
+) {
+    if ( ! document)
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if ( ! document->log_entries)
+    {
+        return 0;
+    }
+    uint_fast32_t num_entries = document->num_logged;
+    if (num_entries > CINI_LOG_CAPACITY)
+    {
+        num_entries = CINI_LOG_CAPACITY;
+    }
+    if (entry && (index < num_entries))
+    {
+        uint_fast32_t slot_index = (document->num_logged - num_entries)
+            + index;
+        *entry = document->log_entries[slot_index % CINI_LOG_CAPACITY];
+    }
+    return num_entries;
+}
+
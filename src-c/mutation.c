@@ -0,0 +1,420 @@
+#include <cini/field.h>
+#include <cini/mutation.h>
+#include <cini/query.h>
+#include <cini/section.h>
+
+#include <string.h>
+
+// ==> Checks
+
+/// @return
+/// `CINI_SUCCESS` if the document may be changed, otherwise the reason
+/// why it can't be.
+int_fast8_t cini_internal_check_mutable(
+    CiniDocument *document
+) {
+    if ( ! document->arena)
+    {
+        return CINI_NOT_INITIALIZED;
+    }
+    if (document->is_frozen || document->compiled)
+    {
+        return CINI_DOCUMENT_FROZEN;
+    }
+    return CINI_SUCCESS;
+}
+
+/// @brief Check whether a key would be read back as the same key if
+///        the document was written as INI text.
+bool cini_internal_is_writable_key(
+    const char *key,
+    uint_fast32_t len_key
+) {
+    if ((len_key == 0) || (len_key > UINT16_MAX))
+    {
+        return false;
+    }
+    if (
+         cini_is_whitespace(key[0])
+      || cini_is_whitespace(key[len_key - 1])
+      || (key[0] == '[')
+      || (key[0] == ';')
+      || (key[0] == '#')
+    ) {
+        return false;
+    }
+    for (uint_fast32_t offset = 0; offset < len_key; ++offset)
+    {
+        char character = key[offset];
+        if (
+             (character == '=')
+          || (character == '"')
+          || (character == '\n')
+          || (character == '\r')
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/// @brief Check whether a link of a section path would be read back as
+///        the same link if the document was written as INI text.
+bool cini_internal_is_writable_path_link(
+    const char *link,
+    uint_fast32_t len_link
+) {
+    for (uint_fast32_t offset = 0; offset < len_link; ++offset)
+    {
+        char character = link[offset];
+        if (
+             (character == '[')
+          || (character == ']')
+          || (character == '=')
+          || (character == ';')
+          || (character == '#')
+          || (character == '"')
+          || (character == ':')
+          || (character == '\n')
+          || (character == '\r')
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+// ==> Setting
+
+/// @brief Find a section by a path string like `a.b.c`, creating the
+///        levels of it which don't exist yet.
+/// @return
+/// The section or `NULL` if the path is malformed or has a link which
+/// couldn't be written as INI text.
+CiniSection * cini_internal_create_section_path(
+    CiniDocument *document,
+    const char *path,
+    uint_fast32_t len_path
+) {
+    // The whole path is checked first, so that a bad link doesn't leave
+    // the levels in front of it behind.
+
+    uint_fast32_t offset = 0;
+    CiniSlice link;
+    while (true)
+    {
+        int_fast8_t status = cini_next_path_link(
+            path,
+            &offset,
+            len_path,
+            &link
+        );
+        if (status < 0)
+        {
+            return NULL;
+        }
+        if (status == 0)
+        {
+            break;
+        }
+        if ( ! cini_internal_is_writable_path_link(link.string, link.length))
+        {
+            return NULL;
+        }
+    }
+
+    CiniSection *section = document->root_section;
+    offset = 0;
+    while (true)
+    {
+        int_fast8_t status = cini_next_path_link(
+            path,
+            &offset,
+            len_path,
+            &link
+        );
+        if (status < 0)
+        {
+            return NULL;
+        }
+        if (status == 0)
+        {
+            break;
+        }
+        uint32_t link_hash = cini_hash_string(link.string, link.length);
+        CiniSection *sub_section = cini_internal_find_sub_section(
+            document,
+            section,
+            link.string,
+            link.length,
+            link_hash
+        );
+        if ( ! sub_section)
+        {
+            sub_section = cini_internal_add_sub_section(
+                document,
+                section,
+                cini_arena_copy_slice(
+                    document->arena,
+                    link.string,
+                    link.length
+                ),
+                link.length,
+                link_hash
+            );
+        }
+        section = sub_section;
+    }
+    return section;
+}
+
+/// @brief Replace a field's value, writing over the field's own copy of
+///        its previous value if that is long enough. The cached decodes
+///        are dropped.
+void cini_internal_store_value(
+    CiniDocument *document,
+    CiniField *field,
+    const char *text,
+    uint_fast32_t len_text
+) {
+    if (
+         (field->flags & CINI_FIELD_VALUE_OWNED)
+      && (len_text <= field->value_capacity)
+    ) {
+        char *value = (char *) field->value;
+        memcpy(value, text, len_text);
+        value[len_text] = 0;
+    }
+    else
+    {
+        field->value = cini_arena_copy_slice(
+            document->arena,
+            text,
+            len_text
+        );
+        field->value_capacity = len_text;
+    }
+    field->len_value = len_text;
+    field->flags = CINI_FIELD_VALUE_TERMINATED | CINI_FIELD_VALUE_OWNED;
+    field->applicable_types = CINI_UNKNOWN_VALUE;
+    field->decode_state = CINI_DECODE_PENDING;
+}
+
+/// @brief Set the value of the field a query refers to, creating the
+///        field and its section if necessary.
+/// @param field
+///        Pointer to where to put the field which was set.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_internal_set_value(
+    CiniDocument *document,
+    const char *query,
+    const char *text,
+    uint_fast32_t len_text,
+    CiniField **field
+) {
+    int_fast8_t status = cini_internal_check_mutable(document);
+    if (status != CINI_SUCCESS)
+    {
+        return status;
+    }
+
+    // Setting an existing key costs one lookup, like reading it.
+
+    uint_fast32_t len_query = strlen(query);
+    CiniStatus lookup_status = CINI_SUCCESS;
+    CiniSection *section = NULL;
+    CiniField scratch;
+    *field = cini_internal_resolve_query(
+        document,
+        query,
+        len_query,
+        &section,
+        &lookup_status,
+        &scratch
+    );
+    if ( ! *field)
+    {
+        uint_fast32_t key_start = len_query;
+        while ((key_start > 0) && (query[key_start - 1] != ':'))
+        {
+            --key_start;
+        }
+        uint_fast32_t len_key = len_query - key_start;
+        if ( ! cini_internal_is_writable_key(&query[key_start], len_key))
+        {
+            return CINI_SYNTAX_ERROR;
+        }
+        if ( ! section)
+        {
+            section = cini_internal_create_section_path(
+                document,
+                query,
+                (key_start > 1) ? (key_start - 1) : 0
+            );
+            if ( ! section)
+            {
+                return CINI_SYNTAX_ERROR;
+            }
+        }
+        *field = cini_internal_add_field(
+            document,
+            section,
+            &query[key_start],
+            len_key,
+            true,
+            "",
+            0,
+            true
+        );
+
+        // Compiled queries which didn't find the key resolve themselves
+        // again on their next use.
+
+        ++document->generation;
+    }
+    cini_internal_forget_source_blocks(document);
+    cini_internal_store_value(document, *field, text, len_text);
+    return CINI_SUCCESS;
+}
+
+int_fast8_t cini_set_text(
+    CiniDocument *document,
+    const char *query,
+    const char *text
+) {
+    if (( ! document) || ( ! query) || ( ! text))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniField *field = NULL;
+    return cini_internal_set_value(
+        document,
+        query,
+        text,
+        strlen(text),
+        &field
+    );
+}
+
+int_fast8_t cini_set_int(
+    CiniDocument *document,
+    const char *query,
+    int64_t value
+) {
+    if (( ! document) || ( ! query))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    char digits[CINI_MAX_INTEGER_TEXT];
+    uint_fast32_t offset = CINI_MAX_INTEGER_TEXT - 1;
+    digits[offset] = 0;
+    uint64_t magnitude = value;
+    if (value < 0)
+    {
+        magnitude = -magnitude;
+    }
+    do
+    {
+        --offset;
+        digits[offset] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    }
+    while (magnitude > 0);
+    if (value < 0)
+    {
+        --offset;
+        digits[offset] = '-';
+    }
+
+    CiniField *field = NULL;
+    uint_fast32_t len_digits = (CINI_MAX_INTEGER_TEXT - 1) - offset;
+    int_fast8_t status = cini_internal_set_value(
+        document,
+        query,
+        &digits[offset],
+        len_digits,
+        &field
+    );
+    if (status != CINI_SUCCESS)
+    {
+        return status;
+    }
+
+    // The digits are decoded right away, which is cheap as long as they
+    // are at hand, so that reading the value back needn't decode it.
+
+    cini_internal_decode_value(field->value, len_digits, field);
+    field->decode_state = CINI_DECODE_DONE;
+    return CINI_SUCCESS;
+}
+
+
+
+// ==> Removal
+
+int_fast8_t cini_remove_key(
+    CiniDocument *document,
+    const char *query
+) {
+    if (( ! document) || ( ! query))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    int_fast8_t status = cini_internal_check_mutable(document);
+    if (status != CINI_SUCCESS)
+    {
+        return status;
+    }
+    CiniStatus lookup_status = CINI_SUCCESS;
+    CiniSection *section = NULL;
+    CiniField scratch;
+    CiniField *field = cini_internal_resolve_query(
+        document,
+        query,
+        strlen(query),
+        &section,
+        &lookup_status,
+        &scratch
+    );
+    if ( ! field)
+    {
+        return lookup_status;
+    }
+    cini_internal_remove_field(document, section, field);
+    cini_internal_forget_source_blocks(document);
+    ++document->generation;
+    return CINI_SUCCESS;
+}
+
+int_fast8_t cini_remove_section(
+    CiniDocument *document,
+    const char *section
+) {
+    if (( ! document) || ( ! section))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    int_fast8_t status = cini_internal_check_mutable(document);
+    if (status != CINI_SUCCESS)
+    {
+        return status;
+    }
+    CiniSection *removed = cini_internal_resolve_section(
+        document,
+        section,
+        strlen(section)
+    );
+    if (( ! removed) || ( ! removed->parent))
+    {
+        return CINI_SECTION_NONEXISTENT;
+    }
+    cini_internal_remove_section(document, removed);
+    cini_internal_forget_source_blocks(document);
+    ++document->generation;
+    return CINI_SUCCESS;
+}
+
@@ -0,0 +1,486 @@
+#define _GNU_SOURCE
+
+#include <cini/number.h>
+
+#include <errno.h>
+#include <locale.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ==> Digits
+
+/// @brief Get the value of a digit in any base up to 16.
+/// @return
+/// The digit's value or 16 if the character isn't a digit.
+uint_fast8_t cini_internal_digit_value(
+    char character
+) {
+    if ((character >= '0') && (character <= '9'))
+    {
+        return character - '0';
+    }
+    if ((character >= 'a') && (character <= 'f'))
+    {
+        return character - 'a' + 10;
+    }
+    if ((character >= 'A') && (character <= 'F'))
+    {
+        return character - 'A' + 10;
+    }
+    return 16;
+}
+
+/// @brief Check whether an underscore at an offset separates two digits
+///        of a base, which is the only place where it may appear.
+bool cini_internal_is_digit_separator(
+    const char *value,
+    uint_fast32_t len_value,
+    uint_fast32_t offset,
+    uint_fast8_t base
+) {
+    return (value[offset] == '_')
+        && (offset > 0)
+        && ((offset + 1) < len_value)
+        && (cini_internal_digit_value(value[offset - 1]) < base)
+        && (cini_internal_digit_value(value[offset + 1]) < base);
+}
+
+/// @brief Read the base prefix of an integer, if there is one.
+/// @return
+/// The base, or zero if the value has no prefix and is decimal.
+uint_fast8_t cini_internal_read_base_prefix(
+    const char *value,
+    uint_fast32_t len_value,
+    uint_fast32_t *offset
+) {
+    if (((*offset + 2) > len_value) || (value[*offset] != '0'))
+    {
+        return 0;
+    }
+    uint_fast8_t base = 0;
+    switch (value[*offset + 1])
+    {
+        case 'x':
+        case 'X':
+            base = 16;
+            break;
+        case 'o':
+        case 'O':
+            base = 8;
+            break;
+        case 'b':
+        case 'B':
+            base = 2;
+            break;
+        default:
+            return 0;
+    }
+    *offset += 2;
+    return base;
+}
+
+
+
+// ==> Integers
+
+/// @brief Accumulate the digits of an unsigned integer.
+/// @return
+/// Whether the digits reach the end of the value and the number fits
+/// into 64 bits.
+bool cini_internal_decode_magnitude(
+    const char *value,
+    uint_fast32_t len_value,
+    uint_fast32_t offset,
+    uint_fast8_t base,
+    uint64_t *magnitude
+) {
+    if (offset >= len_value)
+    {
+        return false;
+    }
+    uint64_t accumulated = 0;
+    for (; offset < len_value; ++offset)
+    {
+        uint_fast8_t digit = cini_internal_digit_value(value[offset]);
+        if (digit >= base)
+        {
+            if (cini_internal_is_digit_separator(
+                value,
+                len_value,
+                offset,
+                base
+            )) {
+                continue;
+            }
+            return false;
+        }
+        if (
+             __builtin_mul_overflow(accumulated, base, &accumulated)
+          || __builtin_add_overflow(accumulated, digit, &accumulated)
+        ) {
+            return false;
+        }
+    }
+    *magnitude = accumulated;
+    return true;
+}
+
+bool cini_decode_integer(
+    const char *value,
+    uint_fast32_t len_value,
+    int64_t *buffer
+) {
+    uint_fast32_t offset = 0;
+    bool negative = false;
+    if ((len_value > 0) && ((value[0] == '-') || (value[0] == '+')))
+    {
+        negative = value[0] == '-';
+        ++offset;
+    }
+    uint_fast8_t base = cini_internal_read_base_prefix(
+        value,
+        len_value,
+        &offset
+    );
+    if (base == 0)
+    {
+        base = 10;
+    }
+    uint64_t magnitude;
+    if ( ! cini_internal_decode_magnitude(
+        value,
+        len_value,
+        offset,
+        base,
+        &magnitude
+    )) {
+        return false;
+    }
+    if (negative)
+    {
+        if (magnitude > ((uint64_t) INT64_MAX + 1))
+        {
+            return false;
+        }
+        *buffer = (int64_t) (0 - magnitude);
+        return true;
+    }
+    if (magnitude > INT64_MAX)
+    {
+        return false;
+    }
+    *buffer = magnitude;
+    return true;
+}
+
+
+
+// ==> Floating point numbers
+
+// Longest decimal number which is converted on the slow path.
+#define CINI_MAX_DECIMAL_LENGTH 767
+
+// Powers of ten which are exactly representable as doubles.
+static const double cini_exact_powers_of_ten[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/// @brief Get the "C" locale, which makes the slow path independent of
+///        the process' locale. It is created once and shared.
+locale_t cini_internal_get_c_locale()
+{
+    static locale_t shared_locale = (locale_t) 0;
+    locale_t c_locale = __atomic_load_n(&shared_locale, __ATOMIC_ACQUIRE);
+    if (c_locale)
+    {
+        return c_locale;
+    }
+    c_locale = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+    if ( ! c_locale)
+    {
+        return (locale_t) 0;
+    }
+    locale_t expected = (locale_t) 0;
+    if ( ! __atomic_compare_exchange_n(
+        &shared_locale,
+        &expected,
+        c_locale,
+        false,
+        __ATOMIC_ACQ_REL,
+        __ATOMIC_ACQUIRE
+    )) {
+        freelocale(c_locale);
+        return expected;
+    }
+    return c_locale;
+}
+
+/// @brief Match `inf`, `infinity` and `nan`, ignoring case.
+bool cini_internal_decode_special(
+    const char *value,
+    uint_fast32_t len_value,
+    double *buffer
+) {
+    char lowercase[8];
+    if ((len_value != 3) && (len_value != 8))
+    {
+        return false;
+    }
+    for (uint_fast32_t index = 0; index < len_value; ++index)
+    {
+        lowercase[index] = value[index] | 0x20;
+    }
+    if (
+         ((len_value == 3) && ( ! memcmp(lowercase, "inf", 3)))
+      || ((len_value == 8) && ( ! memcmp(lowercase, "infinity", 8)))
+    ) {
+        *buffer = INFINITY;
+        return true;
+    }
+    if ((len_value == 3) && ( ! memcmp(lowercase, "nan", 3)))
+    {
+        *buffer = NAN;
+        return true;
+    }
+    return false;
+}
+
+/// @brief Convert a cleaned-up decimal number, which needs more than 53
+///        bits of precision or a large exponent, with correct rounding.
+bool cini_internal_decode_decimal_slowly(
+    const char *digits,
+    double *buffer
+) {
+    locale_t c_locale = cini_internal_get_c_locale();
+    if ( ! c_locale)
+    {
+        return false;
+    }
+    char *end;
+    errno = 0;
+    double decimal = strtod_l(digits, &end, c_locale);
+    if (*end != 0)
+    {
+        return false;
+    }
+    if ((errno == ERANGE) && isinf(decimal))
+    {
+        return false;
+    }
+    *buffer = decimal;
+    return true;
+}
+
+bool cini_decode_decimal(
+    const char *value,
+    uint_fast32_t len_value,
+    double *buffer
+) {
+    uint_fast32_t offset = 0;
+    bool negative = false;
+    if ((len_value > 0) && ((value[0] == '-') || (value[0] == '+')))
+    {
+        negative = value[0] == '-';
+        ++offset;
+    }
+    if (cini_internal_decode_special(
+        &value[offset],
+        len_value - offset,
+        buffer
+    )) {
+        if (negative)
+        {
+            *buffer = -*buffer;
+        }
+        return true;
+    }
+    if (cini_internal_read_base_prefix(value, len_value, &offset))
+    {
+        int64_t integer;
+        if ( ! cini_decode_integer(value, len_value, &integer))
+        {
+            return false;
+        }
+        *buffer = (double) integer;
+        return true;
+    }
+
+    // Read the mantissa's digits, keeping the first 19 significant ones
+    // and a clean copy for the slow path.
+
+    char digits[CINI_MAX_DECIMAL_LENGTH + 1];
+    uint_fast32_t len_digits = 0;
+    if (negative)
+    {
+        digits[len_digits++] = '-';
+    }
+    uint64_t mantissa = 0;
+    uint_fast32_t num_significant = 0;
+    bool truncated = false;
+    int_fast32_t exponent = 0;
+    uint_fast32_t num_mantissa_digits = 0;
+    bool in_fraction = false;
+    for (; offset < len_value; ++offset)
+    {
+        char character = value[offset];
+        if ((character >= '0') && (character <= '9'))
+        {
+            ++num_mantissa_digits;
+            if (num_significant < 19)
+            {
+                mantissa = mantissa * 10 + (character - '0');
+                if (mantissa != 0)
+                {
+                    ++num_significant;
+                }
+                if (in_fraction)
+                {
+                    --exponent;
+                }
+            }
+            else
+            {
+                truncated |= character != '0';
+                if ( ! in_fraction)
+                {
+                    ++exponent;
+                }
+            }
+        }
+        else if ((character == '.') && ( ! in_fraction))
+        {
+            in_fraction = true;
+        }
+        else if (cini_internal_is_digit_separator(
+            value,
+            len_value,
+            offset,
+            10
+        )) {
+            continue;
+        }
+        else
+        {
+            break;
+        }
+        if (len_digits >= CINI_MAX_DECIMAL_LENGTH)
+        {
+            return false;
+        }
+        digits[len_digits++] = character;
+    }
+    if (num_mantissa_digits == 0)
+    {
+        return false;
+    }
+
+    // Read the exponent
+
+    if ((offset < len_value) && ((value[offset] | 0x20) == 'e'))
+    {
+        digits[len_digits++] = 'e';
+        ++offset;
+        bool negative_exponent = false;
+        if (
+             (offset < len_value)
+          && ((value[offset] == '-') || (value[offset] == '+'))
+        ) {
+            negative_exponent = value[offset] == '-';
+            ++offset;
+        }
+        uint64_t explicit_exponent;
+        if ( ! cini_internal_decode_magnitude(
+            value,
+            len_value,
+            offset,
+            10,
+            &explicit_exponent
+        )) {
+            return false;
+        }
+        if (explicit_exponent > 100000)
+        {
+            // Far beyond the range of a double either way.
+
+            explicit_exponent = 100000;
+        }
+        if (negative_exponent)
+        {
+            exponent -= explicit_exponent;
+        }
+        else
+        {
+            exponent += explicit_exponent;
+        }
+        int written = snprintf(
+            &digits[len_digits],
+            (CINI_MAX_DECIMAL_LENGTH + 1) - len_digits,
+            "%s%u",
+            negative_exponent ? "-" : "",
+            (unsigned int) explicit_exponent
+        );
+        if (
+             (written < 0)
+          || ((len_digits + written) > CINI_MAX_DECIMAL_LENGTH)
+        ) {
+            return false;
+        }
+        len_digits += written;
+    }
+    else if (offset < len_value)
+    {
+        return false;
+    }
+    digits[len_digits] = 0;
+
+    // A mantissa which fits into 53 bits and a power of ten which is
+    // exact can be combined with a single, correctly rounded operation.
+
+    if (mantissa == 0)
+    {
+        *buffer = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (( ! truncated) && (mantissa <= ((uint64_t) 1 << 53)))
+    {
+        double decimal = (double) mantissa;
+        if ((exponent >= -22) && (exponent <= 22))
+        {
+            if (exponent < 0)
+            {
+                decimal /= cini_exact_powers_of_ten[-exponent];
+            }
+            else
+            {
+                decimal *= cini_exact_powers_of_ten[exponent];
+            }
+            *buffer = negative ? -decimal : decimal;
+            return true;
+        }
+        if ((exponent > 22) && (exponent <= (22 + 15)))
+        {
+            // Move the excess of the exponent into the mantissa while
+            // that stays exact.
+
+            uint64_t shifted = mantissa;
+            int_fast32_t excess = exponent - 22;
+            while ((excess > 0) && (shifted <= (((uint64_t) 1 << 53) / 10)))
+            {
+                shifted *= 10;
+                --excess;
+            }
+            if (excess == 0)
+            {
+                decimal = (double) shifted * cini_exact_powers_of_ten[22];
+                *buffer = negative ? -decimal : decimal;
+                return true;
+            }
+        }
+    }
+    return cini_internal_decode_decimal_slowly(digits, buffer);
+}
+
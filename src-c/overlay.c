@@ -0,0 +1,581 @@
+#include <cini/compiled.h>
+#include <cini/field.h>
+#include <cini/overlay.h>
+#include <cini/query.h>
+#include <cini/section.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+// ==> Overlay Management
+
+CiniOverlay * cini_new_overlay(
+    CiniDocument *const *layers,
+    uint_fast32_t num_layers
+) {
+    if (( ! layers) || (num_layers == 0))
+    {
+        return NULL;
+    }
+    for (uint_fast32_t layer = 0; layer < num_layers; ++layer)
+    {
+        if ( ! layers[layer])
+        {
+            return NULL;
+        }
+    }
+
+    // The layer and generation arrays are placed behind the overlay in
+    // the same allocation.
+
+    CiniOverlay *overlay = malloc(
+        sizeof(CiniOverlay)
+      + (num_layers * sizeof(CiniDocument *))
+      + (num_layers * sizeof(uint_fast32_t))
+    );
+    if ( ! overlay)
+    {
+        return NULL;
+    }
+    overlay->cache = calloc(
+        CINI_OVERLAY_CACHE_CAPACITY,
+        sizeof(CiniOverlayEntry *)
+    );
+    if ( ! overlay->cache)
+    {
+        free(overlay);
+        return NULL;
+    }
+    overlay->cache_capacity = CINI_OVERLAY_CACHE_CAPACITY;
+    overlay->num_cached = 0;
+    overlay->num_layers = num_layers;
+    overlay->layers = (CiniDocument **) &overlay[1];
+    overlay->generations = (uint_fast32_t *) &overlay->layers[num_layers];
+    for (uint_fast32_t layer = 0; layer < num_layers; ++layer)
+    {
+        overlay->layers[layer] = layers[layer];
+        overlay->generations[layer] = layers[layer]->generation;
+    }
+    return overlay;
+}
+
+void cini_internal_clear_overlay_cache(
+    CiniOverlay *overlay
+) {
+    for (uint_fast32_t slot = 0; slot < overlay->cache_capacity; ++slot)
+    {
+        free(overlay->cache[slot]);
+        overlay->cache[slot] = NULL;
+    }
+    overlay->num_cached = 0;
+}
+
+void cini_free_overlay(
+    CiniOverlay *overlay
+) {
+    if ( ! overlay)
+    {
+        return;
+    }
+    cini_internal_clear_overlay_cache(overlay);
+    free(overlay->cache);
+    free(overlay);
+}
+
+
+
+// ==> Query Cache
+
+/// @brief Empty the cache if any layer was changed since it was filled,
+///        as a field of another layer may win now.
+void cini_internal_validate_overlay_cache(
+    CiniOverlay *overlay
+) {
+    bool is_valid = true;
+    for (uint_fast32_t layer = 0; layer < overlay->num_layers; ++layer)
+    {
+        uint_fast32_t generation = overlay->layers[layer]->generation;
+        if (overlay->generations[layer] != generation)
+        {
+            overlay->generations[layer] = generation;
+            is_valid = false;
+        }
+    }
+    if ( ! is_valid)
+    {
+        cini_internal_clear_overlay_cache(overlay);
+    }
+}
+
+/// @brief Double the cache's slots, so that it stays at most half full.
+/// @return
+/// `CINI_SUCCESS` or `CINI_ALLOCATION_FAILURE`.
+int_fast8_t cini_internal_grow_overlay_cache(
+    CiniOverlay *overlay
+) {
+    uint_fast32_t capacity = overlay->cache_capacity * 2;
+    CiniOverlayEntry **cache = calloc(capacity, sizeof(CiniOverlayEntry *));
+    if ( ! cache)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    uint_fast32_t mask = capacity - 1;
+    for (uint_fast32_t slot = 0; slot < overlay->cache_capacity; ++slot)
+    {
+        CiniOverlayEntry *entry = overlay->cache[slot];
+        if ( ! entry)
+        {
+            continue;
+        }
+        uint_fast32_t slot_index = entry->hash & mask;
+        while (cache[slot_index])
+        {
+            slot_index = (slot_index + 1) & mask;
+        }
+        cache[slot_index] = entry;
+    }
+    free(overlay->cache);
+    overlay->cache = cache;
+    overlay->cache_capacity = capacity;
+    return CINI_SUCCESS;
+}
+
+/// @brief Resolve a query through the layers, from the highest one
+///        down to the first one which has the field.
+void cini_internal_resolve_overlay_entry(
+    CiniOverlay *overlay,
+    CiniOverlayEntry *entry
+) {
+    entry->layer = -1;
+    entry->field = NULL;
+    entry->status = CINI_SECTION_NONEXISTENT;
+
+    uint_fast32_t layer = overlay->num_layers;
+    while (layer > 0)
+    {
+        --layer;
+        CiniStatus status = CINI_SUCCESS;
+        CiniField *field = cini_internal_resolve_query(
+            overlay->layers[layer],
+            entry->query,
+            entry->len_query,
+            NULL,
+            &status,
+            &entry->exposed_field
+        );
+        if (field)
+        {
+            entry->layer = layer;
+            entry->field = field;
+            entry->status = CINI_SUCCESS;
+            return;
+        }
+
+        // A section which exists in any layer makes the key the part
+        // which is missing.
+
+        if (status == CINI_KEY_NONEXISTENT)
+        {
+            entry->status = CINI_KEY_NONEXISTENT;
+        }
+    }
+}
+
+/// @brief Get the cached resolution of a query, resolving it through
+///        the layers if it isn't cached yet.
+/// @param status
+///        Pointer to where to put `CINI_ALLOCATION_FAILURE` if the query
+///        couldn't be cached.
+/// @return
+/// The entry or `NULL` on allocation failure.
+CiniOverlayEntry * cini_internal_lookup_overlay(
+    CiniOverlay *overlay,
+    const char *query,
+    CiniStatus *status
+) {
+    cini_internal_validate_overlay_cache(overlay);
+
+    uint_fast32_t len_query = strlen(query);
+    uint32_t hash = cini_hash_string(query, len_query);
+    uint_fast32_t mask = overlay->cache_capacity - 1;
+    uint_fast32_t slot_index = hash & mask;
+    while (overlay->cache[slot_index])
+    {
+        CiniOverlayEntry *entry = overlay->cache[slot_index];
+        if (
+             (entry->hash == hash)
+          && (entry->len_query == len_query)
+          && ( ! memcmp(entry->query, query, len_query))
+        ) {
+            return entry;
+        }
+        slot_index = (slot_index + 1) & mask;
+    }
+
+    if (((overlay->num_cached + 1) * 2) > overlay->cache_capacity)
+    {
+        if (cini_internal_grow_overlay_cache(overlay) != CINI_SUCCESS)
+        {
+            *status = CINI_ALLOCATION_FAILURE;
+            return NULL;
+        }
+        mask = overlay->cache_capacity - 1;
+        slot_index = hash & mask;
+        while (overlay->cache[slot_index])
+        {
+            slot_index = (slot_index + 1) & mask;
+        }
+    }
+    CiniOverlayEntry *entry = malloc(sizeof(CiniOverlayEntry) + len_query + 1);
+    if ( ! entry)
+    {
+        *status = CINI_ALLOCATION_FAILURE;
+        return NULL;
+    }
+    entry->hash = hash;
+    entry->len_query = len_query;
+    memcpy(entry->query, query, len_query + 1);
+    cini_internal_resolve_overlay_entry(overlay, entry);
+
+    overlay->cache[slot_index] = entry;
+    ++overlay->num_cached;
+    return entry;
+}
+
+
+
+// ==> Value Gathering
+
+int_fast32_t cini_get_overlay_layer(
+    CiniOverlay *overlay,
+    const char *query
+) {
+    if (( ! overlay) || ( ! query))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniOverlayEntry *entry = cini_internal_lookup_overlay(
+        overlay,
+        query,
+        &status
+    );
+    if ( ! entry)
+    {
+        return status;
+    }
+    if ( ! entry->field)
+    {
+        return entry->status;
+    }
+    return entry->layer;
+}
+
+int_fast8_t cini_get_overlay_bool(
+    CiniOverlay *overlay,
+    const char *query,
+    bool *buffer
+) {
+    if (( ! overlay) || ( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniOverlayEntry *entry = cini_internal_lookup_overlay(
+        overlay,
+        query,
+        &status
+    );
+    if ( ! entry)
+    {
+        return status;
+    }
+    if ( ! entry->field)
+    {
+        return entry->status;
+    }
+    return cini_internal_read_bool(entry->field, buffer);
+}
+
+int_fast8_t cini_get_overlay_int(
+    CiniOverlay *overlay,
+    const char *query,
+    int64_t *buffer
+) {
+    if (( ! overlay) || ( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniOverlayEntry *entry = cini_internal_lookup_overlay(
+        overlay,
+        query,
+        &status
+    );
+    if ( ! entry)
+    {
+        return status;
+    }
+    if ( ! entry->field)
+    {
+        return entry->status;
+    }
+    return cini_internal_read_int(entry->field, buffer);
+}
+
+int_fast8_t cini_get_overlay_decimal(
+    CiniOverlay *overlay,
+    const char *query,
+    double *buffer
+) {
+    if (( ! overlay) || ( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniOverlayEntry *entry = cini_internal_lookup_overlay(
+        overlay,
+        query,
+        &status
+    );
+    if ( ! entry)
+    {
+        return status;
+    }
+    if ( ! entry->field)
+    {
+        return entry->status;
+    }
+    return cini_internal_read_decimal(entry->field, buffer);
+}
+
+const char * cini_get_overlay_text(
+    CiniOverlay *overlay,
+    const char *query
+) {
+    if (( ! overlay) || ( ! query))
+    {
+        return NULL;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniOverlayEntry *entry = cini_internal_lookup_overlay(
+        overlay,
+        query,
+        &status
+    );
+    if (( ! entry) || ( ! entry->field))
+    {
+        return NULL;
+    }
+    return cini_internal_read_text(
+        overlay->layers[entry->layer],
+        entry->field
+    );
+}
+
+
+
+// ==> Flattening
+
+/// @brief Copy a field of a layer into a section of the flattened
+///        document, replacing the value of a lower layer's field with
+///        the same key. Decodes which the layer already made are kept.
+void cini_internal_flatten_field(
+    CiniDocument *flattened,
+    CiniSection *section,
+    const CiniField *field
+) {
+    const char *value = cini_arena_copy_slice(
+        flattened->arena,
+        field->value,
+        field->len_value
+    );
+    CiniField *target = cini_internal_add_field(
+        flattened,
+        section,
+        field->key,
+        field->len_key,
+        true,
+        value,
+        field->len_value,
+        true
+    );
+    if (
+        __atomic_load_n(&field->decode_state, __ATOMIC_ACQUIRE)
+     == CINI_DECODE_DONE
+    ) {
+        target->applicable_types = field->applicable_types;
+        target->boolean = field->boolean;
+        target->integer = field->integer;
+        target->decimal = field->decimal;
+        target->decode_state = CINI_DECODE_DONE;
+    }
+}
+
+/// @brief Find or create the section of the flattened document which
+///        has the same path as a layer's section.
+CiniSection * cini_internal_flatten_section(
+    CiniDocument *flattened,
+    CiniSection *section
+) {
+    if ( ! section->parent)
+    {
+        return flattened->root_section;
+    }
+    CiniSection *parent = cini_internal_flatten_section(
+        flattened,
+        section->parent
+    );
+    CiniSection *target = cini_internal_find_sub_section(
+        flattened,
+        parent,
+        section->name,
+        section->len_name,
+        section->name_hash
+    );
+    if (target)
+    {
+        return target;
+    }
+    return cini_internal_add_sub_section(
+        flattened,
+        parent,
+        cini_arena_copy_slice(
+            flattened->arena,
+            section->name,
+            section->len_name
+        ),
+        section->len_name,
+        section->name_hash
+    );
+}
+
+void cini_internal_flatten_layer(
+    CiniDocument *flattened,
+    CiniDocument *layer
+) {
+    CiniSection *section = layer->first_section;
+    while (section)
+    {
+        CiniSection *target = cini_internal_flatten_section(
+            flattened,
+            section
+        );
+        CiniField *field = section->first_field;
+        while (field)
+        {
+            cini_internal_flatten_field(flattened, target, field);
+            field = field->next_in_section;
+        }
+        section = section->linear_next;
+    }
+}
+
+/// @return
+/// `CINI_SUCCESS` or `CINI_ALLOCATION_FAILURE`.
+int_fast8_t cini_internal_flatten_compiled_layer(
+    CiniDocument *flattened,
+    const CiniCompiledHeader *header
+) {
+    // Parents come before their sub-sections in the compiled section
+    // list, so each section's parent is mapped by the time it is needed.
+
+    CiniSection **targets = malloc(header->num_sections * sizeof(void *));
+    if ( ! targets)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    for (uint_fast32_t index = 0; index < header->num_sections; ++index)
+    {
+        const CiniCompiledSection *section =
+            cini_internal_get_compiled_section(header, index);
+        if (section->parent == CINI_COMPILED_NONE)
+        {
+            targets[index] = flattened->root_section;
+        }
+        else
+        {
+            const char *name = cini_internal_get_compiled_string(
+                header,
+                section->name
+            );
+            CiniSection *parent = targets[section->parent];
+            targets[index] = cini_internal_find_sub_section(
+                flattened,
+                parent,
+                name,
+                section->len_name,
+                section->name_hash
+            );
+            if ( ! targets[index])
+            {
+                targets[index] = cini_internal_add_sub_section(
+                    flattened,
+                    parent,
+                    cini_arena_copy_slice(
+                        flattened->arena,
+                        name,
+                        section->len_name
+                    ),
+                    section->len_name,
+                    section->name_hash
+                );
+            }
+        }
+        for (
+            uint_fast32_t field_index = 0;
+            field_index < section->num_fields;
+            ++field_index
+        ) {
+            CiniField field;
+            cini_internal_expose_compiled_field(
+                header,
+                cini_internal_get_compiled_field(
+                    header,
+                    section->first_field + field_index
+                ),
+                &field
+            );
+            cini_internal_flatten_field(flattened, targets[index], &field);
+        }
+    }
+    free(targets);
+    return CINI_SUCCESS;
+}
+
+CiniDocument * cini_flatten_overlay(
+    CiniOverlay *overlay,
+    CiniAllocateFn fn_alloc,
+    CiniFreeFn fn_free,
+    void *userdata
+) {
+    if (( ! overlay) || ( ! fn_alloc) || ( ! fn_free))
+    {
+        return NULL;
+    }
+    CiniDocument *flattened = cini_new_document(fn_alloc, fn_free, userdata);
+    if ( ! flattened)
+    {
+        return NULL;
+    }
+    for (uint_fast32_t layer = 0; layer < overlay->num_layers; ++layer)
+    {
+        CiniDocument *document = overlay->layers[layer];
+        if ( ! document->compiled)
+        {
+            cini_internal_flatten_layer(flattened, document);
+            continue;
+        }
+        if (
+            cini_internal_flatten_compiled_layer(
+                flattened,
+                document->compiled
+            ) != CINI_SUCCESS
+        ) {
+            cini_free_document(flattened);
+            return NULL;
+        }
+    }
+    return flattened;
+}
+
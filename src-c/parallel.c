@@ -0,0 +1,598 @@
+#include <cini/field.h>
+#include <cini/parallel.h>
+#include <cini/parser.h>
+#include <cini/section.h>
+#include <cini/stats.h>
+#include <cini/utility.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+/// @brief One part of a source, which starts with a section header
+///        unless it is the first, and the document it is parsed into.
+typedef struct
+{
+    const char *source;
+    uint_fast32_t len_source;
+    bool borrow_source;
+
+    CiniDocument *document;
+    int_fast8_t status;
+
+    pthread_t thread;
+    bool has_thread;
+
+} CiniParseChunk;
+
+/// @brief Files which are parsed by a pool of threads, which claim them
+///        one after another through `next_index`.
+typedef struct
+{
+    const char *const *paths;
+    uint_fast32_t count;
+    CiniDocument **documents;
+    int_fast8_t *statuses;
+
+    CiniAllocateFn fn_alloc;
+    CiniFreeFn fn_free;
+    void *allocator;
+    const CiniArenaConfig *arena_config;
+
+    uint_fast32_t next_index;
+
+} CiniBatch;
+
+
+
+// ==> Splitting
+
+/// @brief Find the next section header which starts a line.
+/// @param offset
+///        Offset from which to search, which must be larger than zero.
+/// @return
+/// Offset of the header's opening bracket or the source's length if
+/// there is no header left.
+uint_fast32_t cini_internal_find_split_point(
+    const char *source,
+    uint_fast32_t len_source,
+    uint_fast32_t offset
+) {
+    // Lines can't be continued and quoted values can't span lines, so
+    // every line can be parsed without knowing the previous ones. Only
+    // the active section is carried over, which a header resets.
+
+    while (offset < len_source)
+    {
+        const char *newline = memchr(
+            &source[offset - 1],
+            '\n',
+            len_source - (offset - 1)
+        );
+        if ( ! newline)
+        {
+            break;
+        }
+        offset = (newline - source) + 1;
+        if ((offset < len_source) && (source[offset] == '['))
+        {
+            return offset;
+        }
+        ++offset;
+    }
+    return len_source;
+}
+
+/// @brief Split a source into chunks of roughly equal length.
+/// @return
+/// Number of chunks, which is at most `max_chunks`.
+uint_fast32_t cini_internal_split_source(
+    const char *source,
+    uint_fast32_t len_source,
+    bool borrow_source,
+    CiniParseChunk *chunks,
+    uint_fast32_t max_chunks
+) {
+    uint_fast32_t num_chunks = 0;
+    uint_fast32_t chunk_start = 0;
+    while (chunk_start < len_source)
+    {
+        uint_fast32_t chunk_end = len_source;
+        if ((num_chunks + 1) < max_chunks)
+        {
+            uint_fast32_t target = chunk_start + CINI_PARALLEL_MIN_CHUNK;
+            uint_fast64_t even_split = (uint_fast64_t) len_source
+                * (num_chunks + 1)
+                / max_chunks;
+            if (even_split > target)
+            {
+                target = even_split;
+            }
+            if (target < len_source)
+            {
+                chunk_end = cini_internal_find_split_point(
+                    source,
+                    len_source,
+                    target
+                );
+            }
+        }
+        CiniParseChunk *chunk = &chunks[num_chunks];
+        chunk->source = &source[chunk_start];
+        chunk->len_source = chunk_end - chunk_start;
+        chunk->borrow_source = borrow_source;
+        chunk->document = NULL;
+        chunk->status = CINI_SUCCESS;
+        chunk->has_thread = false;
+        ++num_chunks;
+        chunk_start = chunk_end;
+    }
+    return num_chunks;
+}
+
+
+
+// ==> Merging
+
+/// @brief Move a chunk's sections and fields into a document, as if
+///        the chunk had been parsed into it, and free the chunk's
+///        document. Its memory is taken over by the document's arena.
+bool cini_internal_merge_chunk(
+    CiniDocument *document,
+    CiniDocument *chunk
+) {
+    // Every section of the chunk is mapped to the document's section
+    // of the same path. Parents come before their sub-sections in the
+    // linear list, so their mapping is always known already.
+
+    CiniSection **mapping = document->fn_alloc(
+        chunk->num_sections * sizeof(CiniSection *),
+        document->allocator
+    );
+    if ( ! mapping)
+    {
+        return false;
+    }
+    uint_fast32_t section_index = 0;
+    CiniSection *section = chunk->first_section;
+    while (section)
+    {
+        section->linear_index = section_index;
+        CiniSection *target = document->root_section;
+        if (section != chunk->root_section)
+        {
+            CiniSection *parent = mapping[section->parent->linear_index];
+            target = cini_internal_find_sub_section(
+                document,
+                parent,
+                section->name,
+                section->len_name,
+                section->name_hash
+            );
+            if ( ! target)
+            {
+                target = cini_internal_add_sub_section(
+                    document,
+                    parent,
+                    section->name,
+                    section->len_name,
+                    section->name_hash
+                );
+            }
+        }
+        mapping[section_index] = target;
+
+        if ( ! target->first_field)
+        {
+            // Nothing to override; the chunk's fields are taken over
+            // together with their index.
+
+            target->first_field = section->first_field;
+            target->last_field = section->last_field;
+            target->num_fields = section->num_fields;
+            target->field_index_capacity = section->field_index_capacity;
+            target->field_index = section->field_index;
+            document->num_values += section->num_fields;
+        }
+        else
+        {
+            CiniField *field = section->first_field;
+            while (field)
+            {
+                cini_internal_add_field(
+                    document,
+                    target,
+                    field->key,
+                    field->len_key,
+                    false,
+                    field->value,
+                    field->len_value,
+                    field->flags & CINI_FIELD_VALUE_TERMINATED
+                );
+                field = field->next_in_section;
+            }
+        }
+        ++section_index;
+        section = section->linear_next;
+    }
+    document->fn_free(mapping, document->allocator);
+
+    // The chunk's allocator calls were counted for the document as well,
+    // as they went through its allocator.
+
+    document->len_abandoned_sub_sections += chunk->len_abandoned_sub_sections;
+    document->len_abandoned_indexes += chunk->len_abandoned_indexes;
+    if (document->profiler && chunk->profiler)
+    {
+        cini_internal_add_parse_profile(
+            &document->profiler->totals,
+            &chunk->profiler->totals
+        );
+    }
+    cini_adopt_arena(document->arena, chunk->arena);
+    chunk->fn_free(chunk, chunk->allocator);
+    return true;
+}
+
+
+
+// ==> Parsing
+
+void * cini_internal_parse_chunk(
+    void *userdata
+) {
+    CiniParseChunk *chunk = userdata;
+    chunk->status = cini_internal_parse_serially(
+        chunk->document,
+        chunk->source,
+        chunk->len_source,
+        chunk->borrow_source
+    );
+    return NULL;
+}
+
+int_fast8_t cini_internal_parse_in_parallel(
+    CiniDocument *document,
+    const char *source,
+    uint_fast32_t len_source,
+    bool borrow_source
+) {
+    uint_fast32_t max_chunks = document->num_parse_threads;
+    if (max_chunks > (len_source / CINI_PARALLEL_MIN_CHUNK))
+    {
+        max_chunks = len_source / CINI_PARALLEL_MIN_CHUNK;
+    }
+    if (max_chunks < 2)
+    {
+        return cini_internal_parse_serially(
+            document,
+            source,
+            len_source,
+            borrow_source
+        );
+    }
+    CiniParseChunk *chunks = document->fn_alloc(
+        max_chunks * sizeof(CiniParseChunk),
+        document->allocator
+    );
+    if ( ! chunks)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    uint_fast32_t num_chunks = cini_internal_split_source(
+        source,
+        len_source,
+        borrow_source,
+        chunks,
+        max_chunks
+    );
+
+    bool chunks_ready = num_chunks > 1;
+    uint_fast32_t chunk_index = 0;
+    while (chunks_ready && (chunk_index < num_chunks))
+    {
+        chunks[chunk_index].document = cini_new_configured_document(
+            document->fn_alloc,
+            document->fn_free,
+            document->allocator,
+            NULL
+        );
+        chunks_ready = chunks[chunk_index].document != NULL;
+        if (chunks_ready && document->profiler)
+        {
+            cini_set_feature(
+                chunks[chunk_index].document,
+                CINI_FEATURE_PROFILING,
+                true
+            );
+        }
+        ++chunk_index;
+    }
+
+    if (chunks_ready)
+    {
+        // The first chunk is parsed on the calling thread. A chunk whose
+        // thread can't be started is parsed there as well.
+
+        chunk_index = 1;
+        while (chunk_index < num_chunks)
+        {
+            CiniParseChunk *chunk = &chunks[chunk_index];
+            chunk->has_thread = pthread_create(
+                &chunk->thread,
+                NULL,
+                cini_internal_parse_chunk,
+                chunk
+            ) == 0;
+            ++chunk_index;
+        }
+        cini_internal_parse_chunk(&chunks[0]);
+        chunk_index = 1;
+        while (chunk_index < num_chunks)
+        {
+            CiniParseChunk *chunk = &chunks[chunk_index];
+            if (chunk->has_thread)
+            {
+                pthread_join(chunk->thread, NULL);
+            }
+            else
+            {
+                cini_internal_parse_chunk(chunk);
+            }
+            ++chunk_index;
+        }
+        chunk_index = 0;
+        while (chunks_ready && (chunk_index < num_chunks))
+        {
+            chunks_ready = chunks[chunk_index].status == CINI_SUCCESS;
+            ++chunk_index;
+        }
+    }
+
+    // A chunk which can't be merged ends merging; the chunks before it
+    // stay in the document, like the fields before a parsing error.
+
+    int_fast8_t status = CINI_SUCCESS;
+    chunk_index = 0;
+    while (chunk_index < num_chunks)
+    {
+        CiniDocument *chunk_document = chunks[chunk_index].document;
+        if (chunk_document && chunks_ready)
+        {
+            if ( ! cini_internal_merge_chunk(document, chunk_document))
+            {
+                cini_free_document(chunk_document);
+                status = CINI_ALLOCATION_FAILURE;
+                chunks_ready = false;
+            }
+        }
+        else if (chunk_document)
+        {
+            cini_free_document(chunk_document);
+        }
+        ++chunk_index;
+    }
+    document->fn_free(chunks, document->allocator);
+
+    if ((status == CINI_SUCCESS) && ( ! chunks_ready))
+    {
+        status = cini_internal_parse_serially(
+            document,
+            source,
+            len_source,
+            borrow_source
+        );
+    }
+    return status;
+}
+
+
+
+// ==> Batches
+
+/// @brief Open a file of a batch and let the kernel start reading it
+///        in the background.
+/// @return
+/// The file descriptor or -1 on error.
+int cini_internal_open_batch_file(
+    const char *path
+) {
+    if ( ! path)
+    {
+        return -1;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    }
+    return fd;
+}
+
+int_fast8_t cini_internal_parse_batch_file(
+    CiniBatch *batch,
+    uint_fast32_t index,
+    int fd
+) {
+    CiniDocument *document = cini_new_configured_document(
+        batch->fn_alloc,
+        batch->fn_free,
+        batch->allocator,
+        batch->arena_config
+    );
+    batch->documents[index] = document;
+    if (fd < 0)
+    {
+        if ( ! batch->paths[index])
+        {
+            return CINI_INVALID_POINTER;
+        }
+        return CINI_FILE_NOT_FOUND;
+    }
+    int_fast8_t status = CINI_ALLOCATION_FAILURE;
+    if (document)
+    {
+        status = cini_parse_fd(document, fd);
+    }
+    close(fd);
+    return status;
+}
+
+void * cini_internal_run_batch(
+    void *userdata
+) {
+    CiniBatch *batch = userdata;
+
+    // Each thread keeps one file open ahead of the one it parses, so
+    // that the kernel reads it while the current one is being parsed.
+
+    uint_fast32_t index = __atomic_fetch_add(
+        &batch->next_index,
+        1,
+        __ATOMIC_RELAXED
+    );
+    int fd = -1;
+    if (index < batch->count)
+    {
+        fd = cini_internal_open_batch_file(batch->paths[index]);
+    }
+    while (index < batch->count)
+    {
+        uint_fast32_t next_index = __atomic_fetch_add(
+            &batch->next_index,
+            1,
+            __ATOMIC_RELAXED
+        );
+        int next_fd = -1;
+        if (next_index < batch->count)
+        {
+            next_fd = cini_internal_open_batch_file(batch->paths[next_index]);
+        }
+        batch->statuses[index] = cini_internal_parse_batch_file(
+            batch,
+            index,
+            fd
+        );
+        index = next_index;
+        fd = next_fd;
+    }
+    return NULL;
+}
+
+int_fast8_t cini_parse_many(
+    const char *const *paths,
+    uint_fast32_t count,
+    CiniDocument **documents,
+    int_fast8_t *statuses,
+    const CiniBatchOptions *options
+) {
+    // Validate arguments
+
+    if (( ! paths) || ( ! documents))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if (count == 0)
+    {
+        return CINI_SUCCESS;
+    }
+    CiniBatchOptions defaults = {0};
+    if ( ! options)
+    {
+        options = &defaults;
+    }
+
+    CiniBatch batch;
+    batch.paths = paths;
+    batch.count = count;
+    batch.documents = documents;
+    batch.statuses = statuses;
+    batch.fn_alloc = options->fn_alloc;
+    batch.fn_free = options->fn_free;
+    batch.allocator = options->allocator;
+    batch.arena_config = options->arena_config;
+    batch.next_index = 0;
+    if (( ! batch.fn_alloc) || ( ! batch.fn_free))
+    {
+        batch.fn_alloc = cini_call_wrapped_malloc;
+        batch.fn_free = cini_call_wrapped_free;
+        batch.allocator = NULL;
+    }
+    if ( ! statuses)
+    {
+        batch.statuses = batch.fn_alloc(
+            count * sizeof(int_fast8_t),
+            batch.allocator
+        );
+        if ( ! batch.statuses)
+        {
+            return CINI_ALLOCATION_FAILURE;
+        }
+    }
+
+    uint_fast32_t num_threads = options->num_threads;
+    if (num_threads == 0)
+    {
+        long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = 1;
+        if (num_processors > 1)
+        {
+            num_threads = num_processors;
+        }
+    }
+    if (num_threads > count)
+    {
+        num_threads = count;
+    }
+
+    // The calling thread works on the batch as well; the threads which
+    // can't be started are simply missing from the pool.
+
+    pthread_t *threads = NULL;
+    uint_fast32_t num_started = 0;
+    if (num_threads > 1)
+    {
+        threads = batch.fn_alloc(
+            (num_threads - 1) * sizeof(pthread_t),
+            batch.allocator
+        );
+    }
+    while (threads && (num_started < (num_threads - 1)))
+    {
+        if (pthread_create(
+            &threads[num_started],
+            NULL,
+            cini_internal_run_batch,
+            &batch
+        ) != 0) {
+            break;
+        }
+        ++num_started;
+    }
+    cini_internal_run_batch(&batch);
+    uint_fast32_t thread_index = 0;
+    while (thread_index < num_started)
+    {
+        pthread_join(threads[thread_index], NULL);
+        ++thread_index;
+    }
+    if (threads)
+    {
+        batch.fn_free(threads, batch.allocator);
+    }
+
+    int_fast8_t status = CINI_SUCCESS;
+    uint_fast32_t index = 0;
+    while ((status == CINI_SUCCESS) && (index < count))
+    {
+        status = batch.statuses[index];
+        ++index;
+    }
+    if ( ! statuses)
+    {
+        batch.fn_free(batch.statuses, batch.allocator);
+    }
+    return status;
+}
+
@@ -1,9 +1,19 @@
+#include <cini/field.h>
+#include <cini/log.h>
+#include <cini/parallel.h>
 #include <cini/parser.h>
+#include <cini/scanner.h>
+#include <cini/section.h>
 #include <cini/utility.h>
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 struct CiniParser
 {
@@ -11,75 +21,289 @@ struct CiniParser
 
     uint_fast32_t len_source;
     const char *source;
+    CiniStructuralIndex index;
 
+    // Whether the source lives as long as the document, so that names,
+    // keys and values can point into it instead of being copied.
+    bool borrow_source;
+
+    CiniSection *active_section;
     CiniStatus status;
+
+    // Streaming parsers keep the beginning of a line which was cut off
+    // by the end of a chunk until the rest of it is fed.
+    char *pending;
+    uint_fast32_t len_pending;
+    uint_fast32_t pending_capacity;
+
+    // Handler to which sections and fields are reported instead of
+    // being added to the document, or NULL. Handlers may stop parsing.
+    const CiniHandler *handler;
+    CiniSlice *path_buffer;
+    bool stopped;
+
+    // Offset and line of the block of lines which is being parsed within
+    // the whole source, so that logged positions span the blocks of a
+    // streamed source. Lines are only counted while logging is enabled.
+    uint_fast64_t base_offset;
+    uint_fast64_t base_line;
+
+    // Profiler of the document while it profiles, or NULL.
+    CiniProfiler *profiler;
 };
 
-uint_fast32_t cini_internal_count_section_levels(
+uint_fast32_t cini_internal_skip_whitespace(
     struct CiniParser *parser,
-    uint_fast32_t string_start,
-    uint_fast32_t len_string
+    uint_fast32_t offset
 ) {
-    uint_fast32_t num_levels = 1;
-    uint_fast32_t string_offset = 0;
-    while (string_offset < len_string)
+    while (offset < parser->len_source)
     {
-        uint_fast32_t len_character;
-        uint_least32_t character = cini_extract_utf8(
-            parser->source,
-            string_start + string_offset,
-            &len_character
-        );
-        if (character == '\\')
+        if ( ! cini_is_whitespace(parser->source[offset]))
         {
-            /// @todo Parse escape sequences
-
-            string_offset += len_character;
-            continue;
+            break;
         }
-        if (character == '"')
-        {
-            /// @todo Parse string encapsulations
+        ++offset;
+    }
+    return offset;
+}
 
-            puts("Limitation Exceeded: String encapsulations aren't supported yet");
-            parser->status = CINI_LIMITATION_EXCEEDED;
-            return 0;
-        }
-        if (character == '.')
+/// @brief Count the line feeds of a block of lines.
+uint_fast64_t cini_internal_count_lines(
+    const char *source,
+    uint_fast32_t length
+) {
+    uint_fast64_t num_lines = 0;
+    const char *end = source + length;
+    const char *line_feed = memchr(source, '\n', length);
+    while (line_feed)
+    {
+        ++num_lines;
+        ++line_feed;
+        line_feed = memchr(line_feed, '\n', end - line_feed);
+    }
+    return num_lines;
+}
+
+/// @brief Stop parsing because of an error, which is logged if the
+///        document has a log. Its line and column are only worked out
+///        then, so errors cost nothing extra while logging is disabled.
+/// @param offset
+///        Offset of the error within the block which is being parsed.
+void cini_internal_fail(
+    struct CiniParser *parser,
+    CiniStatus status,
+    CiniLogMessage message,
+    uint_fast32_t offset
+) {
+    parser->status = status;
+    if (( ! parser->document) || ( ! parser->document->log_entries))
+    {
+        return;
+    }
+
+    // Blocks always begin at the start of a line.
+
+    uint_fast32_t line_start = offset;
+    while ((line_start > 0) && (parser->source[line_start - 1] != '\n'))
+    {
+        --line_start;
+    }
+    CiniLogEntry entry;
+    entry.status = status;
+    entry.message = message;
+    entry.offset = parser->base_offset + offset;
+    entry.line = parser->base_line
+        + cini_internal_count_lines(parser->source, line_start)
+        + 1;
+    entry.column = (offset - line_start) + 1;
+    cini_internal_append_log(parser->document, &entry);
+}
+
+/// @brief Take over an encoding error which the structural index found
+///        in the bytes that were scanned so far.
+/// @return
+/// Whether the source is still valid.
+bool cini_internal_check_encoding(
+    struct CiniParser *parser
+) {
+    if (parser->index.status == CINI_SUCCESS)
+    {
+        return true;
+    }
+    if (parser->status == CINI_SUCCESS)
+    {
+        cini_internal_fail(
+            parser,
+            parser->index.status,
+            CINI_LOG_INVALID_UTF8,
+            parser->index.len_source
+        );
+    }
+    return false;
+}
+
+bool cini_internal_is_line_end(
+    struct CiniParser *parser,
+    uint_fast32_t offset
+) {
+    // The index's length is shortened to the first invalid byte if
+    // the source isn't valid UTF-8.
+    if (offset >= parser->index.len_source)
+    {
+        return true;
+    }
+    char character = parser->source[offset];
+    return (character == '\n') || (character == '\r');
+}
+
+/// @brief Find the end of the line in which an offset lies by jumping
+///        through the structural index.
+/// @return
+/// Offset of the line's first newline character or the source's length
+/// if the line is the source's last one.
+uint_fast32_t cini_internal_find_line_end(
+    struct CiniParser *parser,
+    uint_fast32_t offset
+) {
+    while (offset < parser->len_source)
+    {
+        offset = cini_next_structural(&parser->index, offset);
+        if (cini_internal_is_line_end(parser, offset))
         {
-            ++num_levels;
+            return offset;
         }
-        if (character == ' ')
-        {
-            while (string_offset < len_string)
-            {
-                uint_least32_t character = cini_extract_utf8(
-                    parser->source,
-                    string_start + string_offset,
-                    &len_character
-                );
-                if (character != ' ')
-                {
-                    break;
-                }
-                ++len_character;
-            }
-            ++num_levels;
+        ++offset;
+    }
+    return parser->len_source;
+}
+
+uint_fast32_t cini_internal_skip_newline(
+    struct CiniParser *parser,
+    uint_fast32_t offset
+) {
+    if (offset >= parser->len_source)
+    {
+        return offset;
+    }
+    if (parser->source[offset] == '\r')
+    {
+        ++offset;
+        if (
+             (offset < parser->len_source)
+          && (parser->source[offset] == '\n')
+        ) {
+            ++offset;
         }
-        string_offset += len_character;
+        return offset;
+    }
+    if (parser->source[offset] == '\n')
+    {
+        ++offset;
+    }
+    return offset;
+}
+
+/// @brief Get a string of the source which lives as long as the
+///        document does.
+/// @return
+/// A view into the source if the document owns it, otherwise an
+/// arena-allocated and zero-terminated copy.
+const char * cini_internal_store_slice(
+    struct CiniParser *parser,
+    uint_fast32_t start,
+    uint_fast32_t length
+) {
+    if (parser->borrow_source)
+    {
+        return &parser->source[start];
+    }
+    return cini_arena_copy_slice(
+        parser->document->arena,
+        &parser->source[start],
+        length
+    );
+}
+
+/// @brief Get the next link of a section path from the source.
+/// @return
+/// Whether a link could be found. If not, `parser->status` tells if
+/// that is because of an error or because the section name is over.
+bool cini_internal_next_path_link(
+    struct CiniParser *parser,
+    uint_fast32_t *offset,
+    uint_fast32_t end,
+    CiniSlice *link
+) {
+    int_fast8_t status = cini_next_path_link(
+        parser->source,
+        offset,
+        end,
+        link
+    );
+    if (status == CINI_LIMITATION_EXCEEDED)
+    {
+        cini_internal_fail(
+            parser,
+            CINI_LIMITATION_EXCEEDED,
+            CINI_LOG_QUOTED_SECTION_NAME,
+            *offset
+        );
+        return false;
+    }
+    if (status < 0)
+    {
+        cini_internal_fail(
+            parser,
+            CINI_SYNTAX_ERROR,
+            CINI_LOG_EMPTY_PATH_LINK,
+            *offset
+        );
+        return false;
+    }
+    return status == 1;
+}
+
+uint_fast32_t cini_internal_count_section_levels(
+    struct CiniParser *parser,
+    uint_fast32_t string_start,
+    uint_fast32_t len_string
+) {
+    uint_fast32_t num_levels = 0;
+    uint_fast32_t string_offset = string_start;
+    CiniSlice link;
+    while (
+        cini_internal_next_path_link(
+            parser,
+            &string_offset,
+            string_start + len_string,
+            &link
+        )
+    ) {
+        ++num_levels;
+    }
+    if (parser->status != CINI_SUCCESS)
+    {
+        return 0;
     }
     return num_levels;
 }
 
-/// @brief 
-/// @param parser 
-/// @param buffer Pointer to an array of strings of section levels.
-/// @param string_start 
-/// @param len_string 
-/// @return 
+/// @brief Split a section name into its levels.
+/// @param parser
+///        Parser structure which contains the source, source-length.
+/// @param buffer
+///        Pointer to where to put the array of the section levels,
+///        which are views into the source. The array is allocated in
+///        the arena, or is the parser's path buffer for handlers.
+/// @param string_start
+///        Offset of the section name's first character.
+/// @param len_string
+///        Length of the section name in bytes.
+/// @return
+/// Number of levels of the section name or zero on failure.
 uint_fast32_t cini_internal_split_section_string(
     struct CiniParser *parser,
-    char ***buffer,
+    CiniSlice **buffer,
     uint_fast32_t string_start,
     uint_fast32_t len_string
 ) {
@@ -90,466 +314,603 @@ uint_fast32_t cini_internal_split_section_string(
     );
     if ( ! num_levels)
     {
-        puts("Syntax Error: Empty section header.");
-        parser->status = CINI_SYNTAX_ERROR;
-        return 0;
-    }
-    *buffer = cini_arena_alloc(
-        parser->document->arena,
-        sizeof(char *) * (num_levels + 1)
-    );
-    (*buffer)[num_levels] = NULL;
-
-    uint_fast32_t level_index = 0;
-    uint_fast32_t string_offset = 0;
-    while (string_offset < len_string)
-    {
-        uint_fast32_t len_character;
-        uint_least32_t character = cini_extract_utf8(
-            parser->source,
-            string_start + string_offset,
-            &len_character
-        );
-        // Act upon splitters
-
-        if (character == '.')
-        {
-            ++level_index;
-            string_offset += len_character;
-            continue;
-        }
-        if (character == ' ')
+        if (parser->status == CINI_SUCCESS)
         {
-            while (string_offset < len_string)
-            {
-                uint_least32_t character = cini_extract_utf8(
-                    parser->source,
-                    string_start,
-                    &len_character
-                );
-                if (character != ' ')
-                {
-                    break;
-                }
-                ++len_character;
-            }
-            ++level_index;
-            string_offset += len_character;
-            continue;
-        }
-        if (character == '"')
-        {
-            /// @todo Parse string encapsulated path links
-
-            puts(
-                "Limitation Exceeded: "
-                "String encapsulations aren't supported yet"
+            cini_internal_fail(
+                parser,
+                CINI_SYNTAX_ERROR,
+                CINI_LOG_EMPTY_SECTION_HEADER,
+                string_start
             );
-            parser->status = CINI_LIMITATION_EXCEEDED;
-            return 0;
         }
+        return 0;
+    }
+    if (parser->handler)
+    {
+        // Handlers get the path in a buffer on the stack, so that
+        // parsing doesn't allocate anything.
 
-        uint_fast32_t path_link_start = string_start + string_offset;
-        while (string_offset < len_string)
+        if (num_levels > CINI_MAX_HANDLER_LEVELS)
         {
-            character = cini_extract_utf8(
-                parser->source,
-                string_start + string_offset,
-                &len_character
+            cini_internal_fail(
+                parser,
+                CINI_LIMITATION_EXCEEDED,
+                CINI_LOG_SECTION_PATH_TOO_DEEP,
+                string_start
             );
-            if (
-                 (character == '.')
-              || (character == ' ')
-              || (character == ']')
-            ) {
-                break;
-            }
-            if (character == '\\')
-            {
-                /// @todo Parse escape sequencess
-            }
-            string_offset += len_character;
+            return 0;
         }
-        uint_fast32_t path_link_end = string_start + string_offset;
-        uint_fast32_t len_path_link =
-              path_link_end - path_link_start;
-        char *path_link = cini_arena_alloc(
+        *buffer = parser->path_buffer;
+    }
+    else
+    {
+        *buffer = cini_arena_alloc(
             parser->document->arena,
-            len_path_link + 1
+            sizeof(CiniSlice) * num_levels
         );
-        memcpy(
-            path_link,
-            &parser->source[path_link_start],
-            len_path_link
-        );
-        path_link[len_path_link] = 0;
-        (*buffer)[level_index] = path_link;
-        string_offset += len_character;
+    }
+
+    uint_fast32_t level_index = 0;
+    uint_fast32_t string_offset = string_start;
+    while (
+        cini_internal_next_path_link(
+            parser,
+            &string_offset,
+            string_start + len_string,
+            &(*buffer)[level_index]
+        )
+    ) {
         ++level_index;
     }
     return num_levels;
 }
 
-void cini_internal_write_string_list(
-    char **list
-) {
-    uint_fast32_t index = 0;
-    while (list[index])
-    {
-        printf("%lu: %s\n", index, list[index]);
-        ++index;
-    };
-}
-
 /// @brief Parse the name of a section header.
 /// @param parser
 ///        Parser structure which contains the source, source-length.
 /// @param offset
 ///        Offset into 'parser.source' of the section header's opening
 ///        square bracket. This doesn't get checked, though.
-/// @param section_name
-///        Pointer to where to put the split parts of the arena-allocated
-///        version of the post-processed and checked section name.
+/// @param section_path
+///        Pointer to where to put the split parts of the post-processed
+///        and checked section name.
+/// @param num_levels
+///        Pointer to where to put the number of parts of the name.
 /// @return
 /// Zero on failure and the number of bytes until the character right
 /// after the section header's closing square bracket on success.
 uint_fast32_t cini_internal_parse_section_header(
     struct CiniParser *parser,
     uint_fast32_t offset,
-    char ***section_path
+    CiniSlice **section_path,
+    uint_fast32_t *num_levels
 ) {
-    uint_fast32_t name_start = offset;
-    
     // Jump over the opening square bracket
 
-    uint_fast32_t len_character;
-    uint_least32_t character = cini_extract_utf8(
-        parser->source,
-        offset,
-        &len_character
-    );
-    offset += len_character;
-
-    while (offset < parser->len_source)
+    uint_fast32_t name_start = offset + 1;
+    uint_fast32_t name_end = name_start;
+    while (true)
     {
-        character = cini_extract_utf8(
-            parser->source,
-            offset,
-            &len_character
-        );
-        if (character == '\n')
+        name_end = cini_next_structural(&parser->index, name_end);
+        if (cini_internal_is_line_end(parser, name_end))
         {
+            if ( ! cini_internal_check_encoding(parser))
+            {
+                return 0;
+            }
             /// @todo Find the next syntactically correct thing and
             ///       continue parsing there, but keep the status.
 
-            puts("Syntax Error: Section header not closed.");
-            parser->status = CINI_SYNTAX_ERROR;
+            cini_internal_fail(
+                parser,
+                CINI_SYNTAX_ERROR,
+                CINI_LOG_UNCLOSED_SECTION_HEADER,
+                name_end
+            );
             return 0;
         }
-        if (character == ']')
+        if (parser->source[name_end] == ']')
         {
             break;
         }
-        offset += len_character;
+        ++name_end;
+    }
+    if ( ! cini_internal_check_encoding(parser))
+    {
+        return 0;
     }
-    uint_fast32_t len_raw_string = offset - name_start;
 
-    if (
-        cini_internal_split_section_string(
-            parser,
-            section_path,
-            name_start,
-            len_raw_string
-        ) == 0
-    ) {
+    CINI_PROFILE_BEGIN(parser->profiler, timer);
+    *num_levels = cini_internal_split_section_string(
+        parser,
+        section_path,
+        name_start,
+        name_end - name_start
+    );
+    CINI_PROFILE_END(parser->profiler, timer, split_ns);
+    if (*num_levels == 0)
+    {
         return 0;
     }
-    return len_raw_string;
+    return (name_end + 1) - offset;
+}
+
+/// @brief Copy the content of a quoted value and resolve its escape
+///        sequences.
+/// @param parser
+///        Parser structure which contains the source, source-length.
+/// @param start
+///        Offset of the first character after the opening quotation
+///        mark.
+/// @param end
+///        Offset of the closing quotation mark.
+/// @param len_copy
+///        Pointer to where to put the length of the resolved string.
+/// @return
+/// Arena-allocated and zero-terminated copy of the value.
+const char * cini_internal_copy_escaped(
+    struct CiniParser *parser,
+    uint_fast32_t start,
+    uint_fast32_t end,
+    uint_fast32_t *len_copy
+) {
+    char *copy = cini_arena_alloc_bytes(
+        parser->document->arena,
+        (end - start) + 1
+    );
+    *len_copy = cini_unescape_text(
+        &parser->source[start],
+        end - start,
+        copy
+    );
+    copy[*len_copy] = 0;
+    return copy;
 }
 
+/// @brief Parse a `key = value` line.
+/// @param parser
+///        Parser structure which contains the source, source-length.
+/// @param offset
+///        Offset of the key's first character.
+/// @param active_section
+///        Section to which the field should be added.
+/// @return
+/// Zero on failure and the number of bytes until the end of the
+/// field's line on success.
 uint_fast32_t cini_internal_parse_field(
     struct CiniParser *parser,
     uint_fast32_t offset,
     CiniSection *active_section
 ) {
-    uint_fast32_t start_offset = offset;
-
-    // Jump over all possible whitespaces in front of the key
+    // Find equals sign
 
-    uint_fast32_t len_character;
-    uint_least32_t character;
-    
-    while (offset < parser->len_source)
+    uint_fast32_t key_start = offset;
+    uint_fast32_t equals_position = offset;
+    while (true)
     {
-        character = cini_extract_utf8(
-            parser->source,
-            offset,
-            &len_character
+        equals_position = cini_next_structural(
+            &parser->index,
+            equals_position
         );
-        if ( ! cini_is_whitespace(character))
+        if (cini_internal_is_line_end(parser, equals_position))
+        {
+            if ( ! cini_internal_check_encoding(parser))
+            {
+                return 0;
+            }
+            cini_internal_fail(
+                parser,
+                CINI_SYNTAX_ERROR,
+                CINI_LOG_MISSING_EQUALS_SIGN,
+                equals_position
+            );
+            return 0;
+        }
+        char character = parser->source[equals_position];
+        if (character == '=')
         {
             break;
         }
-        ++len_character;
+        if (character == '"')
+        {
+            /// @todo Parse string encapsulated keys
+
+            cini_internal_fail(
+                parser,
+                CINI_LIMITATION_EXCEEDED,
+                CINI_LOG_QUOTED_KEY,
+                equals_position
+            );
+            return 0;
+        }
+        ++equals_position;
     }
 
-    // Find equals sign
+    // Go back to the last character of the key
 
-    uint_fast32_t key_start = offset;
-    while (offset < parser->len_source)
-    {
-        character = cini_extract_utf8(
-            parser->source,
-            offset,
-            &len_character
-        );
-        if (cini_is_whitespace(character))
-        {
-            break;
-        }
-        offset += len_character;
+    uint_fast32_t key_end = equals_position;
+    while (
+         (key_end > key_start)
+      && cini_is_whitespace(parser->source[key_end - 1])
+    ) {
+        --key_end;
     }
-    if (parser->source[offset] == '=')
+    if (key_end == key_start)
     {
-        return offset;
+        cini_internal_fail(
+            parser,
+            CINI_SYNTAX_ERROR,
+            CINI_LOG_MISSING_KEY,
+            equals_position
+        );
+        return 0;
     }
-    uint_fast32_t equals_position = offset;
-
-    // Go back to the last character of the key
-    
-    while (offset < parser->len_source)
+    if ((key_end - key_start) > UINT16_MAX)
     {
-        character = cini_extract_utf8(
-            parser->source,
-            offset,
-            &len_character
+        cini_internal_fail(
+            parser,
+            CINI_LIMITATION_EXCEEDED,
+            CINI_LOG_KEY_TOO_LONG,
+            key_start
         );
-        if (cini_is_whitespace(character))
-        {
-            break;
-        }
-        offset += len_character;
+        return 0;
     }
 
-    CiniField field;
-    field.len_key = offset - key_start;
-    field.key = cini_arena_alloc(
-        parser->document->arena,
-        field.len_key + 1
-    );
-    memcpy(
-        field.len_key,
-        &parser->source[key_start],
-        field.len_key
+    // Find the value's bounds
+
+    uint_fast32_t value_start = cini_internal_skip_whitespace(
+        parser,
+        equals_position + 1
     );
-    field.key[field.len_key] = 0;
+    uint_fast32_t line_end;
+    uint_fast32_t len_value;
+    bool has_escapes = false;
+    if (
+         (value_start < parser->len_source)
+      && (parser->source[value_start] == '"')
+    ) {
+        uint_fast32_t value_end = value_start + 1;
+        while (true)
+        {
+            value_end = cini_next_structural(&parser->index, value_end);
+            if (cini_internal_is_line_end(parser, value_end))
+            {
+                if ( ! cini_internal_check_encoding(parser))
+                {
+                    return 0;
+                }
+                cini_internal_fail(
+                    parser,
+                    CINI_SYNTAX_ERROR,
+                    CINI_LOG_UNCLOSED_QUOTED_VALUE,
+                    value_start
+                );
+                return 0;
+            }
+            char character = parser->source[value_end];
+            if (character == '"')
+            {
+                break;
+            }
+            if (character == '\\')
+            {
+                has_escapes = true;
 
-    return 0;
-}
+                // Jump over the escaped character, unless it is the
+                // end of the line, which is caught in the next round.
 
-CiniSection * cini_internal_find_sub_section(
-    CiniDocument *document,
-    CiniSection *section,
-    const char *sub_section_name
-) {
-    uint_fast32_t sub_section_index = 0;
-    while (sub_section_index < section->num_sub_sections)
-    {
+                if ( ! cini_internal_is_line_end(parser, value_end + 1))
+                {
+                    ++value_end;
+                }
+            }
+            ++value_end;
+        }
+        line_end = cini_internal_skip_whitespace(parser, value_end + 1);
         if (
-            ! strcmp(
-                section->sub_sections[sub_section_index]->name,
-                sub_section_name
-        )) {
-            return section->sub_sections[sub_section_index];
+             ( ! cini_internal_is_line_end(parser, line_end))
+          && (parser->source[line_end] != ';')
+          && (parser->source[line_end] != '#')
+        ) {
+            cini_internal_fail(
+                parser,
+                CINI_SYNTAX_ERROR,
+                CINI_LOG_CHARACTERS_AFTER_VALUE,
+                line_end
+            );
+            return 0;
         }
-        ++sub_section_index;
+        line_end = cini_internal_find_line_end(parser, line_end);
+        ++value_start;
+        len_value = value_end - value_start;
     }
-    return NULL;
-}
-
-CiniSection * cini_internal_find_section(
-    CiniDocument *document,
-    const char **path
-) {
-    // The section currently deepest into the
-    // hierarchy that matches the query.
-    CiniSection *section = document->root_section;
-    uint_fast32_t path_element_index = 0;
-    while (path[path_element_index])
-    {
-        section = cini_internal_find_sub_section(
-            document,
-            section,
-            path[path_element_index]
-        );
-        if ( ! section)
-        {
-            break;
+    else
+    {
+        line_end = cini_internal_find_line_end(parser, value_start);
+        uint_fast32_t value_end = line_end;
+        while (
+             (value_end > value_start)
+          && cini_is_whitespace(parser->source[value_end - 1])
+        ) {
+            --value_end;
         }
-        ++path_element_index;
+        len_value = value_end - value_start;
     }
-    return section;
-}
 
-CiniSection * cini_internal_add_sub_section(
-    CiniDocument *document,
-    CiniSection *section,
-    const char *name
-) {
-    if(section->sub_sections == NULL)
+    if ( ! cini_internal_check_encoding(parser))
     {
-        section->sub_sections_capacity = 4;
-        section->sub_sections = cini_arena_alloc(
-            document->arena,
-            section->sub_sections_capacity
-          * sizeof(CiniSection *)
-        );
+        return 0;
     }
-    if (
-        section->num_sub_sections
-      >= section->sub_sections_capacity
-    ) {
-        section->sub_sections_capacity *= 2;
-        CiniSection **resized_sub_sections = cini_arena_alloc(
-            document->arena,
-            section->sub_sections_capacity * sizeof(CiniSection *)
-        );
-        memcpy(
-            resized_sub_sections,
-            section->sub_sections,
-            section->num_sub_sections * sizeof(CiniSection *)
-        );
-        section->sub_sections = resized_sub_sections;
+    if (parser->handler)
+    {
+        CiniSlice key = {&parser->source[key_start], key_end - key_start};
+        CiniSlice value = {&parser->source[value_start], len_value};
+        if ( ! parser->handler->fn_field(
+            &key,
+            &value,
+            has_escapes,
+            parser->handler->userdata
+        )) {
+            parser->stopped = true;
+        }
+        return line_end - offset;
     }
-    CiniSection *sub_section = cini_arena_alloc(
-        document->arena,
-        sizeof(CiniSection)
-    );
-    sub_section->name = cini_arena_copy_string(
-        document->arena,
-        name
-    );
-    memset(sub_section, 0, sizeof(CiniSection));
-    section->sub_sections[section->num_sub_sections] = sub_section;
-    ++section->num_sub_sections;
-    return sub_section;
-}
 
-CiniSection * cini_internal_force_create_section(
-    CiniDocument *document,
-    const char **path
-) {
-    // The section currently deepest into the
-    // hierarchy that matches the query.
-    CiniSection *section = document->root_section;
-    uint_fast32_t path_element_index = 0;
-    while (path[path_element_index])
-    {
-        CiniSection *sub_section = cini_internal_find_sub_section(
-            document,
-            section,
-            path[path_element_index]
+    // Store the value where it lives as long as the document
+
+    const char *value;
+    bool value_terminated = ! parser->borrow_source;
+    if (has_escapes)
+    {
+        value_terminated = true;
+        value = cini_internal_copy_escaped(
+            parser,
+            value_start,
+            value_start + len_value,
+            &len_value
         );
-        if ( ! sub_section)
-        {
-            break;
-        }
-        section = sub_section;
-        ++path_element_index;
     }
-    while (path[path_element_index])
+    else
     {
-        CiniSection *sub_section = cini_internal_add_sub_section(
-            document,
-            section,
-            path[path_element_index]
-        );
-        if ( ! sub_section)
-        {
-            /// @todo This indicates an allocation failure.
-        }
-        section = sub_section;
-        ++path_element_index;
+        value = cini_internal_store_slice(parser, value_start, len_value);
     }
-    return section;
+    cini_internal_add_field(
+        parser->document,
+        active_section,
+        &parser->source[key_start],
+        key_end - key_start,
+        ! parser->borrow_source,
+        value,
+        len_value,
+        value_terminated
+    );
+    return line_end - offset;
 }
 
-CiniSection * cini_internal_find_or_create_section(
+void cini_internal_init_parser(
+    struct CiniParser *parser,
     CiniDocument *document,
-    const char **path
+    bool borrow_source
 ) {
-    CiniSection *section = cini_internal_find_section(
-        document,
-        path
-    );
-    if (section)
+    parser->document = document;
+    parser->status = CINI_SUCCESS;
+    parser->source = NULL;
+    parser->len_source = 0;
+    parser->borrow_source = borrow_source;
+    parser->active_section = NULL;
+    if (document)
     {
-        return section;
+        parser->active_section = document->root_section;
+    }
+    parser->pending = NULL;
+    parser->len_pending = 0;
+    parser->pending_capacity = 0;
+    parser->handler = NULL;
+    parser->path_buffer = NULL;
+    parser->stopped = false;
+    parser->base_offset = 0;
+    parser->base_line = 0;
+    parser->profiler = NULL;
+    if (document)
+    {
+        parser->profiler = document->profiler;
     }
-    return cini_internal_force_create_section(
-        document,
-        path
-    );
 }
 
-int_fast8_t cini_parse_source_limited(
-    CiniDocument *buffer,
+/// @brief Parse a block of complete lines, continuing in the section
+///        in which the previous block ended.
+/// @return
+/// The parser's status after the block.
+int_fast8_t cini_internal_parse_lines(
+    struct CiniParser *parser,
     const char *source,
     uint_fast32_t len_source
 ) {
-    if (buffer->root_section == NULL)
-    {
-        puts("Not Initialized: Documents must be initialized before parsing.");
-        return CINI_NOT_INITIALIZED;
-    }
-
-    struct CiniParser parser;
-    parser.document = buffer;
-    parser.status = CINI_SUCCESS;
-    parser.source = source;
-    parser.len_source = len_source;
-
-    CiniSection *current_section = parser.document->root_section;
+    CINI_PROFILE_BEGIN(parser->profiler, timer);
+    parser->source = source;
+    parser->len_source = len_source;
+    cini_init_structural_index(&parser->index, source, len_source);
+    parser->index.profiler = parser->profiler;
 
     uint_fast32_t offset = 0;
-    while (offset < parser.len_source)
+    while ((offset < parser->len_source) && ( ! parser->stopped))
     {
-        uint_fast32_t len_character;
-        uint_least32_t  character = cini_extract_utf8(
-            parser.source,
-            offset,
-            &len_character
-        );
-        if ( ! len_character)
+        if ( ! cini_internal_check_encoding(parser))
+        {
+            break;
+        }
+        offset = cini_internal_skip_whitespace(parser, offset);
+        if (offset >= parser->len_source)
         {
-            parser.status = CINI_GENERIC_INTERNAL_ERROR;
             break;
         }
+        char character = parser->source[offset];
+        if ((character == '\n') || (character == '\r'))
+        {
+            offset = cini_internal_skip_newline(parser, offset);
+            continue;
+        }
+        if ((character == ';') || (character == '#'))
+        {
+            offset = cini_internal_find_line_end(parser, offset);
+            continue;
+        }
         if (character == '[')
         {
-            char **section_path = NULL;
+            CiniSlice *section_path = NULL;
+            uint_fast32_t num_levels = 0;
 
-            // 'status' contains the number of section path elements
+            // 'status' contains the number of bytes of the header
             // OR zero, if the parsing process failed there.
             uint_fast32_t status = cini_internal_parse_section_header(
-                &parser,
+                parser,
                 offset,
-                &section_path
+                &section_path,
+                &num_levels
             );
             if (status == 0)
             {
                 break;
             }
-            offset += status;
+            offset = cini_internal_skip_whitespace(parser, offset + status);
+            if (
+                 ( ! cini_internal_is_line_end(parser, offset))
+              && (parser->source[offset] != ';')
+              && (parser->source[offset] != '#')
+            ) {
+                cini_internal_fail(
+                    parser,
+                    CINI_SYNTAX_ERROR,
+                    CINI_LOG_CHARACTERS_AFTER_HEADER,
+                    offset
+                );
+                break;
+            }
+            offset = cini_internal_find_line_end(parser, offset);
+            if (parser->handler)
+            {
+                if ( ! parser->handler->fn_section(
+                    section_path,
+                    num_levels,
+                    parser->handler->userdata
+                )) {
+                    parser->stopped = true;
+                }
+                continue;
+            }
+            CINI_PROFILE_BEGIN(parser->profiler, section_timer);
             CiniSection *section = cini_internal_find_or_create_section(
-                parser.document,
-                (const char **) section_path
+                parser->document,
+                section_path,
+                num_levels,
+                ! parser->borrow_source
             );
-            current_section = section;
+            CINI_PROFILE_END(parser->profiler, section_timer, section_ns);
+            CINI_PROFILE_COUNT(parser->profiler, num_headers, 1);
+            parser->active_section = section;
+            continue;
         }
-        offset += len_character;
+        CINI_PROFILE_BEGIN(parser->profiler, field_timer);
+        uint_fast32_t len_field = cini_internal_parse_field(
+            parser,
+            offset,
+            parser->active_section
+        );
+        CINI_PROFILE_END(parser->profiler, field_timer, field_ns);
+        if (len_field == 0)
+        {
+            break;
+        }
+        CINI_PROFILE_COUNT(parser->profiler, num_fields, 1);
+        offset += len_field;
+    }
+
+    // A streaming parser's next block follows this one.
+
+    parser->base_offset += len_source;
+    if (parser->document && parser->document->log_entries)
+    {
+        parser->base_line += cini_internal_count_lines(source, len_source);
+    }
+    CINI_PROFILE_END(parser->profiler, timer, other_ns);
+    return parser->status;
+}
+
+/// @brief Parse a source into a document.
+/// @param borrow_source
+///        Whether the document owns the source, so that the parsed
+///        strings can point into it instead of being copied.
+int_fast8_t cini_internal_parse_serially(
+    CiniDocument *document,
+    const char *source,
+    uint_fast32_t len_source,
+    bool borrow_source
+) {
+    struct CiniParser parser;
+    cini_internal_init_parser(&parser, document, borrow_source);
+    return cini_internal_parse_lines(&parser, source, len_source);
+}
+
+CiniSection * cini_internal_parse_header_line(
+    CiniDocument *document,
+    const char *line,
+    uint_fast32_t len_line,
+    int_fast8_t *status
+) {
+    struct CiniParser parser;
+    cini_internal_init_parser(&parser, document, false);
+    *status = cini_internal_parse_lines(&parser, line, len_line);
+    return parser.active_section;
+}
+
+int_fast8_t cini_internal_parse_source(
+    CiniDocument *buffer,
+    const char *source,
+    uint_fast32_t len_source,
+    bool borrow_source
+) {
+    if (buffer->root_section == NULL)
+    {
+        return CINI_NOT_INITIALIZED;
+    }
+    if (buffer->is_frozen)
+    {
+        return CINI_DOCUMENT_FROZEN;
     }
-    return parser.status;
+    ++buffer->generation;
+    cini_internal_forget_source_blocks(buffer);
+
+    if (buffer->num_parse_threads > 1)
+    {
+        return cini_internal_parse_in_parallel(
+            buffer,
+            source,
+            len_source,
+            borrow_source
+        );
+    }
+    return cini_internal_parse_serially(
+        buffer,
+        source,
+        len_source,
+        borrow_source
+    );
+}
+
+int_fast8_t cini_parse_source_limited(
+    CiniDocument *buffer,
+    const char *source,
+    uint_fast32_t len_source
+) {
+    // The caller keeps the ownership of the source, so everything
+    // that is parsed from it gets copied into the document.
+
+    return cini_internal_parse_source(
+        buffer,
+        source,
+        len_source,
+        false
+    );
 }
 
 int_fast8_t cini_parse_source(
@@ -572,13 +933,66 @@ int_fast8_t cini_parse_source(
     );
 }
 
-int_fast8_t cini_parse_file_pointer(
+void cini_internal_register_source_buffer(
+    CiniDocument *document,
+    void *address,
+    uint_fast32_t length,
+    bool is_mapping
+) {
+    CiniSourceBuffer *source_buffer = cini_arena_alloc(
+        document->arena,
+        sizeof(CiniSourceBuffer)
+    );
+    source_buffer->address = address;
+    source_buffer->length = length;
+    source_buffer->is_mapping = is_mapping;
+    source_buffer->next = document->source_buffers;
+    document->source_buffers = source_buffer;
+}
+
+/// @brief Stream everything that is left in a file descriptor which
+///        can't be mapped, like a pipe, into the document.
+int_fast8_t cini_internal_parse_unmappable_fd(
     CiniDocument *buffer,
-    FILE *pointer
+    int fd
+) {
+    CiniParser *parser = cini_parser_begin(buffer);
+    if ( ! parser)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    char chunk[CINI_STREAM_CHUNK_SIZE];
+    while (true)
+    {
+        ssize_t len_read = read(fd, chunk, CINI_STREAM_CHUNK_SIZE);
+        if (len_read < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            cini_internal_free_parser(parser);
+            return CINI_FILE_NOT_FOUND;
+        }
+        if (len_read == 0)
+        {
+            break;
+        }
+        if (cini_parser_feed(parser, chunk, len_read) != CINI_SUCCESS)
+        {
+            break;
+        }
+    }
+    return cini_parser_end(parser);
+}
+
+int_fast8_t cini_parse_fd(
+    CiniDocument *buffer,
+    int fd
 ) {
     // Validate arguments
 
-    if (( ! buffer) || ( ! pointer))
+    if ( ! buffer)
     {
         return CINI_INVALID_POINTER;
     }
@@ -586,35 +1000,88 @@ int_fast8_t cini_parse_file_pointer(
     {
         return CINI_NOT_INITIALIZED;
     }
-    // Get the file's length
+    if (buffer->is_frozen)
+    {
+        return CINI_DOCUMENT_FROZEN;
+    }
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0)
+    {
+        return CINI_FILE_NOT_FOUND;
+    }
+    if ( ! S_ISREG(file_status.st_mode))
+    {
+        return cini_internal_parse_unmappable_fd(buffer, fd);
+    }
+    if (file_status.st_size == 0)
+    {
+        return CINI_SUCCESS;
+    }
+    if (((uint64_t) file_status.st_size) > UINT32_MAX)
+    {
+        return CINI_LIMITATION_EXCEEDED;
+    }
+    uint_fast32_t len_file = file_status.st_size;
 
-    fseek(pointer, 0, SEEK_END);
-    uint_fast32_t len_file = ftell(pointer);
-    fseek(pointer, 0, SEEK_SET);
-    
-    // Allocate memory for the source
+    // Map the file and let the document own the mapping, so that the
+    // parsed strings can point into it without being copied.
 
-    char *source = cini_arena_alloc(
-        buffer->arena,
-        len_file + 1
-    );
+    void *mapping = mmap(NULL, len_file, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return cini_internal_parse_unmappable_fd(buffer, fd);
+    }
+    madvise(mapping, len_file, MADV_SEQUENTIAL);
+    cini_internal_register_source_buffer(buffer, mapping, len_file, true);
 
-    // Read complete file into buffer
+    return cini_internal_parse_source(buffer, mapping, len_file, true);
+}
 
-    fread(
-        source,
-        len_file,
-        1,
-        pointer
-    );
-    source[len_file] = 0x00;
+int_fast8_t cini_parse_file_pointer(
+    CiniDocument *buffer,
+    FILE *pointer
+) {
+    // Validate arguments
 
-    // Pass the source buffer to cini_parse_source
+    if (( ! buffer) || ( ! pointer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if ( ! buffer->arena)
+    {
+        return CINI_NOT_INITIALIZED;
+    }
+    if (buffer->is_frozen)
+    {
+        return CINI_DOCUMENT_FROZEN;
+    }
+    // Stream the file in chunks, which works for pipes and terminals
+    // as well and doesn't need the whole file in memory.
 
-    return cini_parse_source(
-        buffer,
-        source
-    );
+    CiniParser *parser = cini_parser_begin(buffer);
+    if ( ! parser)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    char chunk[CINI_STREAM_CHUNK_SIZE];
+    while (true)
+    {
+        size_t len_read = fread(chunk, 1, CINI_STREAM_CHUNK_SIZE, pointer);
+        if (len_read == 0)
+        {
+            break;
+        }
+        if (cini_parser_feed(parser, chunk, len_read) != CINI_SUCCESS)
+        {
+            break;
+        }
+    }
+    if (ferror(pointer))
+    {
+        cini_internal_free_parser(parser);
+        return CINI_FILE_NOT_FOUND;
+    }
+    return cini_parser_end(parser);
 }
 
 int_fast8_t cini_parse_from_path(
@@ -627,15 +1094,236 @@ int_fast8_t cini_parse_from_path(
     {
         return CINI_INVALID_POINTER;
     }
-    FILE *file = fopen(path, "r");
-    if ( ! file)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
     {
         return CINI_FILE_NOT_FOUND;
     }
-    // Pass the file-pointer to cini_parse_file_pointer
+    // Pass the file descriptor to cini_parse_fd, the mapping stays
+    // valid after the descriptor is closed.
+
+    int_fast8_t status = cini_parse_fd(buffer, fd);
+    close(fd);
+    return status;
+}
+
+
+
+
+// ==> Streaming
+
+CiniParser * cini_parser_begin(
+    CiniDocument *document
+) {
+    if (
+         ( ! document)
+      || ( ! document->root_section)
+      || document->is_frozen
+    ) {
+        return NULL;
+    }
+    CiniParser *parser = document->fn_alloc(
+        sizeof(CiniParser),
+        document->allocator
+    );
+    if ( ! parser)
+    {
+        return NULL;
+    }
+    ++document->generation;
+    cini_internal_forget_source_blocks(document);
+
+    // The chunks are only borrowed, so everything gets copied.
+
+    cini_internal_init_parser(parser, document, false);
+    return parser;
+}
+
+void cini_internal_free_parser(
+    CiniParser *parser
+) {
+    CiniDocument *document = parser->document;
+    if (parser->pending)
+    {
+        document->fn_free(parser->pending, document->allocator);
+    }
+    document->fn_free(parser, document->allocator);
+}
+
+/// @brief Append bytes to the line which was cut off by a chunk's end.
+bool cini_internal_append_pending(
+    CiniParser *parser,
+    const char *bytes,
+    uint_fast32_t len_bytes
+) {
+    if (len_bytes == 0)
+    {
+        return true;
+    }
+    CiniDocument *document = parser->document;
+    if ((parser->len_pending + len_bytes) > parser->pending_capacity)
+    {
+        uint_fast32_t capacity = parser->pending_capacity;
+        if (capacity == 0)
+        {
+            capacity = 256;
+        }
+        while (capacity < (parser->len_pending + len_bytes))
+        {
+            if (capacity > (UINT32_MAX / 2))
+            {
+                return false;
+            }
+            capacity *= 2;
+        }
+        char *pending = document->fn_alloc(capacity, document->allocator);
+        if ( ! pending)
+        {
+            return false;
+        }
+        if (parser->pending)
+        {
+            memcpy(pending, parser->pending, parser->len_pending);
+            document->fn_free(parser->pending, document->allocator);
+        }
+        parser->pending = pending;
+        parser->pending_capacity = capacity;
+    }
+    memcpy(&parser->pending[parser->len_pending], bytes, len_bytes);
+    parser->len_pending += len_bytes;
+    return true;
+}
+
+int_fast8_t cini_parser_feed(
+    CiniParser *parser,
+    const char *chunk,
+    uint_fast32_t len_chunk
+) {
+    if (( ! parser) || (( ! chunk) && (len_chunk > 0)))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if (parser->status != CINI_SUCCESS)
+    {
+        return parser->status;
+    }
+
+    // Only complete lines are parsed. A newline is never part of a
+    // multi-byte UTF-8 sequence, so a block of complete lines doesn't
+    // start or end within a rune either.
+
+    uint_fast32_t first_line_end = 0;
+    while (
+         (first_line_end < len_chunk)
+      && (chunk[first_line_end] != '\n')
+      && (chunk[first_line_end] != '\r')
+    ) {
+        ++first_line_end;
+    }
+    if (first_line_end == len_chunk)
+    {
+        if ( ! cini_internal_append_pending(parser, chunk, len_chunk))
+        {
+            parser->status = CINI_ALLOCATION_FAILURE;
+        }
+        return parser->status;
+    }
+    uint_fast32_t last_line_end = len_chunk - 1;
+    while ((chunk[last_line_end] != '\n') && (chunk[last_line_end] != '\r'))
+    {
+        --last_line_end;
+    }
+
+    // Complete the line which the previous chunk cut off
+
+    uint_fast32_t offset = 0;
+    if (parser->len_pending > 0)
+    {
+        offset = first_line_end + 1;
+        if ( ! cini_internal_append_pending(parser, chunk, offset))
+        {
+            parser->status = CINI_ALLOCATION_FAILURE;
+            return parser->status;
+        }
+        uint_fast32_t len_line = parser->len_pending;
+        parser->len_pending = 0;
+        if (
+            cini_internal_parse_lines(parser, parser->pending, len_line)
+            != CINI_SUCCESS
+        ) {
+            return parser->status;
+        }
+    }
+
+    // Parse the chunk's complete lines in place and keep its last,
+    // incomplete line for the next chunk.
 
-    int_fast8_t status = cini_parse_file_pointer(buffer, file);
-    fclose(file);
+    if (offset <= last_line_end)
+    {
+        if (
+            cini_internal_parse_lines(
+                parser,
+                &chunk[offset],
+                (last_line_end + 1) - offset
+            ) != CINI_SUCCESS
+        ) {
+            return parser->status;
+        }
+    }
+    if ( ! cini_internal_append_pending(
+        parser,
+        &chunk[last_line_end + 1],
+        len_chunk - (last_line_end + 1)
+    )) {
+        parser->status = CINI_ALLOCATION_FAILURE;
+    }
+    return parser->status;
+}
+
+int_fast8_t cini_parser_end(
+    CiniParser *parser
+) {
+    if ( ! parser)
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if ((parser->status == CINI_SUCCESS) && (parser->len_pending > 0))
+    {
+        cini_internal_parse_lines(
+            parser,
+            parser->pending,
+            parser->len_pending
+        );
+    }
+    int_fast8_t status = parser->status;
+    cini_internal_free_parser(parser);
     return status;
 }
 
+
+
+
+// ==> Handlers
+
+int_fast8_t cini_parse_with_handler(
+    const CiniHandler *handler,
+    const char *source,
+    uint_fast32_t len_source
+) {
+    if (
+         ( ! handler)
+      || ( ! handler->fn_section)
+      || ( ! handler->fn_field)
+      || (( ! source) && (len_source > 0))
+    ) {
+        return CINI_INVALID_POINTER;
+    }
+    CiniSlice path_buffer[CINI_MAX_HANDLER_LEVELS];
+
+    struct CiniParser parser;
+    cini_internal_init_parser(&parser, NULL, true);
+    parser.handler = handler;
+    parser.path_buffer = path_buffer;
+    return cini_internal_parse_lines(&parser, source, len_source);
+}
+
@@ -0,0 +1,49 @@
+#include <cini/profile.h>
+
+#include <time.h>
+
+uint64_t cini_internal_read_profile_clock()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return ((uint64_t) time.tv_sec * 1000000000) + time.tv_nsec;
+}
+
+void cini_internal_begin_phase(
+    CiniProfiler *profiler,
+    CiniPhaseTimer *timer
+) {
+    timer->start_ns = cini_internal_read_profile_clock();
+    timer->timed_ns = profiler->timed_ns;
+}
+
+void cini_internal_end_phase(
+    CiniProfiler *profiler,
+    CiniPhaseTimer *timer,
+    uint64_t *phase_ns
+) {
+    uint64_t elapsed_ns = cini_internal_read_profile_clock()
+        - timer->start_ns;
+    uint64_t nested_ns = profiler->timed_ns - timer->timed_ns;
+    *phase_ns += elapsed_ns - nested_ns;
+
+    // The enclosing phase subtracts this one as a whole.
+
+    profiler->timed_ns = timer->timed_ns + elapsed_ns;
+}
+
+uint64_t cini_internal_count_runes(
+    const char *text,
+    uint_fast32_t len_text
+) {
+    uint64_t num_runes = 0;
+    for (uint_fast32_t offset = 0; offset < len_text; ++offset)
+    {
+        if ((((uint8_t) text[offset]) & 0xc0) != 0x80)
+        {
+            ++num_runes;
+        }
+    }
+    return num_runes;
+}
+
@@ -0,0 +1,589 @@
+#include <cini/compiled.h>
+#include <cini/field.h>
+#include <cini/query.h>
+#include <cini/section.h>
+
+#include <stddef.h>
+#include <string.h>
+
+// ==> Section Topology
+
+void cini_internal_update_section_table(
+    CiniDocument *document
+) {
+    uint_fast32_t num_sections = document->num_sections - 1;
+    if (document->len_section_table == num_sections)
+    {
+        return;
+    }
+    document->section_table = cini_arena_alloc(
+        document->arena,
+        num_sections * sizeof(CiniSection *)
+    );
+    uint_fast32_t section_index = 0;
+    CiniSection *section = document->first_section->linear_next;
+    while (section)
+    {
+        document->section_table[section_index] = section;
+        ++section_index;
+        section = section->linear_next;
+    }
+    document->len_section_table = num_sections;
+}
+
+int_fast32_t cini_get_section_count(
+    CiniDocument *document,
+    const char *super_section
+) {
+    if ( ! document)
+    {
+        return CINI_INVALID_POINTER;
+    }
+    if ( ! super_section)
+    {
+        // The root section isn't counted, it has no header.
+        return document->num_sections - 1;
+    }
+    if (document->compiled)
+    {
+        const CiniCompiledSection *compiled_section =
+            cini_internal_resolve_compiled_section(
+                document->compiled,
+                super_section,
+                strlen(super_section)
+            );
+        if ( ! compiled_section)
+        {
+            return CINI_SECTION_NONEXISTENT;
+        }
+        return compiled_section->num_sub_sections;
+    }
+    CiniSection *section = cini_internal_resolve_section(
+        document,
+        super_section,
+        strlen(super_section)
+    );
+    if ( ! section)
+    {
+        return CINI_SECTION_NONEXISTENT;
+    }
+    return section->num_sub_sections;
+}
+
+const char * cini_get_section_name(
+    CiniDocument *document,
+    const char *super_section,
+    uint_fast32_t index
+) {
+    if ( ! document)
+    {
+        return NULL;
+    }
+    if (document->compiled)
+    {
+        return cini_internal_get_compiled_section_name(
+            document->compiled,
+            super_section,
+            index
+        );
+    }
+    if ( ! super_section)
+    {
+        cini_internal_update_section_table(document);
+        if (index >= document->len_section_table)
+        {
+            return NULL;
+        }
+        return cini_internal_get_full_name(
+            document,
+            document->section_table[index]
+        );
+    }
+    CiniSection *section = cini_internal_resolve_section(
+        document,
+        super_section,
+        strlen(super_section)
+    );
+    if (( ! section) || (index >= section->num_sub_sections))
+    {
+        return NULL;
+    }
+    return cini_internal_get_full_name(
+        document,
+        section->sub_sections[index]
+    );
+}
+
+
+
+// ==> Value Gathering
+
+/// @brief Find the field which a `<section>:<key>` query refers to.
+///        The query is split at its last colon; without a colon or
+///        with an empty section part, the key is in the root section.
+/// @param section
+///        Pointer to where to put the resolved section, or `NULL`. Loaded
+///        compiled documents have no sections; it is set to `NULL` then.
+/// @param status
+///        Pointer to where to put `CINI_SECTION_NONEXISTENT` or
+///        `CINI_KEY_NONEXISTENT` if the field wasn't found.
+/// @param scratch
+///        Field into which a field of a loaded compiled document is
+///        exposed.
+/// @return
+/// The field or `NULL` if it doesn't exist.
+CiniField * cini_internal_resolve_query(
+    CiniDocument *document,
+    const char *query,
+    uint_fast32_t len_query,
+    CiniSection **section,
+    CiniStatus *status,
+    CiniField *scratch
+) {
+    uint_fast32_t key_start = len_query;
+    while ((key_start > 0) && (query[key_start - 1] != ':'))
+    {
+        --key_start;
+    }
+    uint_fast32_t len_section_path = 0;
+    if (key_start > 1)
+    {
+        len_section_path = key_start - 1;
+    }
+    uint_fast32_t len_key = len_query - key_start;
+    if (section)
+    {
+        *section = NULL;
+    }
+
+    if (document->compiled)
+    {
+        const CiniCompiledSection *compiled_section =
+            cini_internal_resolve_compiled_section(
+                document->compiled,
+                query,
+                len_section_path
+            );
+        if ( ! compiled_section)
+        {
+            *status = CINI_SECTION_NONEXISTENT;
+            return NULL;
+        }
+        const CiniCompiledField *compiled_field =
+            cini_internal_find_compiled_field(
+                document->compiled,
+                compiled_section,
+                &query[key_start],
+                len_key
+            );
+        if ( ! compiled_field)
+        {
+            *status = CINI_KEY_NONEXISTENT;
+            return NULL;
+        }
+        cini_internal_expose_compiled_field(
+            document->compiled,
+            compiled_field,
+            scratch
+        );
+        return scratch;
+    }
+
+    CiniSection *key_section = document->root_section;
+    if (len_section_path > 0)
+    {
+        key_section = cini_internal_resolve_section(
+            document,
+            query,
+            len_section_path
+        );
+        if ( ! key_section)
+        {
+            *status = CINI_SECTION_NONEXISTENT;
+            return NULL;
+        }
+    }
+    if (section)
+    {
+        *section = key_section;
+    }
+    CiniField *field = cini_internal_find_field(
+        key_section,
+        &query[key_start],
+        len_key,
+        cini_hash_string(&query[key_start], len_key)
+    );
+    if ( ! field)
+    {
+        *status = CINI_KEY_NONEXISTENT;
+        return NULL;
+    }
+    return field;
+}
+
+int_fast8_t cini_internal_read_bool(
+    CiniField *field,
+    bool *buffer
+) {
+    CiniField scratch;
+    const CiniField *decoded = cini_internal_get_decoded(field, &scratch);
+    if ( ! (decoded->applicable_types & CINI_VALUE_BOOLEAN))
+    {
+        return CINI_TYPE_MISMATCH;
+    }
+    *buffer = decoded->boolean;
+    return CINI_SUCCESS;
+}
+
+int_fast8_t cini_internal_read_int(
+    CiniField *field,
+    int64_t *buffer
+) {
+    CiniField scratch;
+    const CiniField *decoded = cini_internal_get_decoded(field, &scratch);
+    if ( ! (decoded->applicable_types & CINI_VALUE_INTEGER))
+    {
+        return CINI_TYPE_MISMATCH;
+    }
+    *buffer = decoded->integer;
+    return CINI_SUCCESS;
+}
+
+int_fast8_t cini_internal_read_decimal(
+    CiniField *field,
+    double *buffer
+) {
+    CiniField scratch;
+    const CiniField *decoded = cini_internal_get_decoded(field, &scratch);
+    if ( ! (decoded->applicable_types & CINI_VALUE_DECIMAL))
+    {
+        return CINI_TYPE_MISMATCH;
+    }
+    *buffer = decoded->decimal;
+    return CINI_SUCCESS;
+}
+
+const char * cini_internal_read_text(
+    CiniDocument *document,
+    CiniField *field
+) {
+    if ( ! (field->flags & CINI_FIELD_VALUE_TERMINATED))
+    {
+        // Values which point into the source aren't followed by a zero;
+        // they are copied the first time they're requested as a string.
+
+        field->value = cini_arena_copy_slice(
+            document->arena,
+            field->value,
+            field->len_value
+        );
+        field->value_capacity = field->len_value;
+        field->flags |= CINI_FIELD_VALUE_TERMINATED | CINI_FIELD_VALUE_OWNED;
+    }
+    return field->value;
+}
+
+int_fast8_t cini_get_bool(
+    CiniDocument *document,
+    const char *query,
+    bool *buffer
+) {
+    if (( ! document) || ( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniField scratch;
+    CiniField *field = cini_internal_resolve_query(
+        document,
+        query,
+        strlen(query),
+        NULL,
+        &status,
+        &scratch
+    );
+    if ( ! field)
+    {
+        return status;
+    }
+    return cini_internal_read_bool(field, buffer);
+}
+
+int_fast8_t cini_get_int(
+    CiniDocument *document,
+    const char *query,
+    int64_t *buffer
+) {
+    if (( ! document) || ( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniField scratch;
+    CiniField *field = cini_internal_resolve_query(
+        document,
+        query,
+        strlen(query),
+        NULL,
+        &status,
+        &scratch
+    );
+    if ( ! field)
+    {
+        return status;
+    }
+    return cini_internal_read_int(field, buffer);
+}
+
+int_fast8_t cini_get_decimal(
+    CiniDocument *document,
+    const char *query,
+    double *buffer
+) {
+    if (( ! document) || ( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniField scratch;
+    CiniField *field = cini_internal_resolve_query(
+        document,
+        query,
+        strlen(query),
+        NULL,
+        &status,
+        &scratch
+    );
+    if ( ! field)
+    {
+        return status;
+    }
+    return cini_internal_read_decimal(field, buffer);
+}
+
+const char * cini_get_text(
+    CiniDocument *document,
+    const char *query
+) {
+    if (( ! document) || ( ! query))
+    {
+        return NULL;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniField scratch;
+    CiniField *field = cini_internal_resolve_query(
+        document,
+        query,
+        strlen(query),
+        NULL,
+        &status,
+        &scratch
+    );
+    if ( ! field)
+    {
+        return NULL;
+    }
+    return cini_internal_read_text(document, field);
+}
+
+int_fast32_t cini_get_value_types(
+    CiniDocument *document,
+    const char *query
+) {
+    if (( ! document) || ( ! query))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniField scratch;
+    CiniField *field = cini_internal_resolve_query(
+        document,
+        query,
+        strlen(query),
+        NULL,
+        &status,
+        &scratch
+    );
+    if ( ! field)
+    {
+        return status;
+    }
+    return cini_internal_get_decoded(field, &scratch)->applicable_types;
+}
+
+int_fast32_t cini_write_text(
+    CiniDocument *document,
+    const char *query,
+    char *buffer,
+    int_fast32_t len_buffer
+) {
+    if (( ! document) || ( ! query))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniStatus status = CINI_SUCCESS;
+    CiniField scratch;
+    CiniField *field = cini_internal_resolve_query(
+        document,
+        query,
+        strlen(query),
+        NULL,
+        &status,
+        &scratch
+    );
+    if ( ! field)
+    {
+        return status;
+    }
+    if ( ! buffer)
+    {
+        return field->len_value;
+    }
+    uint_fast32_t len_copy = field->len_value;
+    if (len_buffer >= 0)
+    {
+        if (len_buffer == 0)
+        {
+            return CINI_LIMITATION_EXCEEDED;
+        }
+        if (len_copy > (uint_fast32_t) (len_buffer - 1))
+        {
+            len_copy = len_buffer - 1;
+        }
+    }
+    memcpy(buffer, field->value, len_copy);
+    buffer[len_copy] = 0;
+    return CINI_SUCCESS;
+}
+
+
+
+// ==> Compiled Queries
+
+CiniQuery * cini_compile_query(
+    CiniDocument *document,
+    const char *query
+) {
+    if (( ! document) || ( ! query))
+    {
+        return NULL;
+    }
+    uint_fast32_t len_query = strlen(query);
+    CiniQuery *handle = document->fn_alloc(
+        sizeof(CiniQuery) + len_query + 1,
+        document->allocator
+    );
+    if ( ! handle)
+    {
+        return NULL;
+    }
+    handle->document = document;
+    handle->len_query = len_query;
+    memcpy(handle->query, query, len_query + 1);
+
+    // A generation which never matches the document's forces the first
+    // access to resolve the query.
+
+    handle->generation = document->generation - 1;
+    return handle;
+}
+
+void cini_free_query(
+    CiniQuery *query
+) {
+    if ( ! query)
+    {
+        return;
+    }
+    query->document->fn_free(query, query->document->allocator);
+}
+
+/// @brief Get the field a compiled query refers to, resolving the query
+///        again if the document has changed since it was last resolved.
+/// @return
+/// The field or `NULL` if it doesn't exist; the reason is left in the
+/// query's `status` then.
+CiniField * cini_internal_access_query(
+    CiniQuery *query
+) {
+    CiniDocument *document = query->document;
+    if (query->generation != document->generation)
+    {
+        query->status = CINI_SUCCESS;
+        query->section = NULL;
+        query->field = cini_internal_resolve_query(
+            document,
+            query->query,
+            query->len_query,
+            &query->section,
+            &query->status,
+            &query->exposed_field
+        );
+        query->generation = document->generation;
+    }
+    return query->field;
+}
+
+int_fast8_t cini_get_bool_q(
+    CiniQuery *query,
+    bool *buffer
+) {
+    if (( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniField *field = cini_internal_access_query(query);
+    if ( ! field)
+    {
+        return query->status;
+    }
+    return cini_internal_read_bool(field, buffer);
+}
+
+int_fast8_t cini_get_int_q(
+    CiniQuery *query,
+    int64_t *buffer
+) {
+    if (( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniField *field = cini_internal_access_query(query);
+    if ( ! field)
+    {
+        return query->status;
+    }
+    return cini_internal_read_int(field, buffer);
+}
+
+int_fast8_t cini_get_decimal_q(
+    CiniQuery *query,
+    double *buffer
+) {
+    if (( ! query) || ( ! buffer))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniField *field = cini_internal_access_query(query);
+    if ( ! field)
+    {
+        return query->status;
+    }
+    return cini_internal_read_decimal(field, buffer);
+}
+
+const char * cini_get_text_q(
+    CiniQuery *query
+) {
+    if ( ! query)
+    {
+        return NULL;
+    }
+    CiniField *field = cini_internal_access_query(query);
+    if ( ! field)
+    {
+        return NULL;
+    }
+    return cini_internal_read_text(query->document, field);
+}
+
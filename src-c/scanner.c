@@ -0,0 +1,671 @@
+#include <cini/scanner.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CINI_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+// ==> Scalar classification
+
+static const bool cini_structural_table[256] = {
+    ['\n'] = true,
+    ['\r'] = true,
+    ['"'] = true,
+    ['#'] = true,
+    [';'] = true,
+    ['='] = true,
+    ['['] = true,
+    ['\\'] = true,
+    [']'] = true,
+};
+
+bool cini_classify_scalar_range(
+    const char *bytes,
+    uint_fast32_t start,
+    uint_fast32_t end,
+    uint64_t *bits
+) {
+    uint8_t high_bits = 0;
+    uint_fast32_t offset = start;
+    while (offset < end)
+    {
+        uint8_t byte = bytes[offset];
+        if (cini_structural_table[byte])
+        {
+            bits[offset / 64] |= ((uint64_t) 1) << (offset % 64);
+        }
+        high_bits |= byte;
+        ++offset;
+    }
+    return (high_bits & 0x80) != 0;
+}
+
+bool cini_classify_scalar(
+    const char *bytes,
+    uint_fast32_t len_bytes,
+    uint64_t *bits
+) {
+    memset(bits, 0, sizeof(uint64_t) * (CINI_STRUCTURAL_WINDOW / 64));
+    return cini_classify_scalar_range(bytes, 0, len_bytes, bits);
+}
+
+
+
+// ==> SIMD classification
+
+#ifdef CINI_SCANNER_X86
+
+__attribute__((target("sse2")))
+bool cini_classify_sse2(
+    const char *bytes,
+    uint_fast32_t len_bytes,
+    uint64_t *bits
+) {
+    memset(bits, 0, sizeof(uint64_t) * (CINI_STRUCTURAL_WINDOW / 64));
+
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    const __m128i quotation_mark = _mm_set1_epi8('"');
+    const __m128i hash_sign = _mm_set1_epi8('#');
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i equals_sign = _mm_set1_epi8('=');
+    const __m128i opening_bracket = _mm_set1_epi8('[');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i closing_bracket = _mm_set1_epi8(']');
+
+    __m128i high_bits = _mm_setzero_si128();
+    uint_fast32_t offset = 0;
+    while ((offset + 16) <= len_bytes)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) &bytes[offset]);
+        high_bits = _mm_or_si128(high_bits, chunk);
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(
+                    _mm_cmpeq_epi8(chunk, newline),
+                    _mm_cmpeq_epi8(chunk, carriage_return)),
+                _mm_or_si128(
+                    _mm_cmpeq_epi8(chunk, quotation_mark),
+                    _mm_cmpeq_epi8(chunk, hash_sign))),
+            _mm_or_si128(
+                _mm_or_si128(
+                    _mm_cmpeq_epi8(chunk, semicolon),
+                    _mm_cmpeq_epi8(chunk, equals_sign)),
+                _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_cmpeq_epi8(chunk, opening_bracket),
+                        _mm_cmpeq_epi8(chunk, backslash)),
+                    _mm_cmpeq_epi8(chunk, closing_bracket)))
+        );
+        uint64_t mask = (uint16_t) _mm_movemask_epi8(matches);
+        bits[offset / 64] |= mask << (offset % 64);
+        offset += 16;
+    }
+    bool has_non_ascii = cini_classify_scalar_range(
+        bytes,
+        offset,
+        len_bytes,
+        bits
+    );
+    return has_non_ascii || (_mm_movemask_epi8(high_bits) != 0);
+}
+
+__attribute__((target("avx2")))
+bool cini_classify_avx2(
+    const char *bytes,
+    uint_fast32_t len_bytes,
+    uint64_t *bits
+) {
+    memset(bits, 0, sizeof(uint64_t) * (CINI_STRUCTURAL_WINDOW / 64));
+
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriage_return = _mm256_set1_epi8('\r');
+    const __m256i quotation_mark = _mm256_set1_epi8('"');
+    const __m256i hash_sign = _mm256_set1_epi8('#');
+    const __m256i semicolon = _mm256_set1_epi8(';');
+    const __m256i equals_sign = _mm256_set1_epi8('=');
+    const __m256i opening_bracket = _mm256_set1_epi8('[');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i closing_bracket = _mm256_set1_epi8(']');
+
+    __m256i high_bits = _mm256_setzero_si256();
+    uint_fast32_t offset = 0;
+    while ((offset + 32) <= len_bytes)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *) &bytes[offset]);
+        high_bits = _mm256_or_si256(high_bits, chunk);
+        __m256i matches = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(
+                    _mm256_cmpeq_epi8(chunk, newline),
+                    _mm256_cmpeq_epi8(chunk, carriage_return)),
+                _mm256_or_si256(
+                    _mm256_cmpeq_epi8(chunk, quotation_mark),
+                    _mm256_cmpeq_epi8(chunk, hash_sign))),
+            _mm256_or_si256(
+                _mm256_or_si256(
+                    _mm256_cmpeq_epi8(chunk, semicolon),
+                    _mm256_cmpeq_epi8(chunk, equals_sign)),
+                _mm256_or_si256(
+                    _mm256_or_si256(
+                        _mm256_cmpeq_epi8(chunk, opening_bracket),
+                        _mm256_cmpeq_epi8(chunk, backslash)),
+                    _mm256_cmpeq_epi8(chunk, closing_bracket)))
+        );
+        uint64_t mask = (uint32_t) _mm256_movemask_epi8(matches);
+        bits[offset / 64] |= mask << (offset % 64);
+        offset += 32;
+    }
+    bool has_non_ascii = cini_classify_scalar_range(
+        bytes,
+        offset,
+        len_bytes,
+        bits
+    );
+    return has_non_ascii || (_mm256_movemask_epi8(high_bits) != 0);
+}
+
+#endif // CINI_SCANNER_X86
+
+CiniClassifyFn cini_select_classifier()
+{
+#ifdef CINI_SCANNER_X86
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return cini_classify_avx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return cini_classify_sse2;
+    }
+#endif
+    return cini_classify_scalar;
+}
+
+
+
+// ==> UTF-8 validation
+
+bool cini_validate_utf8_scalar(
+    const char *source,
+    uint_fast32_t len_source,
+    uint_fast32_t *offset,
+    uint_fast32_t end
+) {
+    const uint8_t *bytes = (const uint8_t *) source;
+    uint_fast32_t cursor = *offset;
+    while (cursor < end)
+    {
+        uint8_t head_byte = bytes[cursor];
+        if (head_byte < 0x80)
+        {
+            ++cursor;
+            continue;
+        }
+        uint_fast32_t rune_length;
+        uint8_t lowest_second = 0x80;
+        uint8_t highest_second = 0xbf;
+        if ((head_byte >= 0xc2) && (head_byte <= 0xdf))
+        {
+            rune_length = 2;
+        }
+        else if ((head_byte >= 0xe0) && (head_byte <= 0xef))
+        {
+            rune_length = 3;
+
+            // Reject overlong encodings and UTF-16 surrogates
+            if (head_byte == 0xe0) lowest_second = 0xa0;
+            if (head_byte == 0xed) highest_second = 0x9f;
+        }
+        else if ((head_byte >= 0xf0) && (head_byte <= 0xf4))
+        {
+            rune_length = 4;
+
+            // Reject overlong encodings and runes above U+10FFFF
+            if (head_byte == 0xf0) lowest_second = 0x90;
+            if (head_byte == 0xf4) highest_second = 0x8f;
+        }
+        else
+        {
+            *offset = cursor;
+            return false;
+        }
+        if ((cursor + rune_length) > len_source)
+        {
+            *offset = cursor;
+            return false;
+        }
+        if (
+             (bytes[cursor + 1] < lowest_second)
+          || (bytes[cursor + 1] > highest_second)
+        ) {
+            *offset = cursor;
+            return false;
+        }
+        uint_fast32_t byte_index = 2;
+        while (byte_index < rune_length)
+        {
+            if ((bytes[cursor + byte_index] & 0xc0) != 0x80)
+            {
+                *offset = cursor;
+                return false;
+            }
+            ++byte_index;
+        }
+        cursor += rune_length;
+    }
+    *offset = cursor;
+    return true;
+}
+
+#ifdef CINI_SCANNER_X86
+
+__attribute__((target("sse2")))
+bool cini_validate_utf8_sse2(
+    const char *source,
+    uint_fast32_t len_source,
+    uint_fast32_t *offset,
+    uint_fast32_t end
+) {
+    // Skip over ASCII-only blocks and only look at the runes of blocks
+    // which actually contain multi-byte sequences.
+
+    uint_fast32_t cursor = *offset;
+    while ((cursor + 16) <= end)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) &source[cursor]);
+        if (_mm_movemask_epi8(chunk) == 0)
+        {
+            cursor += 16;
+            continue;
+        }
+        if ( ! cini_validate_utf8_scalar(source, len_source, &cursor, cursor + 16))
+        {
+            *offset = cursor;
+            return false;
+        }
+    }
+    *offset = cursor;
+    return cini_validate_utf8_scalar(source, len_source, offset, end);
+}
+
+// The AVX2 validator is the lookup algorithm of Keiser and Lemire
+// ("Validating UTF-8 In Less Than One Instruction Per Byte", 2021).
+// Every pair of adjacent bytes is classified through three nibble
+// lookups; the bits which remain set name the error between them.
+
+#define CINI_UTF8_TOO_SHORT (1 << 0)
+#define CINI_UTF8_TOO_LONG (1 << 1)
+#define CINI_UTF8_OVERLONG_3 (1 << 2)
+#define CINI_UTF8_TOO_LARGE (1 << 3)
+#define CINI_UTF8_SURROGATE (1 << 4)
+#define CINI_UTF8_OVERLONG_2 (1 << 5)
+#define CINI_UTF8_TOO_LARGE_1000 (1 << 6)
+#define CINI_UTF8_OVERLONG_4 (1 << 6)
+#define CINI_UTF8_TWO_CONTINUATIONS (1 << 7)
+#define CINI_UTF8_CARRY \
+    (CINI_UTF8_TOO_SHORT | CINI_UTF8_TOO_LONG | CINI_UTF8_TWO_CONTINUATIONS)
+
+static const uint8_t cini_utf8_table_byte_1_high[16] = {
+    // 0_______ ________ <ASCII in byte 1>
+    CINI_UTF8_TOO_LONG, CINI_UTF8_TOO_LONG,
+    CINI_UTF8_TOO_LONG, CINI_UTF8_TOO_LONG,
+    CINI_UTF8_TOO_LONG, CINI_UTF8_TOO_LONG,
+    CINI_UTF8_TOO_LONG, CINI_UTF8_TOO_LONG,
+    // 10______ ________ <continuation in byte 1>
+    CINI_UTF8_TWO_CONTINUATIONS, CINI_UTF8_TWO_CONTINUATIONS,
+    CINI_UTF8_TWO_CONTINUATIONS, CINI_UTF8_TWO_CONTINUATIONS,
+    // 1100____ ________ <two byte lead in byte 1>
+    CINI_UTF8_TOO_SHORT | CINI_UTF8_OVERLONG_2,
+    // 1101____ ________ <two byte lead in byte 1>
+    CINI_UTF8_TOO_SHORT,
+    // 1110____ ________ <three byte lead in byte 1>
+    CINI_UTF8_TOO_SHORT | CINI_UTF8_OVERLONG_3 | CINI_UTF8_SURROGATE,
+    // 1111____ ________ <four+ byte lead in byte 1>
+    CINI_UTF8_TOO_SHORT | CINI_UTF8_TOO_LARGE
+        | CINI_UTF8_TOO_LARGE_1000 | CINI_UTF8_OVERLONG_4
+};
+
+static const uint8_t cini_utf8_table_byte_1_low[16] = {
+    // ____0000 ________
+    CINI_UTF8_CARRY | CINI_UTF8_OVERLONG_3
+        | CINI_UTF8_OVERLONG_2 | CINI_UTF8_OVERLONG_4,
+    // ____0001 ________
+    CINI_UTF8_CARRY | CINI_UTF8_OVERLONG_2,
+    // ____001_ ________
+    CINI_UTF8_CARRY,
+    CINI_UTF8_CARRY,
+    // ____0100 ________
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE,
+    // ____0101 ________
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    // ____011_ ________
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    // ____1___ ________
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    // ____1101 ________
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE
+        | CINI_UTF8_TOO_LARGE_1000 | CINI_UTF8_SURROGATE,
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000,
+    CINI_UTF8_CARRY | CINI_UTF8_TOO_LARGE | CINI_UTF8_TOO_LARGE_1000
+};
+
+static const uint8_t cini_utf8_table_byte_2_high[16] = {
+    // ________ 0_______ <ASCII in byte 2>
+    CINI_UTF8_TOO_SHORT, CINI_UTF8_TOO_SHORT,
+    CINI_UTF8_TOO_SHORT, CINI_UTF8_TOO_SHORT,
+    CINI_UTF8_TOO_SHORT, CINI_UTF8_TOO_SHORT,
+    CINI_UTF8_TOO_SHORT, CINI_UTF8_TOO_SHORT,
+    // ________ 1000____
+    CINI_UTF8_TOO_LONG | CINI_UTF8_OVERLONG_2 | CINI_UTF8_TWO_CONTINUATIONS
+        | CINI_UTF8_OVERLONG_3 | CINI_UTF8_TOO_LARGE_1000
+        | CINI_UTF8_OVERLONG_4,
+    // ________ 1001____
+    CINI_UTF8_TOO_LONG | CINI_UTF8_OVERLONG_2 | CINI_UTF8_TWO_CONTINUATIONS
+        | CINI_UTF8_OVERLONG_3 | CINI_UTF8_TOO_LARGE,
+    // ________ 101_____
+    CINI_UTF8_TOO_LONG | CINI_UTF8_OVERLONG_2 | CINI_UTF8_TWO_CONTINUATIONS
+        | CINI_UTF8_SURROGATE | CINI_UTF8_TOO_LARGE,
+    CINI_UTF8_TOO_LONG | CINI_UTF8_OVERLONG_2 | CINI_UTF8_TWO_CONTINUATIONS
+        | CINI_UTF8_SURROGATE | CINI_UTF8_TOO_LARGE,
+    // ________ 11______
+    CINI_UTF8_TOO_SHORT, CINI_UTF8_TOO_SHORT,
+    CINI_UTF8_TOO_SHORT, CINI_UTF8_TOO_SHORT
+};
+
+static const uint8_t cini_utf8_incomplete_limits[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff,
+    0xf0 - 1, 0xe0 - 1, 0xc0 - 1
+};
+
+__attribute__((target("avx2")))
+__m256i cini_shift_in_previous_avx2(
+    __m256i input,
+    __m256i previous,
+    int amount
+) {
+    __m256i joined = _mm256_permute2x128_si256(previous, input, 0x21);
+    switch (amount)
+    {
+        case 1: return _mm256_alignr_epi8(input, joined, 15);
+        case 2: return _mm256_alignr_epi8(input, joined, 14);
+    }
+    return _mm256_alignr_epi8(input, joined, 13);
+}
+
+__attribute__((target("avx2")))
+__m256i cini_check_utf8_block_avx2(
+    __m256i input,
+    __m256i previous
+) {
+    const __m256i low_nibble_mask = _mm256_set1_epi8(0x0f);
+    const __m256i table_byte_1_high = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) cini_utf8_table_byte_1_high)
+    );
+    const __m256i table_byte_1_low = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) cini_utf8_table_byte_1_low)
+    );
+    const __m256i table_byte_2_high = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) cini_utf8_table_byte_2_high)
+    );
+
+    __m256i previous_1 = cini_shift_in_previous_avx2(input, previous, 1);
+    __m256i byte_1_high = _mm256_shuffle_epi8(
+        table_byte_1_high,
+        _mm256_and_si256(_mm256_srli_epi16(previous_1, 4), low_nibble_mask)
+    );
+    __m256i byte_1_low = _mm256_shuffle_epi8(
+        table_byte_1_low,
+        _mm256_and_si256(previous_1, low_nibble_mask)
+    );
+    __m256i byte_2_high = _mm256_shuffle_epi8(
+        table_byte_2_high,
+        _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble_mask)
+    );
+    __m256i special_cases = _mm256_and_si256(
+        _mm256_and_si256(byte_1_high, byte_1_low),
+        byte_2_high
+    );
+
+    // Third and fourth bytes of a rune must be continuations, which
+    // the two-byte lookups above can't see.
+
+    __m256i previous_2 = cini_shift_in_previous_avx2(input, previous, 2);
+    __m256i previous_3 = cini_shift_in_previous_avx2(input, previous, 3);
+    __m256i must_be_continuation = _mm256_and_si256(
+        _mm256_or_si256(
+            _mm256_subs_epu8(previous_2, _mm256_set1_epi8(0xe0 - 0x80)),
+            _mm256_subs_epu8(previous_3, _mm256_set1_epi8(0xf0 - 0x80))
+        ),
+        _mm256_set1_epi8(-0x80)
+    );
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+__attribute__((target("avx2")))
+bool cini_validate_utf8_avx2(
+    const char *source,
+    uint_fast32_t len_source,
+    uint_fast32_t *offset,
+    uint_fast32_t end
+) {
+    const __m256i incomplete_limits = _mm256_loadu_si256(
+        (const __m256i *) cini_utf8_incomplete_limits
+    );
+    __m256i error = _mm256_setzero_si256();
+    __m256i previous = _mm256_setzero_si256();
+    __m256i previous_incomplete = _mm256_setzero_si256();
+
+    uint_fast32_t cursor = *offset;
+    while ((cursor + 32) <= end)
+    {
+        __m256i input = _mm256_loadu_si256((const __m256i *) &source[cursor]);
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            error = _mm256_or_si256(error, previous_incomplete);
+            previous_incomplete = _mm256_setzero_si256();
+        }
+        else
+        {
+            error = _mm256_or_si256(
+                error,
+                cini_check_utf8_block_avx2(input, previous)
+            );
+            previous_incomplete = _mm256_subs_epu8(input, incomplete_limits);
+        }
+        previous = input;
+        cursor += 32;
+    }
+    if ( ! _mm256_testz_si256(error, error))
+    {
+        // Let the scalar validator find the exact offset of the error.
+        return cini_validate_utf8_scalar(source, len_source, offset, end);
+    }
+
+    // A rune may be cut off by the end of the last block; the scalar
+    // validator continues at its lead byte.
+
+    if ( ! _mm256_testz_si256(previous_incomplete, previous_incomplete))
+    {
+        uint_fast32_t walked_back = 1;
+        while (walked_back <= 3)
+        {
+            if (((uint8_t) source[cursor - walked_back]) >= 0xc0)
+            {
+                cursor -= walked_back;
+                break;
+            }
+            ++walked_back;
+        }
+    }
+    *offset = cursor;
+    return cini_validate_utf8_scalar(source, len_source, offset, end);
+}
+
+#endif // CINI_SCANNER_X86
+
+CiniValidateFn cini_select_validator()
+{
+#ifdef CINI_SCANNER_X86
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return cini_validate_utf8_avx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return cini_validate_utf8_sse2;
+    }
+#endif
+    return cini_validate_utf8_scalar;
+}
+
+CiniStatus cini_validate_utf8(
+    const char *source,
+    uint_fast32_t len_source,
+    uint_fast32_t *invalid_offset
+) {
+    uint_fast32_t offset = 0;
+    if (cini_select_validator()(source, len_source, &offset, len_source))
+    {
+        return CINI_SUCCESS;
+    }
+    if (invalid_offset)
+    {
+        *invalid_offset = offset;
+    }
+    return CINI_INVALID_ENCODING;
+}
+
+
+
+// ==> Index traversal
+
+void cini_init_structural_index(
+    CiniStructuralIndex *index,
+    const char *source,
+    uint_fast32_t len_source
+) {
+    index->source = source;
+    index->len_source = len_source;
+    index->fn_classify = cini_select_classifier();
+    index->fn_validate = cini_select_validator();
+    index->validated_until = 0;
+    index->status = CINI_SUCCESS;
+    index->invalid_offset = len_source;
+
+    // Mark the window as empty so that the first lookup fills it.
+    index->window_start = 0;
+    index->window_end = 0;
+    index->profiler = NULL;
+}
+
+void cini_fill_structural_window(
+    CiniStructuralIndex *index,
+    uint_fast32_t window_start
+) {
+    uint_fast32_t len_window = index->len_source - window_start;
+    if (len_window > CINI_STRUCTURAL_WINDOW)
+    {
+        len_window = CINI_STRUCTURAL_WINDOW;
+    }
+    bool has_non_ascii = index->fn_classify(
+        &index->source[window_start],
+        len_window,
+        index->bits
+    );
+    index->window_start = window_start;
+    index->window_end = window_start + len_window;
+
+    if (index->validated_until >= index->window_end)
+    {
+        return;
+    }
+    if (( ! has_non_ascii) && (index->validated_until >= window_start))
+    {
+        index->validated_until = index->window_end;
+        return;
+    }
+    // Validate from where the last validation stopped, which also
+    // covers bytes that the parser skipped without asking the index.
+
+    if (
+        ! index->fn_validate(
+            index->source,
+            index->len_source,
+            &index->validated_until,
+            index->window_end
+        )
+    ) {
+        index->status = CINI_INVALID_ENCODING;
+        index->invalid_offset = index->validated_until;
+        index->len_source = index->validated_until;
+        if (index->window_end > index->len_source)
+        {
+            index->window_end = index->len_source;
+        }
+    }
+}
+
+uint_fast32_t cini_next_structural(
+    CiniStructuralIndex *index,
+    uint_fast32_t offset
+) {
+    while (offset < index->len_source)
+    {
+        if (
+             (offset < index->window_start)
+          || (offset >= index->window_end)
+        ) {
+            // Windows always start on a multiple of 64 bytes so that
+            // every bitmap word covers exactly 64 bytes of the source.
+            CINI_PROFILE_BEGIN(index->profiler, timer);
+            cini_fill_structural_window(index, offset & ~((uint_fast32_t) 63));
+            CINI_PROFILE_END(index->profiler, timer, scan_ns);
+            CINI_PROFILE_COUNT(index->profiler, num_windows, 1);
+            CINI_PROFILE_COUNT(
+                index->profiler,
+                num_runes,
+                cini_internal_count_runes(
+                    &index->source[index->window_start],
+                    index->window_end - index->window_start
+                )
+            );
+        }
+        uint_fast32_t window_offset = offset - index->window_start;
+        uint_fast32_t word_index = window_offset / 64;
+        uint64_t word = index->bits[word_index]
+            & (~((uint64_t) 0) << (window_offset % 64));
+
+        uint_fast32_t num_words = (index->window_end - index->window_start + 63) / 64;
+        while (true)
+        {
+            if (word)
+            {
+                return index->window_start
+                    + (word_index * 64)
+                    + __builtin_ctzll(word);
+            }
+            ++word_index;
+            if (word_index >= num_words)
+            {
+                break;
+            }
+            word = index->bits[word_index];
+        }
+        offset = index->window_end;
+    }
+    return index->len_source;
+}
+
@@ -0,0 +1,445 @@
+#include <cini/section.h>
+
+#include <stddef.h>
+#include <string.h>
+
+// ==> Sub-section index
+
+void cini_internal_insert_section_slot(
+    CiniSectionSlot *slots,
+    uint_fast32_t capacity,
+    CiniSection *section
+) {
+    uint_fast32_t mask = capacity - 1;
+    uint_fast32_t slot_index = section->name_hash & mask;
+    while (slots[slot_index].section)
+    {
+        slot_index = (slot_index + 1) & mask;
+    }
+    slots[slot_index].hash = section->name_hash;
+    slots[slot_index].section = section;
+}
+
+/// @brief (Re-)Build a section's sub-section index with enough slots
+///        to stay at most half full after the next insertion.
+void cini_internal_build_sub_section_index(
+    CiniDocument *document,
+    CiniSection *section
+) {
+    uint_fast32_t capacity = 16;
+    while (capacity < ((section->num_sub_sections + 1) * 2))
+    {
+        capacity *= 2;
+    }
+    document->len_abandoned_indexes +=
+        section->sub_section_index_capacity * sizeof(CiniSectionSlot);
+    CiniSectionSlot *slots = cini_arena_alloc(
+        document->arena,
+        capacity * sizeof(CiniSectionSlot)
+    );
+    memset(slots, 0, capacity * sizeof(CiniSectionSlot));
+
+    uint_fast32_t sub_section_index = 0;
+    while (sub_section_index < section->num_sub_sections)
+    {
+        cini_internal_insert_section_slot(
+            slots,
+            capacity,
+            section->sub_sections[sub_section_index]
+        );
+        ++sub_section_index;
+    }
+    section->sub_section_index = slots;
+    section->sub_section_index_capacity = capacity;
+}
+
+
+
+// ==> Section tree
+
+void cini_internal_refill_sub_section_index(
+    CiniSection *section
+) {
+    if ( ! section->sub_section_index)
+    {
+        return;
+    }
+    memset(
+        section->sub_section_index,
+        0,
+        section->sub_section_index_capacity * sizeof(CiniSectionSlot)
+    );
+    uint_fast32_t sub_section_index = 0;
+    while (sub_section_index < section->num_sub_sections)
+    {
+        cini_internal_insert_section_slot(
+            section->sub_section_index,
+            section->sub_section_index_capacity,
+            section->sub_sections[sub_section_index]
+        );
+        ++sub_section_index;
+    }
+}
+
+CiniSection * cini_internal_find_sub_section(
+    CiniDocument *document,
+    CiniSection *section,
+    const char *sub_section_name,
+    uint_fast32_t len_sub_section_name,
+    uint32_t sub_section_hash
+) {
+    if (section->sub_section_index)
+    {
+        uint_fast32_t mask = section->sub_section_index_capacity - 1;
+        uint_fast32_t slot_index = sub_section_hash & mask;
+        while (true)
+        {
+            CiniSectionSlot *slot = &section->sub_section_index[slot_index];
+            CINI_PROFILE_COUNT(document->profiler, num_sub_section_probes, 1);
+            if ( ! slot->section)
+            {
+                return NULL;
+            }
+            if (
+                 (slot->hash == sub_section_hash)
+              && (slot->section->len_name == len_sub_section_name)
+              && ( ! memcmp(
+                    slot->section->name,
+                    sub_section_name,
+                    len_sub_section_name))
+            ) {
+                return slot->section;
+            }
+            slot_index = (slot_index + 1) & mask;
+        }
+    }
+
+    uint_fast32_t sub_section_index = 0;
+    while (sub_section_index < section->num_sub_sections)
+    {
+        CiniSection *sub_section = section->sub_sections[sub_section_index];
+        CINI_PROFILE_COUNT(document->profiler, num_sub_section_probes, 1);
+        if (
+             (sub_section->name_hash == sub_section_hash)
+          && (sub_section->len_name == len_sub_section_name)
+          && ( ! memcmp(
+                sub_section->name,
+                sub_section_name,
+                len_sub_section_name))
+        ) {
+            return sub_section;
+        }
+        ++sub_section_index;
+    }
+    return NULL;
+}
+
+CiniSection * cini_internal_find_section(
+    CiniDocument *document,
+    const CiniSlice *path,
+    uint_fast32_t num_levels
+) {
+    // The section currently deepest into the
+    // hierarchy that matches the query.
+    CiniSection *section = document->root_section;
+    uint_fast32_t path_element_index = 0;
+    while (path_element_index < num_levels)
+    {
+        section = cini_internal_find_sub_section(
+            document,
+            section,
+            path[path_element_index].string,
+            path[path_element_index].length,
+            cini_hash_string(
+                path[path_element_index].string,
+                path[path_element_index].length
+            )
+        );
+        if ( ! section)
+        {
+            break;
+        }
+        ++path_element_index;
+    }
+    return section;
+}
+
+CiniSection * cini_internal_add_sub_section(
+    CiniDocument *document,
+    CiniSection *section,
+    const char *name,
+    uint_fast32_t len_name,
+    uint32_t name_hash
+) {
+    if(section->sub_sections == NULL)
+    {
+        section->sub_sections_capacity = 4;
+        section->sub_sections = cini_arena_alloc(
+            document->arena,
+            section->sub_sections_capacity
+          * sizeof(CiniSection *)
+        );
+    }
+    if (
+        section->num_sub_sections
+      >= section->sub_sections_capacity
+    ) {
+        document->len_abandoned_sub_sections +=
+            section->sub_sections_capacity * sizeof(CiniSection *);
+        section->sub_sections_capacity *= 2;
+        CiniSection **resized_sub_sections = cini_arena_alloc(
+            document->arena,
+            section->sub_sections_capacity * sizeof(CiniSection *)
+        );
+        memcpy(
+            resized_sub_sections,
+            section->sub_sections,
+            section->num_sub_sections * sizeof(CiniSection *)
+        );
+        section->sub_sections = resized_sub_sections;
+    }
+    CiniSection *sub_section = cini_arena_alloc(
+        document->arena,
+        sizeof(CiniSection)
+    );
+    memset(sub_section, 0, sizeof(CiniSection));
+    sub_section->name = name;
+    sub_section->len_name = len_name;
+    sub_section->name_hash = name_hash;
+    sub_section->parent = section;
+
+    // Keep the index at most half full, or build it once the section
+    // has too many sub-sections to search them linearly.
+
+    if (section->sub_section_index)
+    {
+        if (
+            ((section->num_sub_sections + 1) * 2)
+          > section->sub_section_index_capacity
+        ) {
+            cini_internal_build_sub_section_index(document, section);
+        }
+        cini_internal_insert_section_slot(
+            section->sub_section_index,
+            section->sub_section_index_capacity,
+            sub_section
+        );
+    }
+    section->sub_sections[section->num_sub_sections] = sub_section;
+    ++section->num_sub_sections;
+    if (
+         ( ! section->sub_section_index)
+      && (section->num_sub_sections > CINI_SUB_SECTION_INDEX_THRESHOLD)
+    ) {
+        cini_internal_build_sub_section_index(document, section);
+    }
+
+    // Append the new section to the document's linear section list
+
+    document->last_section->linear_next = sub_section;
+    document->last_section = sub_section;
+    ++document->num_sections;
+    return sub_section;
+}
+
+/// @brief Create the sections of a path which don't exist yet.
+/// @param copy_names
+///        Whether the path's names must be copied into the arena
+///        because they point into a source the document doesn't own.
+CiniSection * cini_internal_force_create_section(
+    CiniDocument *document,
+    const CiniSlice *path,
+    uint_fast32_t num_levels,
+    bool copy_names
+) {
+    // The section currently deepest into the
+    // hierarchy that matches the query.
+    CiniSection *section = document->root_section;
+    uint_fast32_t path_element_index = 0;
+    while (path_element_index < num_levels)
+    {
+        const CiniSlice *link = &path[path_element_index];
+        uint32_t link_hash = cini_hash_string(link->string, link->length);
+        CiniSection *sub_section = cini_internal_find_sub_section(
+            document,
+            section,
+            link->string,
+            link->length,
+            link_hash
+        );
+        if ( ! sub_section)
+        {
+            const char *name = link->string;
+            if (copy_names)
+            {
+                name = cini_arena_copy_slice(
+                    document->arena,
+                    link->string,
+                    link->length
+                );
+            }
+            sub_section = cini_internal_add_sub_section(
+                document,
+                section,
+                name,
+                link->length,
+                link_hash
+            );
+        }
+        if ( ! sub_section)
+        {
+            /// @todo This indicates an allocation failure.
+        }
+        section = sub_section;
+        ++path_element_index;
+    }
+    return section;
+}
+
+CiniSection * cini_internal_find_or_create_section(
+    CiniDocument *document,
+    const CiniSlice *path,
+    uint_fast32_t num_levels,
+    bool copy_names
+) {
+    // Walking the path once, creating what is missing on the way, is
+    // as cheap as only searching it.
+
+    return cini_internal_force_create_section(
+        document,
+        path,
+        num_levels,
+        copy_names
+    );
+}
+
+void cini_internal_remove_section(
+    CiniDocument *document,
+    CiniSection *section
+) {
+    CiniSection *parent = section->parent;
+    uint_fast32_t sub_section_index = 0;
+    while (parent->sub_sections[sub_section_index] != section)
+    {
+        ++sub_section_index;
+    }
+    memmove(
+        &parent->sub_sections[sub_section_index],
+        &parent->sub_sections[sub_section_index + 1],
+        (parent->num_sub_sections - sub_section_index - 1)
+      * sizeof(CiniSection *)
+    );
+    --parent->num_sub_sections;
+    cini_internal_refill_sub_section_index(parent);
+
+    // Unlink the section and all sections below it from the linear
+    // section list.
+
+    CiniSection *previous = document->first_section;
+    while (previous->linear_next)
+    {
+        CiniSection *current = previous->linear_next;
+        CiniSection *ancestor = current;
+        while (ancestor && (ancestor != section))
+        {
+            ancestor = ancestor->parent;
+        }
+        if ( ! ancestor)
+        {
+            previous = current;
+            continue;
+        }
+        previous->linear_next = current->linear_next;
+        --document->num_sections;
+        document->num_values -= current->num_fields;
+    }
+    document->last_section = previous;
+
+    // The section table is built again on its next use.
+
+    document->section_table = NULL;
+    document->len_section_table = 0;
+}
+
+CiniSection * cini_internal_resolve_section(
+    CiniDocument *document,
+    const char *path,
+    uint_fast32_t len_path
+) {
+    CiniSection *section = document->root_section;
+    uint_fast32_t offset = 0;
+    CiniSlice link;
+    while (true)
+    {
+        int_fast8_t status = cini_next_path_link(
+            path,
+            &offset,
+            len_path,
+            &link
+        );
+        if (status < 0)
+        {
+            return NULL;
+        }
+        if (status == 0)
+        {
+            break;
+        }
+        section = cini_internal_find_sub_section(
+            document,
+            section,
+            link.string,
+            link.length,
+            cini_hash_string(link.string, link.length)
+        );
+        if ( ! section)
+        {
+            return NULL;
+        }
+    }
+    return section;
+}
+
+const char * cini_internal_get_full_name(
+    CiniDocument *document,
+    CiniSection *section
+) {
+    if (section->full_name)
+    {
+        return section->full_name;
+    }
+    // The root section's full name is empty, so the sum includes one
+    // point for every level below it.
+
+    uint_fast32_t len_full_name = 0;
+    CiniSection *level = section;
+    while (level->parent)
+    {
+        len_full_name += level->len_name + 1;
+        level = level->parent;
+    }
+    --len_full_name;
+
+    char *full_name = cini_arena_alloc_bytes(
+        document->arena,
+        len_full_name + 1
+    );
+    full_name[len_full_name] = 0;
+
+    uint_fast32_t offset = len_full_name;
+    level = section;
+    while (level->parent)
+    {
+        offset -= level->len_name;
+        memcpy(&full_name[offset], level->name, level->len_name);
+        if (offset > 0)
+        {
+            --offset;
+            full_name[offset] = '.';
+        }
+        level = level->parent;
+    }
+    section->full_name = full_name;
+    return full_name;
+}
+
@@ -0,0 +1,157 @@
+#include <cini/compiled.h>
+#include <cini/stats.h>
+
+#include <string.h>
+
+// ==> Memory
+
+/// @brief Count the strings of a loaded compiled document, which are
+///        read from its image.
+void cini_internal_count_compiled_strings(
+    const CiniCompiledHeader *header,
+    CiniMemoryStats *stats
+) {
+    for (uint_fast32_t index = 1; index < header->num_sections; ++index)
+    {
+        const CiniCompiledSection *section =
+            cini_internal_get_compiled_section(header, index);
+        stats->num_strings += 2;
+        stats->string_bytes += section->len_name;
+        stats->string_bytes += strlen(
+            cini_internal_get_compiled_string(header, section->full_name)
+        );
+    }
+    for (uint_fast32_t index = 0; index < header->num_fields; ++index)
+    {
+        const CiniCompiledField *field =
+            cini_internal_get_compiled_field(header, index);
+        stats->num_strings += 2;
+        stats->string_bytes += field->len_key + field->len_value;
+    }
+}
+
+void cini_internal_count_strings(
+    CiniDocument *document,
+    CiniMemoryStats *stats
+) {
+    CiniSection *section = document->first_section;
+    while (section)
+    {
+        if (section != document->root_section)
+        {
+            ++stats->num_strings;
+            stats->string_bytes += section->len_name;
+            if (section->full_name)
+            {
+                ++stats->num_strings;
+                stats->string_bytes += strlen(section->full_name);
+            }
+        }
+        CiniField *field = section->first_field;
+        while (field)
+        {
+            stats->num_strings += 2;
+            stats->string_bytes += field->len_key + field->len_value;
+            field = field->next_in_section;
+        }
+        section = section->linear_next;
+    }
+}
+
+int_fast8_t cini_get_memory_stats(
+    CiniDocument *document,
+    CiniMemoryStats *stats
+) {
+    if (( ! document) || ( ! stats))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    memset(stats, 0, sizeof(CiniMemoryStats));
+    cini_measure_arena(
+        document->arena,
+        &stats->num_arena_blocks,
+        &stats->arena_bytes_reserved,
+        &stats->arena_bytes_used
+    );
+    stats->abandoned_sub_section_bytes = document->len_abandoned_sub_sections;
+    stats->abandoned_index_bytes = document->len_abandoned_indexes;
+
+    CiniSourceBuffer *source_buffer = document->source_buffers;
+    while (source_buffer)
+    {
+        if (source_buffer->is_mapping)
+        {
+            stats->source_mapping_bytes += source_buffer->length;
+        }
+        else
+        {
+            stats->source_copy_bytes += source_buffer->length;
+        }
+        source_buffer = source_buffer->next;
+    }
+
+    stats->num_sections = document->num_sections - 1;
+    stats->num_fields = document->num_values;
+    if (document->compiled)
+    {
+        cini_internal_count_compiled_strings(document->compiled, stats);
+    }
+    else
+    {
+        cini_internal_count_strings(document, stats);
+    }
+    stats->num_allocations = __atomic_load_n(
+        &document->num_allocations,
+        __ATOMIC_RELAXED
+    );
+    stats->num_frees = __atomic_load_n(
+        &document->num_frees,
+        __ATOMIC_RELAXED
+    );
+    return CINI_SUCCESS;
+}
+
+
+
+// ==> Profiling
+
+void cini_internal_add_parse_profile(
+    CiniParseProfile *profile,
+    const CiniParseProfile *addend
+) {
+    profile->scan_ns += addend->scan_ns;
+    profile->split_ns += addend->split_ns;
+    profile->section_ns += addend->section_ns;
+    profile->field_ns += addend->field_ns;
+    profile->arena_ns += addend->arena_ns;
+    profile->other_ns += addend->other_ns;
+    profile->num_windows += addend->num_windows;
+    profile->num_runes += addend->num_runes;
+    profile->num_headers += addend->num_headers;
+    profile->num_fields += addend->num_fields;
+    profile->num_sub_section_probes += addend->num_sub_section_probes;
+    profile->num_arena_continuations += addend->num_arena_continuations;
+}
+
+int_fast8_t cini_get_parse_profile(
+    CiniDocument *document,
+    CiniParseProfile *profile
+) {
+    if (( ! document) || ( ! profile))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    memset(profile, 0, sizeof(CiniParseProfile));
+    if (document->profiler)
+    {
+        *profile = document->profiler->totals;
+    }
+    profile->total_ns = profile->scan_ns
+        + profile->split_ns
+        + profile->section_ns
+        + profile->field_ns
+        + profile->arena_ns
+        + profile->other_ns;
+    return CINI_SUCCESS;
+}
+
@@ -21,189 +21,501 @@ int64_t cini_max_i64(
 
 // ==> Allocators
 
+/// @brief Fill in the defaults of an arena configuration's zero fields
+///        and correct those which are out of range.
+CiniArenaConfig cini_internal_complete_arena_config(
+    const CiniArenaConfig *config
+) {
+    CiniArenaConfig complete = {0, 0, 0, 0, false};
+    if (config)
+    {
+        complete = *config;
+    }
+    if (complete.initial_capacity == 0)
+    {
+        complete.initial_capacity = CINI_DEFAULT_ARENA_CAPACITY;
+    }
+    if (
+         (complete.alignment == 0)
+      || ((complete.alignment & (complete.alignment - 1)) != 0)
+      || (complete.alignment > 64)
+    ) {
+        complete.alignment = CINI_DEFAULT_ARENA_ALIGNMENT;
+    }
+    if (complete.growth_factor == 0)
+    {
+        complete.growth_factor = CINI_DEFAULT_ARENA_GROWTH_FACTOR;
+    }
+    if (complete.max_block_capacity == 0)
+    {
+        complete.max_block_capacity = CINI_DEFAULT_ARENA_MAX_BLOCK;
+    }
+    if (complete.max_block_capacity < complete.initial_capacity)
+    {
+        complete.max_block_capacity = complete.initial_capacity;
+    }
+    return complete;
+}
+
+/// @brief Allocate a block whose data starts on its own cache line.
+CiniArenaBlock * cini_internal_new_arena_block(
+    CiniArena *arena,
+    uint32_t capacity
+) {
+    uint32_t len_header = cini_max_i64(64, sizeof(CiniArenaBlock));
+    if (capacity > (UINT32_MAX - len_header))
+    {
+        return NULL;
+    }
+    CiniArenaBlock *block = arena->fn_allocate(
+        len_header + capacity,
+        arena->allocator
+    );
+    if ( ! block)
+    {
+        return NULL;
+    }
+    block->next = NULL;
+    block->capacity = capacity;
+    block->usage = 0;
+    block->data = ((uint8_t *) block) + len_header;
+    return block;
+}
+
 CiniArena * cini_new_arena(
-    uint32_t capacity,
+    const CiniArenaConfig *config,
     CiniAllocateFn fn_alloc,
     CiniFreeFn fn_free,
     void *allocator
 ) {
-    CiniArena *arena = fn_alloc(
-        cini_max_i64(64, sizeof(CiniArena))
-      + capacity, allocator
-    );
-    arena->allocation =
-        ((uint8_t *)arena)
-      + cini_max_i64(64, sizeof(CiniArena));
-    arena->capacity = capacity;
-    arena->usage = 0;
+    CiniArenaConfig complete = cini_internal_complete_arena_config(config);
+    CiniArena *arena = fn_alloc(sizeof(CiniArena), allocator);
+    if ( ! arena)
+    {
+        return NULL;
+    }
     arena->fn_allocate = fn_alloc;
     arena->fn_free = fn_free;
     arena->allocator = allocator;
-    arena->continuation = NULL;
+    arena->profiler = NULL;
+    arena->alignment_mask = complete.alignment - 1;
+    arena->growth_factor = complete.growth_factor;
+    arena->max_block_capacity = complete.max_block_capacity;
+    arena->retain_blocks = complete.retain_blocks;
+
+    arena->first_block = cini_internal_new_arena_block(
+        arena,
+        complete.initial_capacity
+    );
+    if ( ! arena->first_block)
+    {
+        fn_free(arena, allocator);
+        return NULL;
+    }
+    arena->tail_block = arena->first_block;
+    arena->cursor = arena->first_block->data;
+    arena->limit = arena->first_block->data + complete.initial_capacity;
     return arena;
 }
 
 void cini_free_arena(
     CiniArena *arena
 ) {
-    if (arena->continuation)
+    CiniArenaBlock *block = arena->first_block;
+    while (block)
     {
-        cini_free_arena(arena->continuation);
+        CiniArenaBlock *next = block->next;
+        arena->fn_free(block, arena->allocator);
+        block = next;
     }
     arena->fn_free(arena, arena->allocator);
 }
 
-void * cini_arena_alloc(
-    CiniArena *arena,
-    uint32_t amount
+void cini_rewind_arena(
+    CiniArena *arena
 ) {
-    if ((arena->usage + amount) >= arena->capacity)
+    CiniArenaBlock *tail = arena->tail_block;
+    tail->usage = arena->cursor - tail->data;
+    if (( ! arena->retain_blocks) && (arena->first_block != tail))
     {
-        if ( ! arena->continuation)
+        // Sum up what was used, with some slack for the alignment
+        // padding, which may differ at the former block boundaries.
+
+        uint64_t capacity = 0;
+        CiniArenaBlock *block = arena->first_block;
+        while (block)
+        {
+            capacity += block->usage + 64;
+            if (block == tail)
+            {
+                break;
+            }
+            block = block->next;
+        }
+        if (capacity <= UINT32_MAX)
         {
-            // Allocate a new arena that is double the size of
-            // the current one, but *at least* double the size
-            // of the allocation that is currently being made.
-            arena->continuation = cini_new_arena(
-                cini_max_i64(
-                    arena->usage * 2,
-                    amount * 2),
-                arena->fn_allocate,
-                arena->fn_free,
-                arena->allocator
+            CiniArenaBlock *merged = cini_internal_new_arena_block(
+                arena,
+                capacity
             );
+            if (merged)
+            {
+                block = arena->first_block;
+                while (block)
+                {
+                    CiniArenaBlock *next = block->next;
+                    arena->fn_free(block, arena->allocator);
+                    block = next;
+                }
+                arena->first_block = merged;
+            }
+        }
+    }
+    CiniArenaBlock *block = arena->first_block;
+    while (block)
+    {
+        block->usage = 0;
+        block = block->next;
+    }
+    arena->tail_block = arena->first_block;
+    arena->cursor = arena->first_block->data;
+    arena->limit = arena->first_block->data + arena->first_block->capacity;
+}
+
+void cini_measure_arena(
+    const CiniArena *arena,
+    uint64_t *num_blocks,
+    uint64_t *len_reserved,
+    uint64_t *len_used
+) {
+    *num_blocks = 0;
+    *len_reserved = 0;
+    *len_used = 0;
+    CiniArenaBlock *block = arena->first_block;
+    while (block)
+    {
+        ++*num_blocks;
+        *len_reserved += block->capacity;
+        if (block == arena->tail_block)
+        {
+            *len_used += arena->cursor - block->data;
+        }
+        else
+        {
+            *len_used += block->usage;
         }
-        return cini_arena_alloc(
-            arena->continuation,
-            amount);
+        block = block->next;
     }
-    void *allocation = &((uint8_t *)arena->allocation)[arena->usage];
-    arena->usage += amount;
+}
+
+/// @brief Make a block the arena's tail and allocate from its start.
+void cini_adopt_arena(
+    CiniArena *arena,
+    CiniArena *adopted
+) {
+    CiniArenaBlock *tail = adopted->tail_block;
+    tail->usage = adopted->cursor - tail->data;
+
+    // Blocks behind the tail were never used.
+
+    CiniArenaBlock *unused = tail->next;
+    while (unused)
+    {
+        CiniArenaBlock *next = unused->next;
+        adopted->fn_free(unused, adopted->allocator);
+        unused = next;
+    }
+
+    // The adopted blocks are put in front of the arena's, where they
+    // count as full; allocations only continue at the tail.
+
+    tail->next = arena->first_block;
+    arena->first_block = adopted->first_block;
+    adopted->fn_free(adopted, adopted->allocator);
+}
+
+void * cini_internal_enter_arena_block(
+    CiniArena *arena,
+    CiniArenaBlock *block,
+    uint32_t amount,
+    uintptr_t alignment_mask
+) {
+    arena->tail_block = block;
+    arena->limit = block->data + block->capacity;
+
+    uintptr_t address = (uintptr_t) block->data;
+    address = (address + alignment_mask) & ~alignment_mask;
+    arena->cursor = (uint8_t *) (address + amount);
+    return (void *) address;
+}
+
+/// @brief Continue an arena in a new tail block, because the current
+///        one can't hold an allocation.
+void * cini_internal_continue_arena(
+    CiniArena *arena,
+    uint32_t amount,
+    uintptr_t alignment_mask
+) {
+    CiniArenaBlock *tail = arena->tail_block;
+    tail->usage = arena->cursor - tail->data;
+
+    // A rewound arena has blocks after its tail; move on to the next
+    // one if the allocation fits into it.
+
+    CiniArenaBlock *block = tail->next;
+    if (block && (block->capacity >= ((uint64_t) amount + alignment_mask)))
+    {
+        return cini_internal_enter_arena_block(
+            arena,
+            block,
+            amount,
+            alignment_mask
+        );
+    }
+
+    // Grow by the configured factor up to the maximum block size, but
+    // make the block large enough for the allocation in any case.
+
+    uint64_t capacity = (uint64_t) tail->capacity * arena->growth_factor;
+    if (capacity > arena->max_block_capacity)
+    {
+        capacity = arena->max_block_capacity;
+    }
+    if (capacity < ((uint64_t) amount + alignment_mask))
+    {
+        capacity = (uint64_t) amount + alignment_mask;
+    }
+    if (capacity > UINT32_MAX)
+    {
+        return NULL;
+    }
+    block = cini_internal_new_arena_block(arena, capacity);
+    if ( ! block)
+    {
+        return NULL;
+    }
+    block->next = tail->next;
+    tail->next = block;
+    return cini_internal_enter_arena_block(
+        arena,
+        block,
+        amount,
+        alignment_mask
+    );
+}
+
+void * cini_internal_arena_alloc_slowly(
+    CiniArena *arena,
+    uint32_t amount,
+    uintptr_t alignment_mask
+) {
+    CINI_PROFILE_BEGIN(arena->profiler, timer);
+    void *allocation = cini_internal_continue_arena(
+        arena,
+        amount,
+        alignment_mask
+    );
+    CINI_PROFILE_END(arena->profiler, timer, arena_ns);
+    CINI_PROFILE_COUNT(arena->profiler, num_arena_continuations, 1);
+    return allocation;
+}
+
+void * cini_arena_alloc(
+    CiniArena *arena,
+    uint32_t amount
+) {
+    uintptr_t address = (uintptr_t) arena->cursor;
+    address = (address + arena->alignment_mask) & ~arena->alignment_mask;
+    if ((address + amount) > (uintptr_t) arena->limit)
+    {
+        return cini_internal_arena_alloc_slowly(
+            arena,
+            amount,
+            arena->alignment_mask
+        );
+    }
+    arena->cursor = (uint8_t *) (address + amount);
+    return (void *) address;
+}
+
+void * cini_arena_alloc_bytes(
+    CiniArena *arena,
+    uint32_t amount
+) {
+    if (amount > (uintptr_t) (arena->limit - arena->cursor))
+    {
+        return cini_internal_arena_alloc_slowly(arena, amount, 0);
+    }
+    void *allocation = arena->cursor;
+    arena->cursor += amount;
     return allocation;
 }
 
 char * cini_arena_copy_string(CiniArena *arena, const char *string)
 {
     uint32_t len_string = strlen(string);
-    char *string_copy = cini_arena_alloc(arena, len_string + 1);
+    char *string_copy = cini_arena_alloc_bytes(arena, len_string + 1);
     memcpy(string_copy, string, len_string + 1);
     return string_copy;
 }
 
+char * cini_arena_copy_slice(
+    CiniArena *arena,
+    const char *string,
+    uint_fast32_t length
+) {
+    char *string_copy = cini_arena_alloc_bytes(arena, length + 1);
+    memcpy(string_copy, string, length);
+    string_copy[length] = 0;
+    return string_copy;
+}
+
 
 
-// ==> UTF-8 stream character extraction
+// ==> Hashing
 
-int32_t cini_distance_to_last_utf8_rune_start(
+uint32_t cini_hash_string(
     const char *string,
-    int32_t offset
+    uint_fast32_t length
+) {
+    // Mix eight bytes at a time with a multiplication; names and keys
+    // are short, so this doesn't need to be any more elaborate.
+
+    const uint64_t multiplier = 0x9e3779b97f4a7c15;
+    uint64_t hash = length * multiplier;
+    uint_fast32_t offset = 0;
+    while ((offset + 8) <= length)
+    {
+        uint64_t word;
+        memcpy(&word, &string[offset], 8);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+        offset += 8;
+    }
+    if (offset < length)
+    {
+        uint64_t word = 0;
+        memcpy(&word, &string[offset], length - offset);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+    hash *= multiplier;
+    return (uint32_t) (hash >> 32);
+}
+
+uint64_t cini_hash_bytes(
+    const char *bytes,
+    uint_fast32_t length
 ) {
-    int32_t bytes_walked = 0;
-    while ((offset - bytes_walked) >= 0)
+    // Four independent lanes of the same mixing as for strings, so that
+    // the multiplications of long inputs can overlap.
+
+    const uint64_t multiplier = 0x9e3779b97f4a7c15;
+    uint64_t seed = length;
+    uint64_t lanes[4] = {
+        seed * multiplier,
+        ~seed * multiplier,
+        (seed + 1) * multiplier,
+        (seed ^ 0x5555555555555555) * multiplier
+    };
+    uint_fast32_t offset = 0;
+    while ((offset + 32) <= length)
     {
-        if (bytes_walked > 4)
+        uint_fast32_t lane = 0;
+        while (lane < 4)
         {
-            return -1;
+            uint64_t word;
+            memcpy(&word, &bytes[offset + (lane * 8)], 8);
+            lanes[lane] = (lanes[lane] ^ word) * multiplier;
+            lanes[lane] ^= lanes[lane] >> 29;
+            ++lane;
         }
-        if ((string[offset - bytes_walked] >> 6) != 0x02)
+        offset += 32;
+    }
+    uint64_t hash = lanes[0];
+    hash = (hash ^ lanes[1]) * multiplier;
+    hash = (hash ^ lanes[2]) * multiplier;
+    hash = (hash ^ lanes[3]) * multiplier;
+    while (offset < length)
+    {
+        uint64_t word = 0;
+        uint_fast32_t len_word = length - offset;
+        if (len_word > 8)
         {
-            return bytes_walked;
+            len_word = 8;
         }
-        ++bytes_walked;
+        memcpy(&word, &bytes[offset], len_word);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+        offset += len_word;
     }
-    return -2;
+    hash *= multiplier;
+    return hash ^ (hash >> 32);
 }
 
+
+
+// ==> UTF-8 stream character extraction
+
 int32_t cini_identify_utf8_rune_length(
     const char *string,
     uint32_t offset
 ) {
-    char head_byte = string[offset];
-    // If this is ASCII
-
-    if ((head_byte & (1 << 7)) == 0)
+    uint8_t head_byte = string[offset];
+    if (head_byte < 0x80)
     {
         return 1;
     }
-    // UTF-8 - only
+    // The number of leading one-bits is the rune's length
 
-    uint32_t length = 0;
-    while (length < 5)
-    {
-        head_byte <<= 1;
-        if ((head_byte & (1 << 7)) == 0)
-        {
-            break;
-        }
-        ++length;
-    }
-    if (length > 4)
+    uint32_t length = __builtin_clz(~((uint32_t) head_byte << 24));
+    if ((length < 2) || (length > 4))
     {
         return -1;
     }
-    if (length < 2)
-    {
-        return -2;
-    }
     return length;
 }
 
-uint32_t cini_postprocess_utf8_head_byte(
-    char byte,
-    uint32_t num_bytes
-) {
-    switch (num_bytes)
-    {
-        case 1: return byte;
-        case 2: return byte & 0xe0;
-        case 3: return byte & 0xf0;
-        case 4: return byte & 0xf8;
-    }
-    return 0;
-}
-
-uint32_t cini_postprocess_utf8_bytes(
-    const char *bytes,
-    uint32_t num_bytes
-) {
-    uint32_t result = cini_postprocess_utf8_head_byte(bytes[0], num_bytes);
-
-    uint32_t byte_index = 1;
-    while (byte_index < num_bytes)
-    {
-        result <<= 6;
-        result |= bytes[byte_index] & 0x3f;
-        ++byte_index;
-    }
-    return result;
-}
-
 uint_least32_t cini_extract_utf8(
     const char *string,
     uint_fast32_t offset,
     uint_fast32_t *remaining
 ) {
-    if (string[offset] == 0x00)
-    {
-        return 0;
-    }
-    int32_t offset_into_rune = cini_distance_to_last_utf8_rune_start(string, offset);
-    if (offset_into_rune < 0)
+    // Sources are validated before they are parsed, so the rune can
+    // be decoded forwards without looking for its start or checking
+    // its continuation bytes.
+
+    uint8_t head_byte = string[offset];
+    if (head_byte < 0x80)
     {
-        return 0;
+        if (remaining)
+        {
+            *remaining = (head_byte != 0x00);
+        }
+        return head_byte;
     }
-    offset -= offset_into_rune;
-
     int32_t rune_length = cini_identify_utf8_rune_length(string, offset);
     if (rune_length < 0)
     {
+        if (remaining)
+        {
+            *remaining = 0;
+        }
         return 0;
     }
+    uint_least32_t rune = head_byte & (0x7f >> rune_length);
+    int32_t byte_index = 1;
+    while (byte_index < rune_length)
+    {
+        rune <<= 6;
+        rune |= string[offset + byte_index] & 0x3f;
+        ++byte_index;
+    }
     if (remaining)
     {
-        *remaining = rune_length - offset_into_rune;
+        *remaining = rune_length;
     }
-    return cini_postprocess_utf8_bytes(&string[offset], rune_length);
+    return rune;
 }
 
 
@@ -212,17 +524,20 @@ uint_least32_t cini_extract_utf8(
 
 bool cini_check_newline(const char *string, uint_fast32_t offset, uint_fast32_t *next)
 {
-    uint_fast32_t subject = cini_extract_utf8(string, offset, &offset);
-    if (subject == '\r')
+    // Newlines are ASCII, so there's no need to decode the rune.
+    if (string[offset] == '\r')
     {
-        uint_fast32_t offset_backup = offset;
-        if (cini_extract_utf8(string, offset, NULL) != '\n')
-            (*next) = offset_backup;
+        ++offset;
+        if (string[offset] == '\n')
+        {
+            ++offset;
+        }
+        (*next) = offset;
         return true;
     }
-    if (subject == '\n')
+    if (string[offset] == '\n')
     {
-        (*next) = offset;
+        (*next) = offset + 1;
         return true;
     }
     return false;
@@ -364,7 +679,7 @@ bool cini_is_whitespace(
     {
         return true;
     }
-    return false
+    return false;
 }
 
 uint_fast32_t cini_count_repetitions(
@@ -387,11 +702,74 @@ uint_fast32_t cini_count_repetitions(
             break;
         }
         ++num_repetitions;
-        ++len_character;
+        offset += len_character;
     }
     return num_repetitions;
 }
 
+int_fast8_t cini_next_path_link(
+    const char *string,
+    uint_fast32_t *offset,
+    uint_fast32_t end,
+    CiniSlice *link
+) {
+    uint_fast32_t cursor = *offset;
+    while ((cursor < end) && cini_is_whitespace(string[cursor]))
+    {
+        ++cursor;
+    }
+    if (cursor >= end)
+    {
+        *offset = cursor;
+        return 0;
+    }
+    uint_fast32_t link_start = cursor;
+    while (cursor < end)
+    {
+        char character = string[cursor];
+        if ((character == '.') || cini_is_whitespace(character))
+        {
+            break;
+        }
+        if (character == '"')
+        {
+            /// @todo Parse string encapsulated path links
+
+            return CINI_LIMITATION_EXCEEDED;
+        }
+        ++cursor;
+    }
+    if (cursor == link_start)
+    {
+        return CINI_SYNTAX_ERROR;
+    }
+    link->string = &string[link_start];
+    link->length = cursor - link_start;
+
+    // Jump over the separator, which is a run of whitespaces with
+    // at most one point in it.
+
+    while ((cursor < end) && cini_is_whitespace(string[cursor]))
+    {
+        ++cursor;
+    }
+    if ((cursor < end) && (string[cursor] == '.'))
+    {
+        ++cursor;
+        while ((cursor < end) && cini_is_whitespace(string[cursor]))
+        {
+            ++cursor;
+        }
+        if (cursor >= end)
+        {
+            // The point must be followed by another link
+            return CINI_SYNTAX_ERROR;
+        }
+    }
+    *offset = cursor;
+    return 1;
+}
+
 CiniAsciiSign cini_rune_to_sign_enum(uint32_t rune)
 {
     switch (rune)
@@ -432,3 +810,36 @@ CiniAsciiSign cini_rune_to_sign_enum(uint32_t rune)
     return CINI_ASCII_NOT_A_SIGN;
 }
 
+
+
+
+// ==> Escapes
+
+uint_fast32_t cini_unescape_text(
+    const char *text,
+    uint_fast32_t len_text,
+    char *buffer
+) {
+    uint_fast32_t len_buffer = 0;
+    uint_fast32_t offset = 0;
+    while (offset < len_text)
+    {
+        char character = text[offset];
+        if ((character == '\\') && ((offset + 1) < len_text))
+        {
+            ++offset;
+            character = text[offset];
+            switch (character)
+            {
+                case 'n': character = '\n'; break;
+                case 'r': character = '\r'; break;
+                case 't': character = '\t'; break;
+            }
+        }
+        buffer[len_buffer] = character;
+        ++len_buffer;
+        ++offset;
+    }
+    return len_buffer;
+}
+
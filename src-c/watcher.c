@@ -0,0 +1,395 @@
+#include <cini/parser.h>
+#include <cini/watcher.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// ==> Loading
+
+/// @brief Parse the watched file into a fresh, frozen document which
+///        readers can share.
+/// @param document
+///        Pointer to where to put the document, which is only set if
+///        parsing succeeded.
+/// @return
+/// `CINI_SUCCESS` or a negative `CiniStatus` on error.
+int_fast8_t cini_internal_load_watched_file(
+    CiniWatcher *watcher,
+    CiniDocument **document
+) {
+    FILE *file = fopen(watcher->path, "rb");
+    if ( ! file)
+    {
+        return CINI_FILE_NOT_FOUND;
+    }
+    CiniDocument *loaded = cini_malloc_document();
+    if ( ! loaded)
+    {
+        fclose(file);
+        return CINI_ALLOCATION_FAILURE;
+    }
+    int_fast8_t status = cini_parse_file_pointer(loaded, file);
+    fclose(file);
+    if (status != CINI_SUCCESS)
+    {
+        cini_free_document(loaded);
+        return status;
+    }
+    cini_freeze(loaded);
+    *document = loaded;
+    return CINI_SUCCESS;
+}
+
+/// @brief Publish a document and retire the one it replaces.
+void cini_internal_publish_document(
+    CiniWatcher *watcher,
+    CiniDocument *document
+) {
+    CiniRetiredDocument *retired = malloc(sizeof(CiniRetiredDocument));
+    if ( ! retired)
+    {
+        cini_free_document(document);
+        __atomic_store_n(
+            &watcher->status,
+            CINI_ALLOCATION_FAILURE,
+            __ATOMIC_RELAXED
+        );
+        return;
+    }
+
+    // Readers which announce an epoch from after the swap are certain
+    // to see the new document; only older readers may hold the old one.
+
+    retired->document = __atomic_exchange_n(
+        &watcher->document,
+        document,
+        __ATOMIC_SEQ_CST
+    );
+    retired->epoch = __atomic_add_fetch(&watcher->epoch, 1, __ATOMIC_SEQ_CST);
+    retired->next = watcher->retired;
+    watcher->retired = retired;
+    __atomic_add_fetch(&watcher->version, 1, __ATOMIC_RELAXED);
+}
+
+/// @brief Free the retired documents which no reader can still see.
+void cini_internal_reclaim_documents(
+    CiniWatcher *watcher
+) {
+    CiniRetiredDocument **link = &watcher->retired;
+    while (*link)
+    {
+        CiniRetiredDocument *retired = *link;
+        bool is_visible = false;
+        CiniReader *reader = __atomic_load_n(
+            &watcher->readers,
+            __ATOMIC_ACQUIRE
+        );
+        while (reader && ( ! is_visible))
+        {
+            uint64_t epoch = __atomic_load_n(&reader->epoch, __ATOMIC_SEQ_CST);
+            is_visible = (epoch != 0) && (epoch < retired->epoch);
+            reader = reader->next;
+        }
+        if (is_visible)
+        {
+            link = &retired->next;
+            continue;
+        }
+        *link = retired->next;
+        cini_free_document(retired->document);
+        free(retired);
+    }
+}
+
+
+
+// ==> Watching
+
+/// @brief Read all pending events of the watched directory.
+/// @return
+/// Whether any of them concerned the watched file.
+bool cini_internal_read_watch_events(
+    CiniWatcher *watcher
+) {
+    bool file_changed = false;
+    char events[4096]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (true)
+    {
+        ssize_t len_events = read(watcher->inotify_fd, events, sizeof(events));
+        if (len_events <= 0)
+        {
+            break;
+        }
+        ssize_t offset = 0;
+        while (offset < len_events)
+        {
+            const struct inotify_event *event = (const void *) &events[offset];
+            if (
+                 (event->mask & IN_Q_OVERFLOW)
+              || (
+                     (event->len > 0)
+                  && (strcmp(event->name, watcher->file_name) == 0)
+                 )
+            ) {
+                file_changed = true;
+            }
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return file_changed;
+}
+
+void * cini_internal_run_watcher(
+    void *userdata
+) {
+    CiniWatcher *watcher = userdata;
+    struct pollfd descriptors[2] = {
+        {.fd = watcher->inotify_fd, .events = POLLIN},
+        {.fd = watcher->stop_fd, .events = POLLIN}
+    };
+    while (true)
+    {
+        int timeout = -1;
+        if (watcher->retired)
+        {
+            timeout = CINI_WATCHER_RECLAIM_INTERVAL;
+        }
+        if (poll(descriptors, 2, timeout) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (descriptors[1].revents)
+        {
+            break;
+        }
+        if (
+             (descriptors[0].revents & POLLIN)
+          && cini_internal_read_watch_events(watcher)
+        ) {
+            CiniDocument *document = NULL;
+            int_fast8_t status = cini_internal_load_watched_file(
+                watcher,
+                &document
+            );
+            __atomic_store_n(&watcher->status, status, __ATOMIC_RELAXED);
+            if (status == CINI_SUCCESS)
+            {
+                cini_internal_publish_document(watcher, document);
+            }
+        }
+        cini_internal_reclaim_documents(watcher);
+    }
+    return NULL;
+}
+
+CiniWatcher * cini_watch_path(
+    const char *path
+) {
+    if ( ! path)
+    {
+        return NULL;
+    }
+    CiniWatcher *watcher = malloc(sizeof(CiniWatcher));
+    if ( ! watcher)
+    {
+        return NULL;
+    }
+
+    // The directory is watched rather than the file, so that a file
+    // which is replaced by renaming another one over it is noticed.
+
+    watcher->path = strdup(path);
+    const char *separator = strrchr(path, '/');
+    if (separator)
+    {
+        watcher->directory = strndup(path, (separator - path) + 1);
+        watcher->file_name = strdup(separator + 1);
+    }
+    else
+    {
+        watcher->directory = strdup(".");
+        watcher->file_name = strdup(path);
+    }
+    watcher->document = NULL;
+    watcher->epoch = 1;
+    watcher->readers = NULL;
+    watcher->retired = NULL;
+    watcher->version = 1;
+    watcher->status = CINI_SUCCESS;
+    watcher->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watcher->stop_fd = eventfd(0, EFD_CLOEXEC);
+    pthread_mutex_init(&watcher->reader_lock, NULL);
+
+    bool is_set_up = watcher->path
+        && watcher->directory
+        && watcher->file_name
+        && (watcher->inotify_fd >= 0)
+        && (watcher->stop_fd >= 0);
+    if (is_set_up)
+    {
+        is_set_up = inotify_add_watch(
+            watcher->inotify_fd,
+            watcher->directory,
+            IN_CLOSE_WRITE | IN_MOVED_TO
+        ) >= 0;
+    }
+    if (is_set_up)
+    {
+        is_set_up = cini_internal_load_watched_file(
+            watcher,
+            &watcher->document
+        ) == CINI_SUCCESS;
+    }
+    if (is_set_up)
+    {
+        is_set_up = pthread_create(
+            &watcher->thread,
+            NULL,
+            cini_internal_run_watcher,
+            watcher
+        ) == 0;
+    }
+    if ( ! is_set_up)
+    {
+        if (watcher->document)
+        {
+            cini_free_document(watcher->document);
+        }
+        if (watcher->inotify_fd >= 0)
+        {
+            close(watcher->inotify_fd);
+        }
+        if (watcher->stop_fd >= 0)
+        {
+            close(watcher->stop_fd);
+        }
+        pthread_mutex_destroy(&watcher->reader_lock);
+        free(watcher->path);
+        free(watcher->directory);
+        free(watcher->file_name);
+        free(watcher);
+        return NULL;
+    }
+    return watcher;
+}
+
+void cini_free_watcher(
+    CiniWatcher *watcher
+) {
+    if ( ! watcher)
+    {
+        return;
+    }
+    uint64_t stop = 1;
+    if (write(watcher->stop_fd, &stop, sizeof(stop)) == sizeof(stop))
+    {
+        pthread_join(watcher->thread, NULL);
+    }
+    close(watcher->inotify_fd);
+    close(watcher->stop_fd);
+
+    while (watcher->retired)
+    {
+        CiniRetiredDocument *next = watcher->retired->next;
+        cini_free_document(watcher->retired->document);
+        free(watcher->retired);
+        watcher->retired = next;
+    }
+    cini_free_document(watcher->document);
+    while (watcher->readers)
+    {
+        CiniReader *next = watcher->readers->next;
+        free(watcher->readers);
+        watcher->readers = next;
+    }
+    pthread_mutex_destroy(&watcher->reader_lock);
+    free(watcher->path);
+    free(watcher->directory);
+    free(watcher->file_name);
+    free(watcher);
+}
+
+uint_fast32_t cini_get_watcher_version(
+    CiniWatcher *watcher
+) {
+    return __atomic_load_n(&watcher->version, __ATOMIC_RELAXED);
+}
+
+int_fast8_t cini_get_watcher_status(
+    CiniWatcher *watcher
+) {
+    return __atomic_load_n(&watcher->status, __ATOMIC_RELAXED);
+}
+
+
+
+// ==> Reading
+
+CiniReader * cini_add_reader(
+    CiniWatcher *watcher
+) {
+    pthread_mutex_lock(&watcher->reader_lock);
+    CiniReader *reader = watcher->readers;
+    while (reader && reader->in_use)
+    {
+        reader = reader->next;
+    }
+    if ( ! reader)
+    {
+        reader = aligned_alloc(64, sizeof(CiniReader));
+        if (reader)
+        {
+            reader->watcher = watcher;
+            reader->epoch = 0;
+            reader->next = watcher->readers;
+            __atomic_store_n(&watcher->readers, reader, __ATOMIC_RELEASE);
+        }
+    }
+    if (reader)
+    {
+        reader->in_use = true;
+    }
+    pthread_mutex_unlock(&watcher->reader_lock);
+    return reader;
+}
+
+void cini_remove_reader(
+    CiniReader *reader
+) {
+    pthread_mutex_lock(&reader->watcher->reader_lock);
+    reader->in_use = false;
+    pthread_mutex_unlock(&reader->watcher->reader_lock);
+}
+
+CiniDocument * cini_begin_read(
+    CiniReader *reader
+) {
+    // The announced epoch must be visible to the watcher's thread before
+    // the document is loaded, which the sequentially consistent order
+    // of both accesses guarantees.
+
+    uint64_t epoch = __atomic_load_n(
+        &reader->watcher->epoch,
+        __ATOMIC_ACQUIRE
+    );
+    __atomic_store_n(&reader->epoch, epoch, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&reader->watcher->document, __ATOMIC_SEQ_CST);
+}
+
+void cini_end_read(
+    CiniReader *reader
+) {
+    __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+}
+
@@ -0,0 +1,436 @@
+#include <cini/compiled.h>
+#include <cini/writer.h>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+// ==> Output
+
+/// @brief Hand all gathered vectors to the writer's file or file
+///        descriptor and start gathering anew.
+void cini_internal_flush_writer(
+    CiniWriter *writer
+) {
+    struct iovec *vectors = writer->vectors;
+    uint_fast32_t num_vectors = writer->num_vectors;
+    writer->num_vectors = 0;
+    writer->len_staged = 0;
+    if (writer->status != CINI_SUCCESS)
+    {
+        return;
+    }
+    if (writer->file)
+    {
+        for (uint_fast32_t index = 0; index < num_vectors; ++index)
+        {
+            size_t len_written = fwrite(
+                vectors[index].iov_base,
+                1,
+                vectors[index].iov_len,
+                writer->file
+            );
+            if (len_written != vectors[index].iov_len)
+            {
+                writer->status = CINI_WRITE_FAILURE;
+                return;
+            }
+        }
+        return;
+    }
+    while (num_vectors > 0)
+    {
+        ssize_t len_written = writev(writer->fd, vectors, num_vectors);
+        if (len_written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            writer->status = CINI_WRITE_FAILURE;
+            return;
+        }
+
+        // Skip what was written and continue within the vector at which
+        // the kernel stopped.
+
+        while (
+             (num_vectors > 0)
+          && (((size_t) len_written) >= vectors->iov_len)
+        ) {
+            len_written -= vectors->iov_len;
+            ++vectors;
+            --num_vectors;
+        }
+        if (num_vectors > 0)
+        {
+            vectors->iov_base = ((char *) vectors->iov_base) + len_written;
+            vectors->iov_len -= len_written;
+        }
+    }
+}
+
+/// @brief Append bytes to the text. The bytes must stay unchanged until
+///        the writer is flushed, as long ones are only referenced.
+void cini_internal_emit(
+    CiniWriter *writer,
+    const char *bytes,
+    uint_fast32_t length
+) {
+    writer->len_text += length;
+    if ( ! writer->vectors)
+    {
+        // Once the text doesn't fit into the buffer anymore, nothing
+        // after it does either; only its length is counted then.
+
+        if (writer->len_text < writer->len_buffer)
+        {
+            memcpy(
+                &writer->buffer[writer->len_text - length],
+                bytes,
+                length
+            );
+        }
+        return;
+    }
+    if (length == 0)
+    {
+        return;
+    }
+    if (length > CINI_WRITER_MAX_COPY)
+    {
+        if (writer->num_vectors == CINI_WRITER_MAX_VECTORS)
+        {
+            cini_internal_flush_writer(writer);
+        }
+        writer->vectors[writer->num_vectors].iov_base = (void *) bytes;
+        writer->vectors[writer->num_vectors].iov_len = length;
+        ++writer->num_vectors;
+        return;
+    }
+    if (
+         ((writer->len_staged + length) > CINI_WRITER_STAGING_SIZE)
+      || (writer->num_vectors == CINI_WRITER_MAX_VECTORS)
+    ) {
+        cini_internal_flush_writer(writer);
+    }
+    char *copy = &writer->staging[writer->len_staged];
+    memcpy(copy, bytes, length);
+    writer->len_staged += length;
+
+    // Copies which follow each other in the staging buffer are written
+    // as a single vector.
+
+    if (writer->num_vectors > 0)
+    {
+        struct iovec *last = &writer->vectors[writer->num_vectors - 1];
+        if ((((char *) last->iov_base) + last->iov_len) == copy)
+        {
+            last->iov_len += length;
+            return;
+        }
+    }
+    writer->vectors[writer->num_vectors].iov_base = copy;
+    writer->vectors[writer->num_vectors].iov_len = length;
+    ++writer->num_vectors;
+}
+
+
+
+// ==> Formatting
+
+/// @brief Check whether a value would be read back differently if it
+///        was written as it is, because its surrounding whitespace
+///        would be trimmed, it would be taken for a quoted value or it
+///        spans several lines.
+bool cini_internal_needs_quotes(
+    const char *value,
+    uint_fast32_t len_value
+) {
+    if (len_value == 0)
+    {
+        return false;
+    }
+    if (
+         cini_is_whitespace(value[0])
+      || cini_is_whitespace(value[len_value - 1])
+      || (value[0] == '"')
+    ) {
+        return true;
+    }
+    return memchr(value, '\n', len_value) || memchr(value, '\r', len_value);
+}
+
+/// @brief Write a value within quotation marks, escaping the characters
+///        which can't appear in a quoted value as they are.
+void cini_internal_write_quoted(
+    CiniWriter *writer,
+    const char *value,
+    uint_fast32_t len_value
+) {
+    cini_internal_emit(writer, "\"", 1);
+    uint_fast32_t run_start = 0;
+    for (uint_fast32_t offset = 0; offset < len_value; ++offset)
+    {
+        const char *escape = NULL;
+        switch (value[offset])
+        {
+            case '"': escape = "\\\""; break;
+            case '\\': escape = "\\\\"; break;
+            case '\n': escape = "\\n"; break;
+            case '\r': escape = "\\r"; break;
+        }
+        if ( ! escape)
+        {
+            continue;
+        }
+        cini_internal_emit(writer, &value[run_start], offset - run_start);
+        cini_internal_emit(writer, escape, 2);
+        run_start = offset + 1;
+    }
+    cini_internal_emit(writer, &value[run_start], len_value - run_start);
+    cini_internal_emit(writer, "\"", 1);
+}
+
+void cini_internal_write_field(
+    CiniWriter *writer,
+    const char *key,
+    uint_fast32_t len_key,
+    const char *value,
+    uint_fast32_t len_value
+) {
+    cini_internal_emit(writer, key, len_key);
+    if (len_value == 0)
+    {
+        cini_internal_emit(writer, " =\n", 3);
+        return;
+    }
+    cini_internal_emit(writer, " = ", 3);
+    if (cini_internal_needs_quotes(value, len_value))
+    {
+        cini_internal_write_quoted(writer, value, len_value);
+    }
+    else
+    {
+        cini_internal_emit(writer, value, len_value);
+    }
+    cini_internal_emit(writer, "\n", 1);
+}
+
+/// @brief Write a section's name with all superordinate parts, from
+///        the parts themselves so that the full name needn't be built.
+void cini_internal_write_section_path(
+    CiniWriter *writer,
+    CiniSection *section
+) {
+    if (section->full_name)
+    {
+        cini_internal_emit(
+            writer,
+            section->full_name,
+            strlen(section->full_name)
+        );
+        return;
+    }
+    if (section->parent->parent)
+    {
+        cini_internal_write_section_path(writer, section->parent);
+        cini_internal_emit(writer, ".", 1);
+    }
+    cini_internal_emit(writer, section->name, section->len_name);
+}
+
+/// @brief Write a section header, preceded by an empty line unless it
+///        is the beginning of the text.
+void cini_internal_begin_section(
+    CiniWriter *writer
+) {
+    if (writer->len_text > 0)
+    {
+        cini_internal_emit(writer, "\n", 1);
+    }
+    cini_internal_emit(writer, "[", 1);
+}
+
+
+
+// ==> Traversal
+
+void cini_internal_write_tree(
+    CiniWriter *writer,
+    CiniDocument *document
+) {
+    CiniSection *section = document->first_section;
+    while (section)
+    {
+        // A section without fields whose first sub-section follows it
+        // is created again by that sub-section's header, at the same
+        // position, so its own header is left out.
+
+        bool has_header = section->parent
+            && ! (
+                 (section->num_fields == 0)
+              && (section->num_sub_sections > 0)
+              && (section->linear_next == section->sub_sections[0])
+            );
+        if (has_header)
+        {
+            cini_internal_begin_section(writer);
+            cini_internal_write_section_path(writer, section);
+            cini_internal_emit(writer, "]\n", 2);
+        }
+        CiniField *field = section->first_field;
+        while (field)
+        {
+            cini_internal_write_field(
+                writer,
+                field->key,
+                field->len_key,
+                field->value,
+                field->len_value
+            );
+            field = field->next_in_section;
+        }
+        section = section->linear_next;
+    }
+}
+
+void cini_internal_write_compiled(
+    CiniWriter *writer,
+    const CiniCompiledHeader *header
+) {
+    const uint32_t *links = (const uint32_t *)
+        (((const uint8_t *) header) + header->sub_section_links_offset);
+    for (uint_fast32_t index = 0; index < header->num_sections; ++index)
+    {
+        const CiniCompiledSection *section =
+            cini_internal_get_compiled_section(header, index);
+        bool has_header = (section->parent != CINI_COMPILED_NONE)
+            && ! (
+                 (section->num_fields == 0)
+              && (section->num_sub_sections > 0)
+              && (links[section->first_sub_section_link] == (index + 1))
+            );
+        if (has_header)
+        {
+            const char *full_name = cini_internal_get_compiled_string(
+                header,
+                section->full_name
+            );
+            cini_internal_begin_section(writer);
+            cini_internal_emit(writer, full_name, strlen(full_name));
+            cini_internal_emit(writer, "]\n", 2);
+        }
+        for (
+            uint_fast32_t field_index = 0;
+            field_index < section->num_fields;
+            ++field_index
+        ) {
+            const CiniCompiledField *field = cini_internal_get_compiled_field(
+                header,
+                section->first_field + field_index
+            );
+            cini_internal_write_field(
+                writer,
+                cini_internal_get_compiled_string(header, field->key),
+                field->len_key,
+                cini_internal_get_compiled_string(header, field->value),
+                field->len_value
+            );
+        }
+    }
+}
+
+void cini_internal_write_document(
+    CiniWriter *writer,
+    CiniDocument *document
+) {
+    if (document->compiled)
+    {
+        cini_internal_write_compiled(writer, document->compiled);
+        return;
+    }
+    cini_internal_write_tree(writer, document);
+}
+
+int_fast32_t cini_write_document(
+    CiniDocument *document,
+    char *buffer,
+    uint_fast32_t len_buffer
+) {
+    if ( ! document)
+    {
+        return CINI_INVALID_POINTER;
+    }
+    CiniWriter writer;
+    memset(&writer, 0, sizeof(CiniWriter));
+    writer.buffer = buffer;
+    writer.len_buffer = buffer ? len_buffer : 0;
+    writer.fd = -1;
+    cini_internal_write_document(&writer, document);
+
+    if (writer.len_text > INT32_MAX)
+    {
+        return CINI_LIMITATION_EXCEEDED;
+    }
+    if ( ! buffer)
+    {
+        return writer.len_text;
+    }
+    if (writer.len_text >= len_buffer)
+    {
+        return CINI_LIMITATION_EXCEEDED;
+    }
+    buffer[writer.len_text] = 0;
+    return writer.len_text;
+}
+
+/// @brief Write a document through a writer which gathers vectors, to
+///        either a stream or a file descriptor.
+int_fast8_t cini_internal_write_batched(
+    CiniDocument *document,
+    FILE *file,
+    int fd
+) {
+    CiniWriter writer;
+    memset(&writer, 0, sizeof(CiniWriter));
+    writer.file = file;
+    writer.fd = fd;
+    writer.vectors = document->fn_alloc(
+        (CINI_WRITER_MAX_VECTORS * sizeof(struct iovec))
+      + CINI_WRITER_STAGING_SIZE,
+        document->allocator
+    );
+    if ( ! writer.vectors)
+    {
+        return CINI_ALLOCATION_FAILURE;
+    }
+    writer.staging = (char *) &writer.vectors[CINI_WRITER_MAX_VECTORS];
+    cini_internal_write_document(&writer, document);
+    cini_internal_flush_writer(&writer);
+    document->fn_free(writer.vectors, document->allocator);
+    return writer.status;
+}
+
+int_fast8_t cini_write_document_file(
+    CiniDocument *document,
+    FILE *file
+) {
+    if (( ! document) || ( ! file))
+    {
+        return CINI_INVALID_POINTER;
+    }
+    return cini_internal_write_batched(document, file, -1);
+}
+
+int_fast8_t cini_write_document_fd(
+    CiniDocument *document,
+    int fd
+) {
+    if ( ! document)
+    {
+        return CINI_INVALID_POINTER;
+    }
+    return cini_internal_write_batched(document, NULL, fd);
+}
+
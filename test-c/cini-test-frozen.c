@@ -0,0 +1,425 @@
+#include <cini.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Parse a file through a memory mapping, freeze the document and read
+// every value and every entry of the section topology from many threads
+// at once, checking each result against what the file was generated
+// from. Meant to be built with `-fsanitize=thread`, which reports any
+// getter that still writes into a frozen document.
+
+#define TEST_NUM_THREADS 8
+#define TEST_NUM_ROUNDS 24
+#define TEST_NUM_SECTIONS 48
+#define TEST_NUM_CHILDREN 4
+
+// Each top-level section is followed by its children in the list of
+// sections.
+#define TEST_SECTION_STRIDE (TEST_NUM_CHILDREN + 1)
+
+typedef struct
+{
+    CiniDocument *document;
+    uint_fast32_t thread_index;
+    uint_fast32_t num_failures;
+
+} TestThread;
+
+
+
+// ==> Expected Content
+
+/// @brief Get the number which all values of a section are derived from;
+///        `child` is -1 for a top-level section.
+int64_t test_section_number(
+    int_fast32_t section,
+    int_fast32_t child
+) {
+    return (section * TEST_SECTION_STRIDE) + child + 2;
+}
+
+void test_format_section_name(
+    char *buffer,
+    size_t len_buffer,
+    int_fast32_t section,
+    int_fast32_t child
+) {
+    if (child < 0)
+    {
+        snprintf(buffer, len_buffer, "s%d", (int) section);
+        return;
+    }
+    snprintf(buffer, len_buffer, "s%d.c%d", (int) section, (int) child);
+}
+
+void test_append_section(
+    FILE *file,
+    int_fast32_t section,
+    int_fast32_t child
+) {
+    char name[32];
+    test_format_section_name(name, sizeof(name), section, child);
+    int64_t number = test_section_number(section, child);
+    fprintf(file, "[%s]\n", name);
+    fprintf(file, "i = %lld\n", (long long) ((number * 37) - 500));
+    fprintf(file, "h = 0x%llX\n", (unsigned long long) (number * 3));
+    fprintf(file, "d = %lld.25\n", (long long) number);
+    fprintf(file, "b = %s\n", (number % 2) ? "yes" : "off");
+    fprintf(file, "t = text-%lld\n", (long long) number);
+    fprintf(file, "q = \"quoted %lld\"\n\n", (long long) number);
+}
+
+/// @brief Write the test document into an unlinked temporary file.
+/// @return
+/// The file's descriptor, or -1 on failure.
+int test_make_source()
+{
+    char path[] = "/tmp/cini-test-frozen-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    unlink(path);
+    FILE *file = fdopen(dup(fd), "w");
+    if ( ! file)
+    {
+        close(fd);
+        return -1;
+    }
+    fprintf(file, "root = 7\n\n");
+    for (int_fast32_t section = 0; section < TEST_NUM_SECTIONS; ++section)
+    {
+        for (int_fast32_t child = -1; child < TEST_NUM_CHILDREN; ++child)
+        {
+            test_append_section(file, section, child);
+        }
+    }
+    fclose(file);
+    return fd;
+}
+
+
+
+// ==> Checking
+
+void test_check(
+    TestThread *thread,
+    bool condition,
+    const char *what,
+    const char *query
+) {
+    if (condition)
+    {
+        return;
+    }
+    if (thread->num_failures < 8)
+    {
+        fprintf(
+            stderr,
+            "thread %u: %s failed for \"%s\"\n",
+            (unsigned int) thread->thread_index,
+            what,
+            query
+        );
+    }
+    ++thread->num_failures;
+}
+
+void test_check_values(
+    TestThread *thread,
+    int_fast32_t section,
+    int_fast32_t child
+) {
+    CiniDocument *document = thread->document;
+    char name[32];
+    char query[48];
+    char expected[48];
+    test_format_section_name(name, sizeof(name), section, child);
+    int64_t number = test_section_number(section, child);
+
+    int64_t integer = 0;
+    snprintf(query, sizeof(query), "%s:i", name);
+    test_check(
+        thread,
+        (cini_get_int(document, query, &integer) == CINI_SUCCESS)
+            && (integer == ((number * 37) - 500)),
+        "cini_get_int",
+        query
+    );
+    test_check(
+        thread,
+        cini_get_value_types(document, query)
+            == (CINI_VALUE_INTEGER | CINI_VALUE_DECIMAL | CINI_VALUE_STRING),
+        "cini_get_value_types",
+        query
+    );
+
+    snprintf(query, sizeof(query), "%s:h", name);
+    test_check(
+        thread,
+        (cini_get_int(document, query, &integer) == CINI_SUCCESS)
+            && (integer == (number * 3)),
+        "cini_get_int",
+        query
+    );
+
+    double decimal = 0;
+    snprintf(query, sizeof(query), "%s:d", name);
+    test_check(
+        thread,
+        (cini_get_decimal(document, query, &decimal) == CINI_SUCCESS)
+            && (decimal == (number + 0.25)),
+        "cini_get_decimal",
+        query
+    );
+
+    bool boolean = false;
+    snprintf(query, sizeof(query), "%s:b", name);
+    test_check(
+        thread,
+        (cini_get_bool(document, query, &boolean) == CINI_SUCCESS)
+            && (boolean == (number % 2)),
+        "cini_get_bool",
+        query
+    );
+
+    snprintf(query, sizeof(query), "%s:t", name);
+    snprintf(expected, sizeof(expected), "text-%lld", (long long) number);
+    const char *text = cini_get_text(document, query);
+    test_check(
+        thread,
+        text && ( ! strcmp(text, expected)),
+        "cini_get_text",
+        query
+    );
+    char copy[48];
+    test_check(
+        thread,
+        (cini_write_text(document, query, NULL, -1)
+            == (int_fast32_t) strlen(expected))
+            && (cini_write_text(document, query, copy, sizeof(copy))
+                == CINI_SUCCESS)
+            && ( ! strcmp(copy, expected)),
+        "cini_write_text",
+        query
+    );
+    test_check(
+        thread,
+        cini_get_int(document, query, &integer) == CINI_TYPE_MISMATCH,
+        "cini_get_int mismatch",
+        query
+    );
+
+    snprintf(query, sizeof(query), "%s:q", name);
+    snprintf(expected, sizeof(expected), "quoted %lld", (long long) number);
+    text = cini_get_text(document, query);
+    test_check(
+        thread,
+        text && ( ! strcmp(text, expected)),
+        "cini_get_text",
+        query
+    );
+
+    snprintf(query, sizeof(query), "%s:missing", name);
+    test_check(
+        thread,
+        cini_get_int(document, query, &integer) == CINI_KEY_NONEXISTENT,
+        "cini_get_int missing key",
+        query
+    );
+}
+
+/// @brief Check a compiled query of the thread's own, which is resolved
+///        on its first use.
+void test_check_compiled_query(
+    TestThread *thread,
+    int_fast32_t section
+) {
+    char query[48];
+    snprintf(query, sizeof(query), "s%d.c0:i", (int) section);
+    CiniQuery *handle = cini_compile_query(thread->document, query);
+    test_check(thread, handle != NULL, "cini_compile_query", query);
+    if ( ! handle)
+    {
+        return;
+    }
+    int64_t number = test_section_number(section, 0);
+    for (uint_fast32_t round = 0; round < 4; ++round)
+    {
+        int64_t integer = 0;
+        test_check(
+            thread,
+            (cini_get_int_q(handle, &integer) == CINI_SUCCESS)
+                && (integer == ((number * 37) - 500)),
+            "cini_get_int_q",
+            query
+        );
+        const char *text = cini_get_text_q(handle);
+        char expected[32];
+        snprintf(
+            expected,
+            sizeof(expected),
+            "%lld",
+            (long long) ((number * 37) - 500)
+        );
+        test_check(
+            thread,
+            text && ( ! strcmp(text, expected)),
+            "cini_get_text_q",
+            query
+        );
+    }
+    cini_free_query(handle);
+}
+
+void test_check_topology(
+    TestThread *thread,
+    int_fast32_t section
+) {
+    CiniDocument *document = thread->document;
+    char name[32];
+    test_format_section_name(name, sizeof(name), section, -1);
+    test_check(
+        thread,
+        cini_get_section_count(document, name) == TEST_NUM_CHILDREN,
+        "cini_get_section_count",
+        name
+    );
+    for (int_fast32_t child = -1; child < TEST_NUM_CHILDREN; ++child)
+    {
+        char expected[32];
+        test_format_section_name(expected, sizeof(expected), section, child);
+        const char *linear = cini_get_section_name(
+            document,
+            NULL,
+            (section * TEST_SECTION_STRIDE) + child + 1
+        );
+        test_check(
+            thread,
+            linear && ( ! strcmp(linear, expected)),
+            "cini_get_section_name",
+            expected
+        );
+        if (child < 0)
+        {
+            continue;
+        }
+        const char *nested = cini_get_section_name(document, name, child);
+        test_check(
+            thread,
+            nested && ( ! strcmp(nested, expected)),
+            "cini_get_section_name in super section",
+            expected
+        );
+    }
+    test_check(
+        thread,
+        ! cini_get_section_name(document, name, TEST_NUM_CHILDREN),
+        "cini_get_section_name past the end",
+        name
+    );
+}
+
+void * test_run_thread(
+    void *userdata
+) {
+    TestThread *thread = userdata;
+    CiniDocument *document = thread->document;
+    for (uint_fast32_t round = 0; round < TEST_NUM_ROUNDS; ++round)
+    {
+        test_check(
+            thread,
+            cini_get_section_count(document, NULL)
+                == (TEST_NUM_SECTIONS * TEST_SECTION_STRIDE),
+            "cini_get_section_count",
+            "(all)"
+        );
+        int64_t root = 0;
+        test_check(
+            thread,
+            (cini_get_int(document, "root", &root) == CINI_SUCCESS)
+                && (root == 7),
+            "cini_get_int",
+            "root"
+        );
+
+        // Threads start at different sections, so that the first use of
+        // every section is contended.
+
+        for (int_fast32_t offset = 0; offset < TEST_NUM_SECTIONS; ++offset)
+        {
+            int_fast32_t section = (offset + (thread->thread_index * 5))
+                % TEST_NUM_SECTIONS;
+            test_check_topology(thread, section);
+            for (int_fast32_t child = -1; child < TEST_NUM_CHILDREN; ++child)
+            {
+                test_check_values(thread, section, child);
+            }
+            if (round == 0)
+            {
+                test_check_compiled_query(thread, section);
+            }
+        }
+    }
+    return NULL;
+}
+
+
+
+int main()
+{
+    int fd = test_make_source();
+    if (fd < 0)
+    {
+        fprintf(stderr, "cini-test-frozen: can't create the source\n");
+        return 1;
+    }
+    CiniDocument *document = cini_malloc_document();
+    if (( ! document) || (cini_parse_fd(document, fd) != CINI_SUCCESS))
+    {
+        fprintf(stderr, "cini-test-frozen: can't parse the source\n");
+        return 1;
+    }
+    close(fd);
+    if (cini_freeze(document) != CINI_SUCCESS)
+    {
+        fprintf(stderr, "cini-test-frozen: can't freeze the document\n");
+        return 1;
+    }
+
+    TestThread threads[TEST_NUM_THREADS];
+    pthread_t handles[TEST_NUM_THREADS];
+    for (uint_fast32_t index = 0; index < TEST_NUM_THREADS; ++index)
+    {
+        threads[index].document = document;
+        threads[index].thread_index = index;
+        threads[index].num_failures = 0;
+        pthread_create(&handles[index], NULL, test_run_thread, &threads[index]);
+    }
+    uint_fast32_t num_failures = 0;
+    for (uint_fast32_t index = 0; index < TEST_NUM_THREADS; ++index)
+    {
+        pthread_join(handles[index], NULL);
+        num_failures += threads[index].num_failures;
+    }
+    cini_free_document(document);
+
+    if (num_failures)
+    {
+        fprintf(
+            stderr,
+            "cini-test-frozen: %u checks failed\n",
+            (unsigned int) num_failures
+        );
+        return 1;
+    }
+    printf("cini-test-frozen: ok\n");
+    return 0;
+}
+
@@ -0,0 +1,299 @@
+#include <cini.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Re-parse a document through a sequence of sources and check, after
+// every step, which section changes were reported and that the document
+// matches a fresh parse of the same source, including the order of its
+// sections.
+
+#define TEST_MAX_CHANGES 512
+#define TEST_MAX_TEXT 4096
+
+typedef struct
+{
+    CiniDocument *document;
+
+    // Reported changes of the current step, like "+a ~b -c".
+    char changes[TEST_MAX_CHANGES];
+    size_t len_changes;
+
+    uint_fast32_t num_failures;
+
+} TestState;
+
+
+
+// ==> Recording
+
+void test_record_change(
+    const char *section,
+    CiniSectionChange change,
+    void *userdata
+) {
+    TestState *state = userdata;
+    char sign = '?';
+    switch (change)
+    {
+        case CINI_SECTION_ADDED:
+            sign = '+';
+            break;
+        case CINI_SECTION_MODIFIED:
+            sign = '~';
+            break;
+        case CINI_SECTION_REMOVED:
+            sign = '-';
+            break;
+    }
+    state->len_changes += snprintf(
+        &state->changes[state->len_changes],
+        sizeof(state->changes) - state->len_changes,
+        "%s%c%s",
+        state->len_changes ? " " : "",
+        sign,
+        section
+    );
+}
+
+void test_fail(
+    TestState *state,
+    const char *step,
+    const char *what,
+    const char *expected,
+    const char *actual
+) {
+    fprintf(
+        stderr,
+        "%s: %s\n  expected: \"%s\"\n  actual:   \"%s\"\n",
+        step,
+        what,
+        expected,
+        actual
+    );
+    ++state->num_failures;
+}
+
+
+
+// ==> Steps
+
+/// @brief Check that a document holds the same text as a fresh parse of
+///        its source, which also compares the order of sections.
+void test_compare_with_fresh_parse(
+    TestState *state,
+    const char *step,
+    const char *source
+) {
+    CiniDocument *fresh = cini_malloc_document();
+    if (( ! fresh) || (cini_parse_source(fresh, source) != CINI_SUCCESS))
+    {
+        test_fail(state, step, "fresh parse failed", "", "");
+        cini_free_document(fresh);
+        return;
+    }
+    char expected[TEST_MAX_TEXT];
+    char actual[TEST_MAX_TEXT];
+    if (
+         (cini_write_document(fresh, expected, sizeof(expected)) < 0)
+      || (cini_write_document(state->document, actual, sizeof(actual)) < 0)
+    ) {
+        test_fail(state, step, "writing failed", "", "");
+    }
+    else if (strcmp(expected, actual))
+    {
+        test_fail(state, step, "document differs", expected, actual);
+    }
+    cini_free_document(fresh);
+}
+
+void test_step(
+    TestState *state,
+    const char *step,
+    const char *source,
+    const char *expected_changes
+) {
+    state->changes[0] = 0;
+    state->len_changes = 0;
+    int_fast8_t status = cini_reparse_source(
+        state->document,
+        source,
+        strlen(source),
+        test_record_change,
+        state
+    );
+    if (status != CINI_SUCCESS)
+    {
+        test_fail(state, step, "re-parse failed", "0", "error");
+        return;
+    }
+    if (strcmp(state->changes, expected_changes))
+    {
+        test_fail(
+            state,
+            step,
+            "wrong changes",
+            expected_changes,
+            state->changes
+        );
+    }
+    test_compare_with_fresh_parse(state, step, source);
+}
+
+void test_expect_text(
+    TestState *state,
+    const char *step,
+    const char *query,
+    const char *expected
+) {
+    const char *text = cini_get_text(state->document, query);
+    if ( ! text)
+    {
+        text = "(none)";
+    }
+    if ( ! expected)
+    {
+        expected = "(none)";
+    }
+    if (strcmp(text, expected))
+    {
+        test_fail(state, step, query, expected, text);
+    }
+}
+
+
+
+int main()
+{
+    TestState state;
+    state.document = cini_malloc_document();
+    state.num_failures = 0;
+    if ( ! state.document)
+    {
+        fprintf(stderr, "cini-test-incremental: can't allocate\n");
+        return 1;
+    }
+
+    // A fresh document has an empty root section, which mustn't be
+    // reported as modified while it stays empty.
+
+    test_step(&state, "first", "[a]\nx = 1\n\n[b]\ny = 2\n\n", "+a +b");
+    test_step(&state, "unchanged", "[a]\nx = 1\n\n[b]\ny = 2\n\n", "");
+    test_step(&state, "modify", "[a]\nx = 5\n\n[b]\ny = 2\n\n", "~a");
+    test_expect_text(&state, "modify", "a:x", "5");
+    test_step(
+        &state,
+        "add",
+        "[a]\nx = 5\n\n[b]\ny = 2\n\n[c]\nz = 3\n\n",
+        "+c"
+    );
+    test_step(&state, "remove", "[a]\nx = 5\n\n[c]\nz = 3\n\n", "-b");
+    test_expect_text(&state, "remove", "b:y", NULL);
+    test_step(
+        &state,
+        "root",
+        "r = 0\n\n[a]\nx = 5\n\n[c]\nz = 3\n\n",
+        "~"
+    );
+    test_expect_text(&state, "root", "r", "0");
+
+    // Moving whole sections changes the order of sections, but not their
+    // fields.
+
+    test_step(
+        &state,
+        "reorder",
+        "r = 0\n\n[c]\nz = 3\n\n[a]\nx = 5\n\n",
+        ""
+    );
+    const char *first = cini_get_section_name(state.document, NULL, 0);
+    if (( ! first) || strcmp(first, "c"))
+    {
+        test_fail(&state, "reorder", "first section", "c", first);
+    }
+
+    // A section may be split across blocks; the last assignment of a key
+    // wins, like in a serial parse.
+
+    test_step(
+        &state,
+        "split",
+        "[a]\nx = 1\n\n[b]\ny = 2\n\n[a]\nx = 3\nw = 4\n\n",
+        "~ ~a +b -c"
+    );
+    test_expect_text(&state, "split", "a:x", "3");
+    test_expect_text(&state, "split", "a:w", "4");
+    test_step(
+        &state,
+        "split second block",
+        "[a]\nx = 1\n\n[b]\ny = 2\n\n[a]\nx = 6\nw = 4\n\n",
+        "~a"
+    );
+    test_expect_text(&state, "split second block", "a:x", "6");
+    test_step(
+        &state,
+        "split other section",
+        "[a]\nx = 1\n\n[b]\ny = 7\n\n[a]\nx = 6\nw = 4\n\n",
+        "~b"
+    );
+    test_expect_text(&state, "split other section", "a:x", "6");
+    test_step(
+        &state,
+        "split first block",
+        "[a]\nx = 2\nv = 8\n\n[b]\ny = 7\n\n[a]\nx = 6\nw = 4\n\n",
+        "~a"
+    );
+    test_expect_text(&state, "split first block", "a:x", "6");
+    test_expect_text(&state, "split first block", "a:v", "8");
+    test_step(
+        &state,
+        "join",
+        "[a]\nx = 2\nv = 8\n\n[b]\ny = 7\n\n",
+        "~a"
+    );
+    test_expect_text(&state, "join", "a:x", "2");
+    test_expect_text(&state, "join", "a:w", NULL);
+
+    // Sub-sections which are dropped must leave their parents' indexes.
+
+    test_step(
+        &state,
+        "nested",
+        "[a]\nx = 2\nv = 8\n\n[a.d]\nq = 1\n\n[b]\ny = 7\n\n",
+        "+a.d"
+    );
+    test_step(
+        &state,
+        "drop nested",
+        "[a]\nx = 2\nv = 8\n\n[b]\ny = 7\n\n",
+        "-a.d"
+    );
+    if (cini_get_section_count(state.document, "a") != 0)
+    {
+        test_fail(&state, "drop nested", "sub-section count", "0", "more");
+    }
+    cini_free_document(state.document);
+
+    // A document which was parsed normally has no blocks yet; only the
+    // sections with fields are reported on its first re-parse.
+
+    state.document = cini_malloc_document();
+    cini_parse_source(state.document, "[e]\n\n[f]\nk = 1\n");
+    test_step(&state, "untracked", "[e]\n\n[f]\nk = 1\n\n", "~f");
+    test_step(&state, "tracked", "[e]\n\n[f]\nk = 1\n\n", "");
+    cini_free_document(state.document);
+
+    if (state.num_failures)
+    {
+        fprintf(
+            stderr,
+            "cini-test-incremental: %u checks failed\n",
+            (unsigned int) state.num_failures
+        );
+        return 1;
+    }
+    printf("cini-test-incremental: ok\n");
+    return 0;
+}
+
@@ -0,0 +1,276 @@
+#define _GNU_SOURCE
+
+#include <cini.h>
+
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Read integers and floating point numbers at the edges of their range
+// and syntax. Decimals which the fast path or the slow path convert are
+// compared bit for bit against `strtod_l` in the "C" locale, which
+// rounds correctly.
+
+typedef struct
+{
+    const char *text;
+    bool is_valid;
+    int64_t value;
+
+} TestInteger;
+
+typedef struct
+{
+    CiniDocument *document;
+    locale_t c_locale;
+    uint_fast32_t num_failures;
+
+} TestState;
+
+static const TestInteger test_integers[] = {
+    {"0", true, 0},
+    {"+42", true, 42},
+    {"-17", true, -17},
+    {"9223372036854775807", true, INT64_MAX},
+    {"9223372036854775808", false, 0},
+    {"-9223372036854775808", true, INT64_MIN},
+    {"-9223372036854775809", false, 0},
+    {"18446744073709551616", false, 0},
+    {"0x7FFF_FFFF_FFFF_FFFF", true, INT64_MAX},
+    {"0x8000000000000000", false, 0},
+    {"-0x8000000000000000", true, INT64_MIN},
+    {"0xFF_FF", true, 0xFFFF},
+    {"0XfF", true, 0xFF},
+    {"0o7_7", true, 077},
+    {"0O17", true, 017},
+    {"0b1010_1010", true, 0xAA},
+    {"0B11", true, 3},
+    {"1_000_000", true, 1000000},
+    {"0x_1", false, 0},
+    {"0x1_", false, 0},
+    {"1__0", false, 0},
+    {"_1", false, 0},
+    {"1_", false, 0},
+    {"0x", false, 0},
+    {"0b2", false, 0},
+    {"0o8", false, 0},
+    {"12a", false, 0},
+    {"1.0", false, 0},
+    {"-", false, 0}
+};
+
+// Decimals which are compared against strtod_l, from the fast path's
+// boundaries at 2^53 and 10^22 to mantissas with more than 19 digits.
+static const char *test_decimals[] = {
+    "0.1",
+    ".5",
+    "5.",
+    "-2.5e-3",
+    "1E10",
+    "9007199254740991",
+    "9007199254740992",
+    "9007199254740993",
+    "9007199254740994",
+    "9007199254740995",
+    "1e22",
+    "1e23",
+    "9007199254740993e22",
+    "123e30",
+    "1e-22",
+    "1e-23",
+    "9999999999999999999",
+    "18446744073709551615",
+    "18446744073709551616",
+    "123456789012345678901234567890",
+    "1.2345678901234567890123456789e-5",
+    "0.30000000000000001665334536938",
+    "2.2250738585072011e-308",
+    "2.2250738585072014e-308",
+    "4.9406564584124654e-324",
+    "1.7976931348623157e308",
+    "1e-400",
+    "1_000.25"
+};
+
+static const char *test_invalid_decimals[] = {
+    "1e400",
+    "-1e400",
+    "1.8e308",
+    ".",
+    "e5",
+    "1e",
+    "1e+",
+    "1..0",
+    "1__0.5",
+    "0x_1",
+    "abc"
+};
+
+
+
+// ==> Reading
+
+/// @brief Parse a document whose root section has the text as the only
+///        value, `v`.
+bool test_parse_value(
+    TestState *state,
+    const char *text
+) {
+    char source[128];
+    snprintf(source, sizeof(source), "v = %s\n", text);
+    cini_reset_document(state->document);
+    return cini_parse_source(state->document, source) == CINI_SUCCESS;
+}
+
+void test_check_integer(
+    TestState *state,
+    const TestInteger *expected
+) {
+    int64_t value = 0;
+    int_fast8_t status = CINI_TYPE_MISMATCH;
+    if (test_parse_value(state, expected->text))
+    {
+        status = cini_get_int(state->document, "v", &value);
+    }
+    bool is_valid = status == CINI_SUCCESS;
+    if (
+         (is_valid != expected->is_valid)
+      || (is_valid && (value != expected->value))
+    ) {
+        fprintf(
+            stderr,
+            "integer \"%s\": expected %s %lld, got status %d, %lld\n",
+            expected->text,
+            expected->is_valid ? "valid" : "invalid",
+            (long long) expected->value,
+            (int) status,
+            (long long) value
+        );
+        ++state->num_failures;
+    }
+}
+
+/// @brief Compare a decimal against strtod_l of the same text without
+///        its digit separators.
+void test_check_decimal(
+    TestState *state,
+    const char *text
+) {
+    char cleaned[128];
+    size_t len_cleaned = 0;
+    for (size_t offset = 0; text[offset]; ++offset)
+    {
+        if (text[offset] != '_')
+        {
+            cleaned[len_cleaned++] = text[offset];
+        }
+    }
+    cleaned[len_cleaned] = 0;
+    double expected = strtod_l(cleaned, NULL, state->c_locale);
+
+    double value = 0;
+    int_fast8_t status = CINI_TYPE_MISMATCH;
+    if (test_parse_value(state, text))
+    {
+        status = cini_get_decimal(state->document, "v", &value);
+    }
+    if (
+         (status != CINI_SUCCESS)
+      || memcmp(&value, &expected, sizeof(double))
+    ) {
+        fprintf(
+            stderr,
+            "decimal \"%s\": expected %.17g, got status %d, %.17g\n",
+            text,
+            expected,
+            (int) status,
+            value
+        );
+        ++state->num_failures;
+    }
+}
+
+void test_check_invalid_decimal(
+    TestState *state,
+    const char *text
+) {
+    double value = 0;
+    if (
+         test_parse_value(state, text)
+      && (cini_get_decimal(state->document, "v", &value) != CINI_TYPE_MISMATCH)
+    ) {
+        fprintf(stderr, "decimal \"%s\": accepted as %.17g\n", text, value);
+        ++state->num_failures;
+    }
+}
+
+/// @brief Check the special values, whose bits needn't match strtod's.
+void test_check_special_decimals(
+    TestState *state
+) {
+    const char *texts[] = {"inf", "-Infinity", "+INF", "nan", "NaN"};
+    for (uint_fast32_t index = 0; index < 5; ++index)
+    {
+        double value = 0;
+        bool is_read = test_parse_value(state, texts[index])
+            && (cini_get_decimal(state->document, "v", &value)
+                == CINI_SUCCESS);
+        bool is_right = (index < 3)
+            ? (isinf(value) && ((value < 0) == (index == 1)))
+            : isnan(value);
+        if (( ! is_read) || ( ! is_right))
+        {
+            fprintf(stderr, "decimal \"%s\": misread\n", texts[index]);
+            ++state->num_failures;
+        }
+    }
+}
+
+
+
+int main()
+{
+    TestState state;
+    state.document = cini_malloc_document();
+    state.c_locale = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+    state.num_failures = 0;
+    if (( ! state.document) || ( ! state.c_locale))
+    {
+        fprintf(stderr, "cini-test-number: can't set up\n");
+        return 1;
+    }
+
+    uint_fast32_t num_integers = sizeof(test_integers) / sizeof(TestInteger);
+    for (uint_fast32_t index = 0; index < num_integers; ++index)
+    {
+        test_check_integer(&state, &test_integers[index]);
+    }
+    uint_fast32_t num_decimals = sizeof(test_decimals) / sizeof(char *);
+    for (uint_fast32_t index = 0; index < num_decimals; ++index)
+    {
+        test_check_decimal(&state, test_decimals[index]);
+    }
+    uint_fast32_t num_invalid = sizeof(test_invalid_decimals) / sizeof(char *);
+    for (uint_fast32_t index = 0; index < num_invalid; ++index)
+    {
+        test_check_invalid_decimal(&state, test_invalid_decimals[index]);
+    }
+    test_check_special_decimals(&state);
+
+    freelocale(state.c_locale);
+    cini_free_document(state.document);
+    if (state.num_failures)
+    {
+        fprintf(
+            stderr,
+            "cini-test-number: %u checks failed\n",
+            (unsigned int) state.num_failures
+        );
+        return 1;
+    }
+    printf("cini-test-number: ok\n");
+    return 0;
+}
+
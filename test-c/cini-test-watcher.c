@@ -0,0 +1,347 @@
+#include <cini.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Replace a watched file over and over while readers keep reading the
+// watcher's latest document. Every version of the file is consistent in
+// itself, so a reader which sees values of two versions in one read, or
+// a version older than one it already saw, has found a bug. Meant to be
+// built with `-fsanitize=thread`, which also checks that no document is
+// freed while a reader still holds it.
+
+#define TEST_NUM_READERS 6
+#define TEST_NUM_VERSIONS 40
+#define TEST_NUM_SECTIONS 32
+
+// Version after which a broken file is written, which must leave the
+// previous document published.
+#define TEST_BROKEN_AFTER 20
+
+#define TEST_TIMEOUT_MS 10000
+
+typedef struct
+{
+    CiniWatcher *watcher;
+    uint_fast32_t reader_index;
+    bool *stop;
+
+    uint_fast32_t num_reads;
+    uint_fast32_t num_failures;
+
+} TestReader;
+
+typedef struct
+{
+    char directory[64];
+    char path[96];
+    char next_path[96];
+
+} TestFiles;
+
+
+
+// ==> Writing Versions
+
+/// @brief Replace the watched file by renaming a completely written one
+///        over it, so that the watcher never sees a partial version.
+bool test_replace_file(
+    TestFiles *files,
+    const char *text
+) {
+    FILE *file = fopen(files->next_path, "w");
+    if ( ! file)
+    {
+        return false;
+    }
+    bool is_written = fputs(text, file) >= 0;
+    is_written &= fclose(file) == 0;
+    return is_written && (rename(files->next_path, files->path) == 0);
+}
+
+bool test_write_version(
+    TestFiles *files,
+    uint_fast32_t version
+) {
+    char text[TEST_NUM_SECTIONS * 64 + 64];
+    size_t length = snprintf(
+        text,
+        sizeof(text),
+        "[meta]\nversion = %u\n\n",
+        (unsigned int) version
+    );
+    for (uint_fast32_t section = 0; section < TEST_NUM_SECTIONS; ++section)
+    {
+        length += snprintf(
+            &text[length],
+            sizeof(text) - length,
+            "[s%u]\nk = %u\nt = v%u-%u\n\n",
+            (unsigned int) section,
+            (unsigned int) ((version * 1000) + section),
+            (unsigned int) version,
+            (unsigned int) section
+        );
+    }
+    return test_replace_file(files, text);
+}
+
+void test_sleep_ms(
+    long milliseconds
+) {
+    struct timespec duration = {
+        .tv_sec = milliseconds / 1000,
+        .tv_nsec = (milliseconds % 1000) * 1000000
+    };
+    nanosleep(&duration, NULL);
+}
+
+/// @brief Wait until the watcher has published a version.
+bool test_await_version(
+    CiniWatcher *watcher,
+    uint_fast32_t version
+) {
+    for (long waited = 0; waited < TEST_TIMEOUT_MS; ++waited)
+    {
+        if (cini_get_watcher_version(watcher) >= version)
+        {
+            return true;
+        }
+        test_sleep_ms(1);
+    }
+    return false;
+}
+
+/// @brief Wait until the watcher has failed to parse the file.
+bool test_await_failure(
+    CiniWatcher *watcher
+) {
+    for (long waited = 0; waited < TEST_TIMEOUT_MS; ++waited)
+    {
+        if (cini_get_watcher_status(watcher) != CINI_SUCCESS)
+        {
+            return true;
+        }
+        test_sleep_ms(1);
+    }
+    return false;
+}
+
+
+
+// ==> Reading
+
+void test_fail(
+    TestReader *reader,
+    const char *what,
+    uint_fast32_t version
+) {
+    if (reader->num_failures < 8)
+    {
+        fprintf(
+            stderr,
+            "reader %u: %s in version %u\n",
+            (unsigned int) reader->reader_index,
+            what,
+            (unsigned int) version
+        );
+    }
+    ++reader->num_failures;
+}
+
+/// @brief Check that a document is one complete version of the file.
+/// @return
+/// The document's version, or zero if it couldn't be read.
+uint_fast32_t test_check_document(
+    TestReader *reader,
+    CiniDocument *document
+) {
+    int64_t version = 0;
+    if (
+         (cini_get_int(document, "meta:version", &version) != CINI_SUCCESS)
+      || (version <= 0)
+    ) {
+        test_fail(reader, "unreadable version", 0);
+        return 0;
+    }
+    if (cini_get_section_count(document, NULL) != (TEST_NUM_SECTIONS + 1))
+    {
+        test_fail(reader, "wrong section count", version);
+    }
+    for (uint_fast32_t section = 0; section < TEST_NUM_SECTIONS; ++section)
+    {
+        char query[32];
+        char expected[32];
+        int64_t value = 0;
+        snprintf(query, sizeof(query), "s%u:k", (unsigned int) section);
+        if (
+             (cini_get_int(document, query, &value) != CINI_SUCCESS)
+          || (value != (int64_t) ((version * 1000) + section))
+        ) {
+            test_fail(reader, "mixed integer value", version);
+        }
+        snprintf(query, sizeof(query), "s%u:t", (unsigned int) section);
+        snprintf(
+            expected,
+            sizeof(expected),
+            "v%u-%u",
+            (unsigned int) version,
+            (unsigned int) section
+        );
+        const char *text = cini_get_text(document, query);
+        if (( ! text) || strcmp(text, expected))
+        {
+            test_fail(reader, "mixed text value", version);
+        }
+        snprintf(expected, sizeof(expected), "s%u", (unsigned int) section);
+        const char *name = cini_get_section_name(document, NULL, section + 1);
+        if (( ! name) || strcmp(name, expected))
+        {
+            test_fail(reader, "wrong section name", version);
+        }
+    }
+    return version;
+}
+
+void * test_run_reader(
+    void *userdata
+) {
+    TestReader *reader = userdata;
+    CiniReader *handle = cini_add_reader(reader->watcher);
+    if ( ! handle)
+    {
+        test_fail(reader, "no reader", 0);
+        return NULL;
+    }
+    uint_fast32_t last_version = 0;
+    while ( ! __atomic_load_n(reader->stop, __ATOMIC_ACQUIRE))
+    {
+        CiniDocument *document = cini_begin_read(handle);
+        uint_fast32_t version = test_check_document(reader, document);
+        cini_end_read(handle);
+        if (version < last_version)
+        {
+            test_fail(reader, "older version after newer one", version);
+        }
+        last_version = version;
+        ++reader->num_reads;
+    }
+    cini_remove_reader(handle);
+    return NULL;
+}
+
+
+
+int main()
+{
+    TestFiles files;
+    strcpy(files.directory, "/tmp/cini-test-watcher-XXXXXX");
+    if ( ! mkdtemp(files.directory))
+    {
+        fprintf(stderr, "cini-test-watcher: can't create a directory\n");
+        return 1;
+    }
+    snprintf(files.path, sizeof(files.path), "%s/watched.ini", files.directory);
+    snprintf(
+        files.next_path,
+        sizeof(files.next_path),
+        "%s/next.ini",
+        files.directory
+    );
+
+    CiniWatcher *watcher = NULL;
+    if (test_write_version(&files, 1))
+    {
+        watcher = cini_watch_path(files.path);
+    }
+    if ( ! watcher)
+    {
+        fprintf(stderr, "cini-test-watcher: can't watch the file\n");
+        unlink(files.path);
+        rmdir(files.directory);
+        return 1;
+    }
+
+    bool stop = false;
+    TestReader readers[TEST_NUM_READERS];
+    pthread_t handles[TEST_NUM_READERS];
+    for (uint_fast32_t index = 0; index < TEST_NUM_READERS; ++index)
+    {
+        readers[index].watcher = watcher;
+        readers[index].reader_index = index;
+        readers[index].stop = &stop;
+        readers[index].num_reads = 0;
+        readers[index].num_failures = 0;
+        pthread_create(&handles[index], NULL, test_run_reader, &readers[index]);
+    }
+
+    uint_fast32_t num_failures = 0;
+    for (uint_fast32_t version = 2; version <= TEST_NUM_VERSIONS; ++version)
+    {
+        if (
+             ( ! test_write_version(&files, version))
+          || ( ! test_await_version(watcher, version))
+        ) {
+            fprintf(
+                stderr,
+                "cini-test-watcher: version %u wasn't published\n",
+                (unsigned int) version
+            );
+            ++num_failures;
+            break;
+        }
+        if (version != TEST_BROKEN_AFTER)
+        {
+            continue;
+        }
+        if (
+             ( ! test_replace_file(&files, "[meta\nversion = 0\n"))
+          || ( ! test_await_failure(watcher))
+          || (cini_get_watcher_version(watcher) != version)
+        ) {
+            fprintf(
+                stderr,
+                "cini-test-watcher: a broken file replaced version %u\n",
+                (unsigned int) version
+            );
+            ++num_failures;
+        }
+    }
+
+    __atomic_store_n(&stop, true, __ATOMIC_RELEASE);
+    uint_fast32_t num_reads = 0;
+    for (uint_fast32_t index = 0; index < TEST_NUM_READERS; ++index)
+    {
+        pthread_join(handles[index], NULL);
+        num_failures += readers[index].num_failures;
+        num_reads += readers[index].num_reads;
+    }
+    if (cini_get_watcher_status(watcher) != CINI_SUCCESS)
+    {
+        fprintf(stderr, "cini-test-watcher: the last version failed\n");
+        ++num_failures;
+    }
+    cini_free_watcher(watcher);
+    unlink(files.path);
+    rmdir(files.directory);
+
+    if (num_failures)
+    {
+        fprintf(
+            stderr,
+            "cini-test-watcher: %u checks failed\n",
+            (unsigned int) num_failures
+        );
+        return 1;
+    }
+    printf(
+        "cini-test-watcher: ok, %u reads of %u versions\n",
+        (unsigned int) num_reads,
+        (unsigned int) TEST_NUM_VERSIONS
+    );
+    return 0;
+}
+
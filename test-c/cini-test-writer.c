@@ -0,0 +1,294 @@
+#include <cini.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Parse a source, write the document, parse what was written and write
+// that again; both texts must be the same, through every way of writing,
+// and the values must survive quoting and escaping. The source is large
+// enough that the batched writers flush several times.
+
+#define TEST_NUM_FILLER_SECTIONS 600
+
+typedef struct
+{
+    uint_fast32_t num_allocations;
+    uint_fast32_t num_frees;
+
+} TestAllocator;
+
+typedef struct
+{
+    const char *query;
+    const char *value;
+
+} TestValue;
+
+static const char *test_source =
+    "root = top level\n"
+    "empty =\n"
+    "\n"
+    "[quoted]\n"
+    "padded = \"  leading and trailing  \"\n"
+    "tab = \"\\tindented\"\n"
+    "quotes = \"say \\\"hi\\\"\"\n"
+    "starts = \"\\\"quoted\\\" at the start\"\n"
+    "backslash = \"a \\\\ b\"\n"
+    "lines = \"first\\nsecond\\r\\nthird\"\n"
+    "plain = no quotes needed\n"
+    "inner = a \"quote\" inside\n"
+    "\n"
+    "[nested.deeper]\n"
+    "key = value\n"
+    "key = replaced value\n"
+    "unicode = \xc3\xa4\xc3\xb6\xc3\xbc \xe2\x82\xac\n";
+
+static const TestValue test_values[] = {
+    {"root", "top level"},
+    {"empty", ""},
+    {"quoted:padded", "  leading and trailing  "},
+    {"quoted:tab", "\tindented"},
+    {"quoted:quotes", "say \"hi\""},
+    {"quoted:starts", "\"quoted\" at the start"},
+    {"quoted:backslash", "a \\ b"},
+    {"quoted:lines", "first\nsecond\r\nthird"},
+    {"quoted:plain", "no quotes needed"},
+    {"quoted:inner", "a \"quote\" inside"},
+    {"nested.deeper:key", "replaced value"},
+    {"nested.deeper:unicode", "\xc3\xa4\xc3\xb6\xc3\xbc \xe2\x82\xac"}
+};
+
+void * test_alloc(
+    uint_fast32_t amount,
+    void *userdata
+) {
+    TestAllocator *allocator = userdata;
+    ++allocator->num_allocations;
+    return malloc(amount);
+}
+
+void test_free(
+    void *pointer,
+    void *userdata
+) {
+    TestAllocator *allocator = userdata;
+    ++allocator->num_frees;
+    free(pointer);
+}
+
+/// @brief Build the source: the fixed part followed by sections with
+///        long and short values, which exceed the writers' batches.
+char * test_make_source()
+{
+    size_t capacity = strlen(test_source) + (TEST_NUM_FILLER_SECTIONS * 512);
+    char *source = malloc(capacity);
+    if ( ! source)
+    {
+        return NULL;
+    }
+    size_t length = snprintf(source, capacity, "%s", test_source);
+    for (
+        uint_fast32_t section = 0;
+        section < TEST_NUM_FILLER_SECTIONS;
+        ++section
+    ) {
+        length += snprintf(
+            &source[length],
+            capacity - length,
+            "\n[filler.s%u]\nshort = %u\nlong = ",
+            (unsigned int) section,
+            (unsigned int) section
+        );
+        for (uint_fast32_t repeat = 0; repeat < 20; ++repeat)
+        {
+            length += snprintf(
+                &source[length],
+                capacity - length,
+                "word%u ",
+                (unsigned int) repeat
+            );
+        }
+        length += snprintf(&source[length], capacity - length, "end\n");
+    }
+    return source;
+}
+
+
+
+// ==> Writing
+
+/// @brief Write a document into a newly allocated, zero-terminated text
+///        through one of the three writers.
+/// @param method
+///        0 for `cini_write_document`, 1 for `cini_write_document_file`
+///        and 2 for `cini_write_document_fd`.
+char * test_write(
+    CiniDocument *document,
+    int method
+) {
+    if (method == 0)
+    {
+        int_fast32_t length = cini_write_document(document, NULL, 0);
+        char *text = malloc(length + 1);
+        if (
+             text
+          && (cini_write_document(document, text, length + 1) != length)
+        ) {
+            free(text);
+            return NULL;
+        }
+        return text;
+    }
+    FILE *file = tmpfile();
+    if ( ! file)
+    {
+        return NULL;
+    }
+    int_fast8_t status;
+    if (method == 1)
+    {
+        status = cini_write_document_file(document, file);
+    }
+    else
+    {
+        status = cini_write_document_fd(document, fileno(file));
+    }
+    long length = -1;
+    if ((status == CINI_SUCCESS) && (fflush(file) == 0))
+    {
+        length = lseek(fileno(file), 0, SEEK_END);
+    }
+    char *text = (length >= 0) ? malloc(length + 1) : NULL;
+    if (text && (pread(fileno(file), text, length, 0) == length))
+    {
+        text[length] = 0;
+    }
+    else
+    {
+        free(text);
+        text = NULL;
+    }
+    fclose(file);
+    return text;
+}
+
+
+
+int main()
+{
+    uint_fast32_t num_failures = 0;
+    char *source = test_make_source();
+    TestAllocator allocator = {0, 0};
+    CiniDocument *first = cini_new_document(test_alloc, test_free, &allocator);
+    CiniDocument *second = cini_malloc_document();
+    if (
+         ( ! source)
+      || ( ! first)
+      || ( ! second)
+      || (cini_parse_source(first, source) != CINI_SUCCESS)
+    ) {
+        fprintf(stderr, "cini-test-writer: can't parse the source\n");
+        return 1;
+    }
+
+    const char *method_names[3] = {"buffer", "file", "fd"};
+    char *texts[3] = {NULL, NULL, NULL};
+    for (int method = 0; method < 3; ++method)
+    {
+        // The batched writers allocate their vectors through the
+        // document's allocator and free them again.
+
+        uint_fast32_t num_allocations = allocator.num_allocations;
+        uint_fast32_t num_frees = allocator.num_frees;
+        texts[method] = test_write(first, method);
+        if ( ! texts[method])
+        {
+            fprintf(
+                stderr,
+                "cini-test-writer: writing to a %s failed\n",
+                method_names[method]
+            );
+            return 1;
+        }
+        if (
+             (method > 0)
+          && (
+                 (allocator.num_allocations != (num_allocations + 1))
+              || (allocator.num_frees != (num_frees + 1))
+             )
+        ) {
+            fprintf(
+                stderr,
+                "cini-test-writer: writing to a %s bypassed the allocator\n",
+                method_names[method]
+            );
+            ++num_failures;
+        }
+        if (strcmp(texts[method], texts[0]))
+        {
+            fprintf(
+                stderr,
+                "cini-test-writer: writing to a %s gave a different text\n",
+                method_names[method]
+            );
+            ++num_failures;
+        }
+    }
+
+    if (cini_parse_source(second, texts[0]) != CINI_SUCCESS)
+    {
+        fprintf(stderr, "cini-test-writer: can't parse the written text\n");
+        return 1;
+    }
+    uint_fast32_t num_values = sizeof(test_values) / sizeof(TestValue);
+    for (uint_fast32_t index = 0; index < num_values; ++index)
+    {
+        const char *text = cini_get_text(second, test_values[index].query);
+        if (( ! text) || strcmp(text, test_values[index].value))
+        {
+            fprintf(
+                stderr,
+                "cini-test-writer: \"%s\" changed in the round trip\n",
+                test_values[index].query
+            );
+            ++num_failures;
+        }
+    }
+    for (int method = 0; method < 3; ++method)
+    {
+        char *text = test_write(second, method);
+        if (( ! text) || strcmp(text, texts[0]))
+        {
+            fprintf(
+                stderr,
+                "cini-test-writer: the second text differs (%s)\n",
+                method_names[method]
+            );
+            ++num_failures;
+        }
+        free(text);
+    }
+
+    for (int method = 0; method < 3; ++method)
+    {
+        free(texts[method]);
+    }
+    cini_free_document(first);
+    cini_free_document(second);
+    free(source);
+
+    if (num_failures)
+    {
+        fprintf(
+            stderr,
+            "cini-test-writer: %u checks failed\n",
+            (unsigned int) num_failures
+        );
+        return 1;
+    }
+    printf("cini-test-writer: ok\n");
+    return 0;
+}
+
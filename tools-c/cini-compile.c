@@ -0,0 +1,59 @@
+#include <cini.h>
+
+#include <stdio.h>
+#include <string.h>
+
+// Compile an INI-document into the binary format which cini_load_compiled
+// maps without parsing.
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <source.ini | -> <output>\n", argv[0]);
+        return 2;
+    }
+    CiniDocument *document = cini_malloc_document();
+    if ( ! document)
+    {
+        fputs("cini-compile: Failed to allocate a document.\n", stderr);
+        return 1;
+    }
+
+    // Read from the standard input if the source is a dash
+
+    int_fast8_t status;
+    if ( ! strcmp(argv[1], "-"))
+    {
+        status = cini_parse_file_pointer(document, stdin);
+    }
+    else
+    {
+        status = cini_parse_from_path(document, argv[1]);
+    }
+    if (status != CINI_SUCCESS)
+    {
+        fprintf(
+            stderr,
+            "cini-compile: Failed to parse '%s' (status %d).\n",
+            argv[1],
+            (int) status
+        );
+        cini_free_document(document);
+        return 1;
+    }
+    status = cini_save_compiled(document, argv[2]);
+    cini_free_document(document);
+    if (status != CINI_SUCCESS)
+    {
+        fprintf(
+            stderr,
+            "cini-compile: Failed to write '%s' (status %d).\n",
+            argv[2],
+            (int) status
+        );
+        return 1;
+    }
+    return 0;
+}
+